@@ -0,0 +1,124 @@
+/*
+ * bench_bloomfilter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Dedup lookups against an ArrayList and a Deque where most keys are absent,
+ * with and without a BloomFilter attached, and the filter's false positive rate.
+ * The Deque takes its nodes from a preallocated array, so it holds every
+ * item whether or not DEQUE_STATIC is defined.
+ *
+ * usage: bench_bloomfilter [items] [lookups] [percent present]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/arraylist.h"
+#include "../src/deque.h"
+#include "../src/bloomfilter.h"
+
+#if !defined(ARRAYLIST_FILTER) || !defined(DEQUE_FILTER)
+#error "bench_bloomfilter needs ARRAYLIST_FILTER and DEQUE_FILTER"
+#endif
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* A key that is in the containers (odd) about percent of the time */
+static void*
+bench_key(uint64_t *state, uint32_t n, uint32_t percent) {
+	uint64_t r = bench_rand(state);
+	if (r % 100 < percent) {
+		return (void*) (uintptr_t) (2 * ((r >> 8) % n) + 1);
+	}
+	return (void*) (uintptr_t) (2 * (r >> 8));
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000;
+	uint64_t lookups = argc > 2 ? strtoull(argv[2], NULL, 10) : 200000;
+	uint32_t percent = argc > 3 ? strtoul(argv[3], NULL, 10) : 5;
+	ArrayList list = arraylist_create_heap_size(n, NULL);
+	struct deque_node_t *nodes = malloc(n * sizeof(struct deque_node_t));
+	struct deque_t dq;
+	Deque d = &dq;
+	BloomFilter lf = bloomfilter_create(n, NULL);
+	BloomFilter df = bloomfilter_create(n, NULL);
+	uint64_t state, i, found[4] = {0, 0, 0, 0};
+	uint32_t j;
+	double start;
+
+	deque_init_preallocated(d, n, NULL, nodes);
+	for (j = 0; j < n; j++) {
+		arraylist_append(list, (void*) (uintptr_t) (2 * j + 1));
+		deque_append(d, (void*) (uintptr_t) (2 * j + 1));
+	}
+
+	state = 88172645463325252ULL;
+	start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found[0] += arraylist_contains(list, bench_key(&state, n, percent));
+	}
+	bench_report("arraylist_contains", lookups, bench_now() - start);
+
+	arraylist_set_filter(list, lf);
+	state = 88172645463325252ULL;
+	start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found[1] += arraylist_contains(list, bench_key(&state, n, percent));
+	}
+	bench_report("arraylist_contains with filter", lookups, bench_now() - start);
+
+	state = 88172645463325252ULL;
+	start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found[2] += deque_contains(d, bench_key(&state, n, percent));
+	}
+	bench_report("deque_contains", lookups, bench_now() - start);
+
+	deque_set_filter(d, df);
+	state = 88172645463325252ULL;
+	start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found[3] += deque_contains(d, bench_key(&state, n, percent));
+	}
+	bench_report("deque_contains with filter", lookups, bench_now() - start);
+
+	printf("false positive rate: estimated %.5f, observed %.5f\n",
+	       bloomfilter_estimated_fp_rate(lf), bloomfilter_observed_fp_rate(lf));
+	if (found[0] != found[1] || found[0] != found[2] || found[0] != found[3]) {
+		fprintf(stderr, "filtered lookups disagree\n");
+		return 1;
+	}
+	deque_set_filter(d, NULL);
+	deque_clear(d);
+	free(nodes);
+	arraylist_free(list);
+	bloomfilter_free(lf);
+	bloomfilter_free(df);
+	return 0;
+}
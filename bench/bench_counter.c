@@ -0,0 +1,114 @@
+/*
+ * bench_counter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Counter benchmark on skewed integer tokens: counting one token at a time and
+ * from an ArrayList batch, then the k most common keys by counter_most_common()
+ * against collecting every count and sorting them with arraylist_sort().
+ *
+ * usage: bench_counter [tokens] [distinct] [k]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/counter.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* Order entries by descending count, then by key so no two are equal
+ * (arraylist_sort() degrades badly on runs of equal items)
+ */
+static int8_t
+entry_comparator(void *a, void *b) {
+	struct counter_entry_t *x = a, *y = b;
+	if (x->count != y->count) {
+		return x->count > y->count ? -1 : 1;
+	}
+	return x->key < y->key ? -1 : (x->key > y->key ? 1 : 0);
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t tokens = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	uint32_t distinct = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+	uint32_t k = argc > 3 ? strtoul(argv[3], NULL, 10) : 100;
+	struct counter_entry_t *top = malloc(k * sizeof(struct counter_entry_t));
+	struct counter_entry_t *entries;
+	ArrayList keys = arraylist_create_heap_size(tokens, NULL);
+	ArrayList sorted;
+	uint64_t state = 88172645463325252ULL;
+	uint32_t i, n, iter = 0;
+	Counter c;
+	double u, start;
+
+	/* the cube of a uniform fraction favours low keys, like word counts */
+	for (i = 0; i < tokens; i++) {
+		u = (bench_rand(&state) >> 11) / 9007199254740992.0;
+		arraylist_append(keys, (void*) (uintptr_t) (1 + (uint32_t) (u * u * u * distinct)));
+	}
+
+	c = counter_create(NULL, NULL);
+	start = bench_now();
+	for (i = 0; i < tokens; i++) {
+		counter_increment(c, keys->ptr_table[i]);
+	}
+	bench_report("counter increment", tokens, bench_now() - start);
+	counter_free(c);
+
+	c = counter_create(NULL, NULL);
+	start = bench_now();
+	counter_update(c, keys);
+	bench_report("counter update", tokens, bench_now() - start);
+
+	start = bench_now();
+	n = counter_most_common(c, k, top);
+	bench_report("counter most_common", counter_count(c), bench_now() - start);
+
+	/* the same answer from a full sort of every count */
+	start = bench_now();
+	entries = malloc(counter_count(c) * sizeof(struct counter_entry_t));
+	sorted = arraylist_create_heap_size(counter_count(c), entry_comparator);
+	for (i = 0; counter_next(c, &iter, &entries[i].key, &entries[i].count); i++) {
+		arraylist_append(sorted, &entries[i]);
+	}
+	arraylist_sort(sorted);
+	bench_report("hashmap plus arraylist_sort", counter_count(c), bench_now() - start);
+
+	for (i = 0; i < n; i++) {
+		if (top[i].count != ((struct counter_entry_t*) sorted->ptr_table[i])->count) {
+			fprintf(stderr, "top counts differ at %u\n", i);
+			return 1;
+		}
+	}
+	arraylist_free(sorted);
+	arraylist_free(keys);
+	counter_free(c);
+	free(entries);
+	free(top);
+	return 0;
+}
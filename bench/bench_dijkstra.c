@@ -0,0 +1,196 @@
+/*
+ * bench_dijkstra.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Dijkstra's shortest paths on a random sparse graph, with an IndexHeap
+ * (decrease-key on each vertex's handle) and with a PQueue that takes a new
+ * entry for every relaxation and skips stale ones when they are popped.
+ *
+ * usage: bench_dijkstra [vertices] [edges per vertex]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/indexheap.h"
+#include "../src/pqueue.h"
+
+#define UNREACHED (UINT64_MAX)
+
+struct graph {
+	uint32_t number_vertices;
+	uint32_t *first_edge;   /* edges of v are first_edge[v] .. first_edge[v + 1] */
+	uint32_t *target;
+	uint32_t *weight;
+};
+
+struct vertex {
+	uint64_t distance;
+	struct indexheap_node_t node;
+};
+
+struct entry {
+	uint64_t distance;
+	uint32_t vertex;
+};
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* Every vertex gets an edge to the next one, so all are reachable, plus
+ * degree - 1 edges to random vertices.
+ */
+static void
+graph_generate(struct graph *g, uint32_t number_vertices, uint32_t degree) {
+	uint64_t state = 88172645463325252ULL;
+	uint32_t v, i, e = 0;
+	g->number_vertices = number_vertices;
+	g->first_edge = malloc((number_vertices + 1) * sizeof(uint32_t));
+	g->target = malloc((uint64_t) number_vertices * degree * sizeof(uint32_t));
+	g->weight = malloc((uint64_t) number_vertices * degree * sizeof(uint32_t));
+	for (v = 0; v < number_vertices; v++) {
+		g->first_edge[v] = e;
+		for (i = 0; i < degree; i++, e++) {
+			g->target[e] = i == 0 ? (v + 1) % number_vertices
+			                      : bench_rand(&state) % number_vertices;
+			g->weight[e] = 1 + bench_rand(&state) % 1000;
+		}
+	}
+	g->first_edge[number_vertices] = e;
+}
+
+static int8_t
+vertex_comparator(const void *a, const void *b) {
+	const struct vertex *x = a, *y = b;
+	return x->distance < y->distance ? -1 : x->distance > y->distance;
+}
+
+static int8_t
+entry_comparator(void *a, void *b) {
+	const struct entry *x = a, *y = b;
+	return x->distance < y->distance ? -1 : x->distance > y->distance;
+}
+
+static uint64_t
+dijkstra_indexheap(struct graph *g) {
+	struct vertex *vertices = malloc(g->number_vertices * sizeof(struct vertex));
+	IndexHeap h = indexheap_create_size(1024, vertex_comparator);
+	struct vertex *u, *w;
+	uint64_t distance, checksum = 0;
+	uint32_t v, e;
+
+	for (v = 0; v < g->number_vertices; v++) {
+		vertices[v].distance = UNREACHED;
+		indexheap_node_init(&vertices[v].node);
+	}
+	vertices[0].distance = 0;
+	indexheap_push(h, &vertices[0].node, &vertices[0]);
+	while ((u = indexheap_pop(h)) != NULL) {
+		v = u - vertices;
+		for (e = g->first_edge[v]; e < g->first_edge[v + 1]; e++) {
+			w = &vertices[g->target[e]];
+			distance = u->distance + g->weight[e];
+			if (distance < w->distance) {
+				w->distance = distance;
+				if (indexheap_contains(h, &w->node)) {
+					indexheap_update_priority(h, &w->node);
+				} else {
+					indexheap_push(h, &w->node, w);
+				}
+			}
+		}
+	}
+	for (v = 0; v < g->number_vertices; v++) {
+		checksum += vertices[v].distance;
+	}
+	indexheap_free(h);
+	free(vertices);
+	return checksum;
+}
+
+static uint64_t
+dijkstra_lazy(struct graph *g) {
+	uint64_t *distances = malloc(g->number_vertices * sizeof(uint64_t));
+	struct entry *entries = malloc(((uint64_t) g->first_edge[g->number_vertices] + 1)
+	                               * sizeof(struct entry));
+	PQueue q = pqueue_create_from(arraylist_create_heap_size(1024, entry_comparator));
+	struct entry *u;
+	uint64_t distance, checksum = 0;
+	uint32_t v, e, number_entries = 0;
+
+	for (v = 0; v < g->number_vertices; v++) {
+		distances[v] = UNREACHED;
+	}
+	distances[0] = 0;
+	entries[number_entries] = (struct entry) {0, 0};
+	pqueue_push(q, &entries[number_entries++]);
+	while ((u = pqueue_pop(q)) != NULL) {
+		if (u->distance > distances[u->vertex]) {
+			continue; /* stale */
+		}
+		for (e = g->first_edge[u->vertex]; e < g->first_edge[u->vertex + 1]; e++) {
+			distance = u->distance + g->weight[e];
+			if (distance < distances[g->target[e]]) {
+				distances[g->target[e]] = distance;
+				entries[number_entries] = (struct entry) {distance, g->target[e]};
+				pqueue_push(q, &entries[number_entries++]);
+			}
+		}
+	}
+	for (v = 0; v < g->number_vertices; v++) {
+		checksum += distances[v];
+	}
+	pqueue_free(q);
+	free(entries);
+	free(distances);
+	return checksum;
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t number_vertices = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	uint32_t degree = argc > 2 ? strtoul(argv[2], NULL, 10) : 8;
+	uint64_t edges = (uint64_t) number_vertices * degree;
+	uint64_t checksum, lazy_checksum;
+	struct graph g;
+	double start;
+
+	graph_generate(&g, number_vertices, degree);
+	start = bench_now();
+	checksum = dijkstra_indexheap(&g);
+	bench_report("dijkstra indexheap (edges)", edges, bench_now() - start);
+	start = bench_now();
+	lazy_checksum = dijkstra_lazy(&g);
+	bench_report("dijkstra pqueue lazy deletion (edges)", edges, bench_now() - start);
+	if (checksum != lazy_checksum) {
+		fprintf(stderr, "distance mismatch\n");
+		return 1;
+	}
+	free(g.first_edge);
+	free(g.target);
+	free(g.weight);
+	return 0;
+}
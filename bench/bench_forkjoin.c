@@ -0,0 +1,91 @@
+/*
+ * bench_forkjoin.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Fork/join benchmark for the work-stealing pool: naive parallel fib(n) with a
+ * sequential cutoff, run with 1..N workers.
+ *
+ * usage: bench_forkjoin [n] [max_workers]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/workpool.h"
+
+#define FIB_CUTOFF (12)
+
+struct fib_args {
+	uint32_t n;
+	uint64_t result;
+};
+
+static uint64_t
+fib_seq(uint32_t n) {
+	return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+static void
+fib_task(void *arg) {
+	struct fib_args *f = arg;
+	struct fib_args left, right;
+	struct workpool_group_t group;
+	struct workpool_task_t task;
+
+	if (f->n < FIB_CUTOFF) {
+		f->result = fib_seq(f->n);
+		return;
+	}
+	left.n = f->n - 1;
+	right.n = f->n - 2;
+	workpool_group_init(&group);
+	workpool_spawn(&group, &task, fib_task, &left);
+	fib_task(&right);
+	workpool_sync(&group);
+	f->result = left.result + right.result;
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? atoi(argv[1]) : 36;
+	uint32_t max_workers = argc > 2 ? atoi(argv[2]) : 8;
+	uint32_t workers;
+	struct fib_args f;
+	double start, seq_time;
+	WorkPool p;
+	char name[64];
+
+	start = bench_now();
+	f.result = fib_seq(n);
+	seq_time = bench_now() - start;
+	printf("fib(%u) = %llu, sequential %.3f s\n", n,
+		(unsigned long long) f.result, seq_time);
+
+	for (workers = 1; workers <= max_workers; workers *= 2) {
+		p = workpool_create(workers);
+		f.n = n;
+		start = bench_now();
+		workpool_run(p, fib_task, &f);
+		snprintf(name, sizeof(name), "workpool fib workers=%u", workers);
+		bench_report(name, fib_seq(n - FIB_CUTOFF + 1), bench_now() - start);
+		workpool_free(p);
+	}
+	return 0;
+}
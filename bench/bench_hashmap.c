@@ -0,0 +1,118 @@
+/*
+ * bench_hashmap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * HashMap benchmark with integer keys: one at a time and batch inserts,
+ * lookups of present keys drawn uniformly or skewed towards a small hot set,
+ * lookups of absent keys, and removal of every key.
+ *
+ * usage: bench_hashmap [keys] [lookups]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/hashmap.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* An index in 0..n-1, uniform or with about half the picks in the lowest
+ * tenth (the cube of a uniform fraction).
+ */
+static uint32_t
+bench_index(uint64_t *state, uint32_t n, int skewed) {
+	double u = (bench_rand(state) >> 11) / 9007199254740992.0;
+	if (skewed) {
+		u = u * u * u;
+	}
+	return (uint32_t) (u * n);
+}
+
+static void
+bench_lookups(const char *name, HashMap m, void **keys, uint32_t n,
+              uint64_t lookups, int skewed) {
+	uint64_t state = 2463534242ULL, i, found = 0;
+	double start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found += hashmap_get(m, keys[bench_index(&state, n, skewed)]) != NULL;
+	}
+	bench_report(name, lookups, bench_now() - start);
+	if (found != lookups) {
+		fprintf(stderr, "%s: lost keys\n", name);
+		exit(1);
+	}
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	uint64_t lookups = argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000;
+	void **keys = malloc(n * sizeof(void*));
+	uint64_t state = 88172645463325252ULL, i, found = 0;
+	HashMap m;
+	double start;
+
+	/* odd keys are stored, even ones are used for misses */
+	for (i = 0; i < n; i++) {
+		keys[i] = (void*) (uintptr_t) (bench_rand(&state) | 1);
+	}
+
+	m = hashmap_create(NULL, NULL);
+	start = bench_now();
+	for (i = 0; i < n; i++) {
+		hashmap_put(m, keys[i], keys[i]);
+	}
+	bench_report("hashmap put", n, bench_now() - start);
+	hashmap_free(m);
+
+	m = hashmap_create(NULL, NULL);
+	start = bench_now();
+	hashmap_put_batch(m, keys, keys, n);
+	bench_report("hashmap put_batch", n, bench_now() - start);
+
+	bench_lookups("hashmap get uniform", m, keys, n, lookups, 0);
+	bench_lookups("hashmap get skewed", m, keys, n, lookups, 1);
+
+	start = bench_now();
+	for (i = 0; i < lookups; i++) {
+		found += hashmap_get(m, (void*) (uintptr_t) (bench_rand(&state) & ~UINT64_C(1))) != NULL;
+	}
+	bench_report("hashmap get missing", lookups, bench_now() - start);
+
+	start = bench_now();
+	for (i = 0; i < n; i++) {
+		hashmap_remove(m, keys[i]);
+	}
+	bench_report("hashmap remove", n, bench_now() - start);
+	if (found != 0 || hashmap_count(m) != 0) {
+		fprintf(stderr, "unexpected contents\n");
+		return 1;
+	}
+	hashmap_free(m);
+	free(keys);
+	return 0;
+}
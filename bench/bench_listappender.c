@@ -0,0 +1,130 @@
+/*
+ * bench_listappender.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Concurrent appends into one ArrayList: producers sharing a mutex around
+ * arraylist_append against a ListAppender, single-item and batched.
+ *
+ * usage: bench_listappender [items_per_producer] [max_producers]
+ */
+#include <stdlib.h>
+#include <pthread.h>
+#include "bench.h"
+#include "../src/listappender.h"
+
+#define APPEND_BATCH (16)
+
+struct append_bench {
+	ArrayList list;
+	pthread_mutex_t lock;
+	struct listappender_t appender;
+	uint32_t batch;
+	uintptr_t items_per_producer;
+};
+
+static void *
+mutex_producer(void *arg) {
+	struct append_bench *b = arg;
+	uintptr_t i;
+	for (i = 0; i < b->items_per_producer; i++) {
+		pthread_mutex_lock(&b->lock);
+		arraylist_append(b->list, (void*) (i + 1));
+		pthread_mutex_unlock(&b->lock);
+	}
+	return NULL;
+}
+
+static void *
+appender_producer(void *arg) {
+	struct append_bench *b = arg;
+	void* items[APPEND_BATCH];
+	uintptr_t i = 0;
+	uint32_t j, n;
+	while (i < b->items_per_producer) {
+		n = b->batch;
+		if (n > b->items_per_producer - i) {
+			n = b->items_per_producer - i;
+		}
+		for (j = 0; j < n; j++) {
+			items[j] = (void*) (i + j + 1);
+		}
+		if (n == 1) {
+			listappender_append(&b->appender, items[0]);
+		} else {
+			listappender_append_n(&b->appender, items, n);
+		}
+		i += n;
+	}
+	return NULL;
+}
+
+static void
+bench_producers(uint32_t producers, uint32_t batch, uintptr_t items_per_producer) {
+	struct append_bench b;
+	pthread_t *threads = malloc(producers * sizeof(pthread_t));
+	char name[64];
+	double start;
+	uint32_t i;
+
+	b.batch = batch;
+	b.items_per_producer = items_per_producer;
+	b.list = arraylist_create_heap_size(16, NULL);
+	if (batch == 0) {
+		pthread_mutex_init(&b.lock, NULL);
+	} else {
+		listappender_init(&b.appender, b.list);
+	}
+
+	start = bench_now();
+	for (i = 0; i < producers; i++) {
+		pthread_create(&threads[i], NULL,
+			batch == 0 ? mutex_producer : appender_producer, &b);
+	}
+	for (i = 0; i < producers; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	if (batch == 0) {
+		snprintf(name, sizeof(name), "mutex append producers=%u", producers);
+		pthread_mutex_destroy(&b.lock);
+	} else {
+		listappender_finish(&b.appender);
+		snprintf(name, sizeof(name), "listappender producers=%u batch=%u",
+			producers, batch);
+	}
+	bench_report(name, producers * items_per_producer, bench_now() - start);
+
+	arraylist_free(b.list);
+	free(threads);
+}
+
+int
+main(int argc, char **argv) {
+	uintptr_t items = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+	uint32_t max_producers = argc > 2 ? atoi(argv[2]) : 8;
+	uint32_t producers;
+	for (producers = 1; producers <= max_producers; producers *= 2) {
+		bench_producers(producers, 0, items);
+		bench_producers(producers, 1, items);
+		bench_producers(producers, APPEND_BATCH, items);
+	}
+	return 0;
+}
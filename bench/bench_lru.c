@@ -0,0 +1,86 @@
+/*
+ * bench_lru.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * LRUCache get/put benchmark: every operation is a get, and a miss is
+ * followed by a put of the same key, the usual read-through cache pattern.
+ * Keys are drawn uniformly or skewed towards a small hot set.
+ *
+ * usage: bench_lru [capacity] [keyspace] [operations]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/lrucache.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* Pick a key in 1..keyspace.  The skewed distribution takes the cube of a
+ * uniform fraction, so about 46% of the picks land in the lowest tenth.
+ */
+static uintptr_t
+bench_key(uint64_t *state, uint32_t keyspace, int skewed) {
+	double u = (bench_rand(state) >> 11) / 9007199254740992.0;
+	if (skewed) {
+		u = u * u * u;
+	}
+	return 1 + (uintptr_t) (u * keyspace);
+}
+
+static void
+bench_lru(const char *name, uint32_t capacity, uint32_t keyspace,
+          uint64_t ops, int skewed) {
+	LRUCache c = lrucache_create(capacity, NULL, NULL);
+	uint64_t state = 88172645463325252ULL, i, hits = 0;
+	uintptr_t key;
+	double start;
+	char label[64];
+
+	start = bench_now();
+	for (i = 0; i < ops; i++) {
+		key = bench_key(&state, keyspace, skewed);
+		if (lrucache_get(c, (void*) key) != NULL) {
+			hits++;
+		} else {
+			lrucache_put(c, (void*) key, (void*) key);
+		}
+	}
+	snprintf(label, sizeof(label), "%s (%.1f%% hits)", name, 100.0 * hits / ops);
+	bench_report(label, ops, bench_now() - start);
+	lrucache_free(c);
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t capacity = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+	uint32_t keyspace = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+	uint64_t ops = argc > 3 ? strtoull(argv[3], NULL, 10) : 10000000;
+	bench_lru("lrucache get/put uniform", capacity, keyspace, ops, 0);
+	bench_lru("lrucache get/put skewed", capacity, keyspace, ops, 1);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * bench_merge.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * K-way merge benchmark: k sorted shards of random keys merged with
+ * arraylist_merge_k(), streamed through arraylist_merge_next() in fixed size
+ * batches, and concatenated with arraylist_extend() and re-sorted.
+ *
+ * usage: bench_merge [items] [k] [batch]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/arraylist.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+static int8_t
+key_comparator(void *a, void *b) {
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	uint32_t k = argc > 2 ? strtoul(argv[2], NULL, 10) : 32;
+	uint32_t batch = argc > 3 ? strtoul(argv[3], NULL, 10) : 4096;
+	ArrayList *shards = malloc(k * sizeof(ArrayList));
+	void **buffer = malloc(batch * sizeof(void*));
+	uint64_t state = 88172645463325252ULL;
+	uintptr_t checksum = 0, streamed = 0;
+	ArrayList merged, sorted;
+	ArrayListMerge merge;
+	uint32_t i, got;
+	double start;
+
+	for (i = 0; i < k; i++) {
+		shards[i] = arraylist_create_heap_size(n / k + 1, key_comparator);
+	}
+	for (i = 0; i < n; i++) {
+		arraylist_append(shards[i % k], (void*) (uintptr_t) (bench_rand(&state) >> 1));
+	}
+	for (i = 0; i < k; i++) {
+		arraylist_sort(shards[i]);
+	}
+
+	merged = arraylist_create_heap(key_comparator);
+	start = bench_now();
+	arraylist_merge_k(shards, k, merged);
+	bench_report("arraylist_merge_k", n, bench_now() - start);
+
+	start = bench_now();
+	merge = arraylist_merge_create(shards, k, key_comparator);
+	while ((got = arraylist_merge_next(merge, buffer, batch)) > 0) {
+		for (i = 0; i < got; i++) {
+			checksum += (uintptr_t) buffer[i] * (streamed++ + 1);
+		}
+	}
+	arraylist_merge_free(merge);
+	bench_report("arraylist_merge_next batches", n, bench_now() - start);
+
+	sorted = arraylist_create_heap(key_comparator);
+	start = bench_now();
+	for (i = 0; i < k; i++) {
+		arraylist_extend(sorted, shards[i]);
+	}
+	arraylist_sort(sorted);
+	bench_report("arraylist_extend and arraylist_sort", n, bench_now() - start);
+
+	for (i = 0; i < n; i++) {
+		checksum -= (uintptr_t) merged->ptr_table[i] * (i + 1);
+		if (merged->ptr_table[i] != sorted->ptr_table[i]) {
+			fprintf(stderr, "merge differs from sort at %u\n", i);
+			return 1;
+		}
+	}
+	if (checksum != 0 || streamed != n) {
+		fprintf(stderr, "streamed merge differs\n");
+		return 1;
+	}
+	for (i = 0; i < k; i++) {
+		arraylist_free(shards[i]);
+	}
+	arraylist_free(merged);
+	arraylist_free(sorted);
+	free(shards);
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * bench_mpmc.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Throughput scaling of MPMCQueue from 1 to N producer/consumer pairs, with
+ * single-item and batched operations.
+ *
+ * usage: bench_mpmc [items_per_producer] [max_pairs]
+ */
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "bench.h"
+#include "../src/mpmcqueue.h"
+
+#define MPMC_CAPACITY (4096)
+#define MPMC_BATCH (16)
+
+struct mpmc_bench {
+	MPMCQueue q;
+	uint32_t batch;
+	uintptr_t items_per_producer;
+	atomic_uintptr_t remaining;
+};
+
+static void *
+mpmc_producer(void *arg) {
+	struct mpmc_bench *b = arg;
+	void* items[MPMC_BATCH];
+	uintptr_t i = 0;
+	uint32_t j, n;
+	while (i < b->items_per_producer) {
+		n = b->batch;
+		if (n > b->items_per_producer - i) {
+			n = b->items_per_producer - i;
+		}
+		for (j = 0; j < n; j++) {
+			items[j] = (void*) (i + j + 1);
+		}
+		for (j = 0; j < n; ) {
+			uint32_t sent = mpmcqueue_enqueue_batch(b->q, items + j, n - j);
+			if (sent == 0) {
+				sched_yield();
+			}
+			j += sent;
+		}
+		i += n;
+	}
+	return NULL;
+}
+
+static void *
+mpmc_consumer(void *arg) {
+	struct mpmc_bench *b = arg;
+	void* items[MPMC_BATCH];
+	uint32_t n;
+	while (atomic_load_explicit(&b->remaining, memory_order_relaxed) > 0) {
+		if ((n = mpmcqueue_dequeue_batch(b->q, items, b->batch)) == 0) {
+			sched_yield();
+		} else {
+			atomic_fetch_sub_explicit(&b->remaining, n, memory_order_relaxed);
+		}
+	}
+	return NULL;
+}
+
+static void
+bench_pairs(uint32_t pairs, uint32_t batch, uintptr_t items_per_producer) {
+	struct mpmc_bench b;
+	pthread_t *threads = malloc(2 * pairs * sizeof(pthread_t));
+	char name[64];
+	double start;
+	uint32_t i;
+
+	b.q = mpmcqueue_create(MPMC_CAPACITY);
+	b.batch = batch;
+	b.items_per_producer = items_per_producer;
+	atomic_init(&b.remaining, pairs * items_per_producer);
+
+	start = bench_now();
+	for (i = 0; i < pairs; i++) {
+		pthread_create(&threads[2 * i], NULL, mpmc_producer, &b);
+		pthread_create(&threads[2 * i + 1], NULL, mpmc_consumer, &b);
+	}
+	for (i = 0; i < 2 * pairs; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	snprintf(name, sizeof(name), "mpmcqueue pairs=%u batch=%u", pairs, batch);
+	bench_report(name, pairs * items_per_producer, bench_now() - start);
+
+	mpmcqueue_free(b.q);
+	free(threads);
+}
+
+int
+main(int argc, char **argv) {
+	uintptr_t items = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+	uint32_t max_pairs = argc > 2 ? atoi(argv[2]) : 8;
+	uint32_t pairs;
+	for (pairs = 1; pairs <= max_pairs; pairs *= 2) {
+		bench_pairs(pairs, 1, items);
+		bench_pairs(pairs, MPMC_BATCH, items);
+	}
+	return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * bench_ordereddict.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * OrderedDict benchmark: move_to_end on random keys, against the same
+ * reordering done on a Deque with deque_remove() and deque_append(), then a
+ * full ordered walk and popping every item from the front.  The Deque takes
+ * its nodes from a preallocated array, so it holds every key whether or not
+ * DEQUE_STATIC is defined.
+ *
+ * usage: bench_ordereddict [keys] [moves] [deque moves]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/deque.h"
+#include "../src/ordereddict.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+	uint64_t moves = argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000;
+	uint64_t deque_moves = argc > 3 ? strtoull(argv[3], NULL, 10) : 10000;
+	OrderedDict d = ordereddict_create_size(n, NULL, NULL);
+	struct deque_node_t *nodes = malloc(n * sizeof(struct deque_node_t));
+	struct deque_t q;
+	uint64_t state = 88172645463325252ULL, i, sum = 0;
+	uint32_t iter = 0;
+	uintptr_t key;
+	void *k, *v;
+	double start;
+
+	deque_init_preallocated(&q, n, NULL, nodes);
+	for (key = 1; key <= n; key++) {
+		ordereddict_put(d, (void*) key, (void*) key);
+		deque_append(&q, (void*) key);
+	}
+
+	start = bench_now();
+	for (i = 0; i < moves; i++) {
+		key = 1 + bench_rand(&state) % n;
+		ordereddict_move_to_end(d, (void*) key, key & 1);
+	}
+	bench_report("ordereddict move_to_end", moves, bench_now() - start);
+
+	start = bench_now();
+	for (i = 0; i < deque_moves; i++) {
+		key = 1 + bench_rand(&state) % n;
+		deque_remove(&q, (void*) key);
+		deque_append(&q, (void*) key);
+	}
+	bench_report("deque remove and append", deque_moves, bench_now() - start);
+
+	start = bench_now();
+	while (ordereddict_next(d, &iter, &k, &v)) {
+		sum += (uintptr_t) v;
+	}
+	bench_report("ordereddict iterate", n, bench_now() - start);
+
+	start = bench_now();
+	while (ordereddict_popitem(d, false, &k, &v) == ORDEREDDICT_SUCCESS) {
+		sum -= (uintptr_t) v;
+	}
+	bench_report("ordereddict popitem first", n, bench_now() - start);
+	if (sum != 0) {
+		fprintf(stderr, "lost items\n");
+		return 1;
+	}
+	ordereddict_free(d);
+	deque_clear(&q);
+	free(nodes);
+	return 0;
+}
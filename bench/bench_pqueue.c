@@ -0,0 +1,131 @@
+/*
+ * bench_pqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Priority queue benchmark.  A queue of a fixed size takes a batch of
+ * random items and gives back the same number of smallest items, over and
+ * over.  The 4-ary PQueue is compared with the same heap at arity 2 and with
+ * the old approach of re-sorting an ArrayList after every batch.
+ *
+ * usage: bench_pqueue [queue size] [batch size] [rounds]
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/pqueue.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+static int8_t
+int_comparator(void *a, void *b) {
+	uintptr_t x = (uintptr_t) a, y = (uintptr_t) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void
+bench_heap(const char *name, const char *heapify_name, uint32_t arity,
+           uint32_t size, uint32_t batch, uint32_t rounds) {
+	struct pqueue_t q;
+	void **items = malloc(batch * sizeof(void*));
+	uint64_t state = 88172645463325252ULL;
+	uintptr_t checksum = 0;
+	uint32_t r, i;
+	double start;
+
+	pqueue_init(&q, arraylist_create_heap_size(size + batch, int_comparator), arity);
+	for (i = 0; i < size; i++) {
+		arraylist_append(q.list, (void*) (uintptr_t) bench_rand(&state));
+	}
+	start = bench_now();
+	pqueue_heapify(&q);
+	bench_report(heapify_name, size, bench_now() - start);
+
+	start = bench_now();
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < batch; i++) {
+			items[i] = (void*) (uintptr_t) bench_rand(&state);
+		}
+		pqueue_push_batch(&q, items, batch);
+		for (i = 0; i < batch; i++) {
+			checksum += (uintptr_t) pqueue_pop(&q);
+		}
+	}
+	bench_report(name, (uint64_t) rounds * batch, bench_now() - start);
+	arraylist_free(q.list);
+	free(items);
+	if (checksum == 42) {
+		printf("\n");
+	}
+}
+
+static void
+bench_sort_per_batch(uint32_t size, uint32_t batch, uint32_t rounds) {
+	ArrayList list = arraylist_create_heap_size(size + batch, int_comparator);
+	uint64_t state = 88172645463325252ULL;
+	uintptr_t checksum = 0;
+	uint32_t r, i;
+	double start;
+
+	for (i = 0; i < size; i++) {
+		arraylist_append(list, (void*) (uintptr_t) bench_rand(&state));
+	}
+	start = bench_now();
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < batch; i++) {
+			arraylist_append(list, (void*) (uintptr_t) bench_rand(&state));
+		}
+		arraylist_sort(list);
+		/* take the smallest items off the front */
+		for (i = 0; i < batch; i++) {
+			checksum += (uintptr_t) list->ptr_table[i];
+		}
+		memmove(list->ptr_table, list->ptr_table + batch, size * sizeof(void*));
+		list->number_items = size;
+	}
+	bench_report("arraylist sort per batch", (uint64_t) rounds * batch,
+	             bench_now() - start);
+	arraylist_free(list);
+	if (checksum == 42) {
+		printf("\n");
+	}
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t size = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+	uint32_t batch = argc > 2 ? strtoul(argv[2], NULL, 10) : 64;
+	uint32_t rounds = argc > 3 ? strtoul(argv[3], NULL, 10) : 20000;
+	bench_heap("pqueue 4-ary push batch/pop", "pqueue 4-ary heapify", 4,
+	           size, batch, rounds);
+	bench_heap("pqueue binary push batch/pop", "pqueue binary heapify", 2,
+	           size, batch, rounds);
+	/* far slower, so run a hundredth of the rounds */
+	bench_sort_per_batch(size, batch, rounds / 100 > 0 ? rounds / 100 : 1);
+	return 0;
+}
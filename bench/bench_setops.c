@@ -0,0 +1,111 @@
+/*
+ * bench_setops.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Sorted-list set algebra benchmark on posting lists of increasing integer ids:
+ * a short list intersected with, and subtracted from, a long one, and two
+ * lists of equal length intersected and unioned.
+ *
+ * usage: bench_setops [long] [short] [rounds]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/arraylist.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+static int8_t
+id_comparator(void *a, void *b) {
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* A posting list of n ids with gaps averaging spread */
+static ArrayList
+posting_list(uint32_t n, uint32_t spread, uint64_t *state) {
+	ArrayList l = arraylist_create_heap_size(n, id_comparator);
+	uintptr_t id = 0;
+	uint32_t i;
+	for (i = 0; i < n; i++) {
+		id += 1 + bench_rand(state) % (2 * spread);
+		arraylist_append(l, (void*) id);
+	}
+	return l;
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	uint32_t k = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+	uint32_t rounds = argc > 3 ? strtoul(argv[3], NULL, 10) : 100;
+	uint64_t state = 88172645463325252ULL, found = 0;
+	ArrayList big, small, other, out;
+	uint32_t i;
+	double start;
+
+	big = posting_list(n, 4, &state);
+	small = posting_list(k, 4 * (n / k), &state);
+	other = posting_list(n, 4, &state);
+	out = arraylist_create_heap_size(n, id_comparator);
+
+	start = bench_now();
+	for (i = 0; i < rounds; i++) {
+		out->number_items = 0;
+		arraylist_intersection(small, big, out);
+		found += arraylist_count(out);
+	}
+	bench_report("intersection short with long", (uint64_t) rounds * k, bench_now() - start);
+
+	start = bench_now();
+	for (i = 0; i < rounds; i++) {
+		out->number_items = 0;
+		arraylist_difference(small, big, out);
+		found += arraylist_count(out);
+	}
+	bench_report("difference short minus long", (uint64_t) rounds * k, bench_now() - start);
+
+	start = bench_now();
+	out->number_items = 0;
+	arraylist_intersection(big, other, out);
+	bench_report("intersection equal lengths", n, bench_now() - start);
+
+	arraylist_free(out);
+	out = arraylist_create_heap_size(2 * n, id_comparator);
+	start = bench_now();
+	arraylist_union(big, other, out);
+	bench_report("union equal lengths", 2 * n, bench_now() - start);
+	if (found != (uint64_t) rounds * k) {
+		fprintf(stderr, "intersection and difference do not add up\n");
+		return 1;
+	}
+	arraylist_free(big);
+	arraylist_free(small);
+	arraylist_free(other);
+	arraylist_free(out);
+	return 0;
+}
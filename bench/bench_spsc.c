@@ -0,0 +1,190 @@
+/*
+ * bench_spsc.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Two-thread hand-off benchmark: SPSCQueue (single and batched operations)
+ * against a Deque wrapped in a mutex.  With DEQUE_STATIC the Deque holds at
+ * most DEQUE_MAX_NODES items, so the queue is also run at that capacity for
+ * a like for like comparison.
+ *
+ * usage: bench_spsc [items]
+ */
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "bench.h"
+#include "../src/spscqueue.h"
+#include "../src/deque.h"
+
+#define SPSC_CAPACITY (1024)
+#define SPSC_BATCH (32)
+
+static uintptr_t number_items;
+
+struct locked_deque {
+	pthread_mutex_t lock;
+	struct deque_t d;
+};
+
+static void *
+spsc_producer(void *arg) {
+	SPSCQueue q = arg;
+	uintptr_t i;
+	for (i = 1; i <= number_items; i++) {
+		while (spscqueue_enqueue(q, (void*) i) != SPSCQUEUE_SUCCESS) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *
+spsc_batch_producer(void *arg) {
+	SPSCQueue q = arg;
+	void* items[SPSC_BATCH];
+	uintptr_t i = 1;
+	uint32_t j, n, sent;
+	while (i <= number_items) {
+		n = number_items - i + 1 < SPSC_BATCH ? number_items - i + 1 : SPSC_BATCH;
+		for (j = 0; j < n; j++) {
+			items[j] = (void*) (i + j);
+		}
+		for (sent = 0; sent < n; ) {
+			if ((j = spscqueue_enqueue_batch(q, items + sent, n - sent)) == 0) {
+				sched_yield();
+			}
+			sent += j;
+		}
+		i += n;
+	}
+	return NULL;
+}
+
+static void *
+deque_producer(void *arg) {
+	struct locked_deque *ld = arg;
+	deque_result_t result;
+	uintptr_t i;
+	for (i = 1; i <= number_items; i++) {
+		do {
+			pthread_mutex_lock(&ld->lock);
+			result = deque_append(&ld->d, (void*) i);
+			pthread_mutex_unlock(&ld->lock);
+			if (result != DEQUE_SUCCESS) {
+				sched_yield();
+			}
+		} while (result != DEQUE_SUCCESS);
+	}
+	return NULL;
+}
+
+static void
+bench_spsc(uint32_t capacity) {
+	SPSCQueue q = spscqueue_create(capacity);
+	pthread_t producer;
+	uintptr_t received = 0;
+	char name[64];
+	double start = bench_now();
+	pthread_create(&producer, NULL, spsc_producer, q);
+	while (received < number_items) {
+		if (spscqueue_dequeue(q) != NULL) {
+			received++;
+		} else {
+			sched_yield();
+		}
+	}
+	pthread_join(producer, NULL);
+	snprintf(name, sizeof(name), "spscqueue enqueue/dequeue cap=%u",
+		spscqueue_capacity(q));
+	bench_report(name, number_items, bench_now() - start);
+	spscqueue_free(q);
+}
+
+static void
+bench_spsc_batch(uint32_t capacity) {
+	SPSCQueue q = spscqueue_create(capacity);
+	pthread_t producer;
+	void* items[SPSC_BATCH];
+	uintptr_t received = 0;
+	uint32_t n;
+	char name[64];
+	double start = bench_now();
+	pthread_create(&producer, NULL, spsc_batch_producer, q);
+	while (received < number_items) {
+		if ((n = spscqueue_dequeue_batch(q, items, SPSC_BATCH)) == 0) {
+			sched_yield();
+		}
+		received += n;
+	}
+	pthread_join(producer, NULL);
+	snprintf(name, sizeof(name), "spscqueue batch x%u cap=%u", SPSC_BATCH,
+		spscqueue_capacity(q));
+	bench_report(name, number_items, bench_now() - start);
+	spscqueue_free(q);
+}
+
+static void
+bench_locked_deque(void) {
+	struct locked_deque ld;
+	pthread_t producer;
+	uintptr_t received = 0;
+	void* item;
+	char name[64];
+	double start;
+
+	pthread_mutex_init(&ld.lock, NULL);
+	deque_init(&ld.d, NULL);
+	start = bench_now();
+	pthread_create(&producer, NULL, deque_producer, &ld);
+	while (received < number_items) {
+		pthread_mutex_lock(&ld.lock);
+		item = deque_popleft(&ld.d);
+		pthread_mutex_unlock(&ld.lock);
+		if (item != NULL) {
+			received++;
+		} else {
+			sched_yield();
+		}
+	}
+	pthread_join(producer, NULL);
+#ifdef DEQUE_STATIC
+	snprintf(name, sizeof(name), "mutex + deque append/popleft cap=%u", DEQUE_MAX_NODES);
+#else
+	snprintf(name, sizeof(name), "mutex + deque append/popleft");
+#endif
+	bench_report(name, number_items, bench_now() - start);
+	deque_clear(&ld.d);
+	pthread_mutex_destroy(&ld.lock);
+}
+
+int
+main(int argc, char **argv) {
+	number_items = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	bench_spsc(SPSC_CAPACITY);
+	bench_spsc_batch(SPSC_CAPACITY);
+#ifdef DEQUE_STATIC
+	bench_spsc(DEQUE_MAX_NODES);
+	bench_spsc_batch(DEQUE_MAX_NODES);
+#endif
+	bench_locked_deque();
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * bench_timerwheel.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * TimerWheel benchmark: schedule a large number of outstanding timers with
+ * random expiries, cancel and reschedule a share of them, then advance the
+ * clock tick by tick until every timer has fired.
+ *
+ * usage: bench_timerwheel [timers] [ticks]
+ */
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/timerwheel.h"
+
+static uint64_t
+bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+int
+main(int argc, char **argv) {
+	uint32_t number_timers = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+	uint64_t ticks = argc > 2 ? strtoull(argv[2], NULL, 10) : 1 << 20;
+	struct timerwheel_timer_t *timers;
+	struct ideque_t expired;
+	TimerWheel w;
+	uint64_t state = 88172645463325252ULL, fired = 0, now;
+	uint32_t i, cancelled = 0;
+	double start;
+
+	timers = malloc(number_timers * sizeof(struct timerwheel_timer_t));
+	w = timerwheel_create(0);
+	if (timers == NULL || w == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	ideque_init(&expired);
+	for (i = 0; i < number_timers; i++) {
+		timerwheel_timer_init(&timers[i]);
+	}
+
+	start = bench_now();
+	for (i = 0; i < number_timers; i++) {
+		timerwheel_schedule(w, &timers[i], 1 + bench_rand(&state) % ticks);
+	}
+	bench_report("timerwheel schedule", number_timers, bench_now() - start);
+
+	/* cancel one timer in eight and push one in eight further out */
+	start = bench_now();
+	for (i = 0; i < number_timers; i += 8) {
+		cancelled += timerwheel_cancel(w, &timers[i]);
+	}
+	for (i = 4; i < number_timers; i += 8) {
+		timerwheel_schedule(w, &timers[i], timers[i].expires + ticks / 2);
+	}
+	bench_report("timerwheel cancel/reschedule", (number_timers + 3) / 4,
+	             bench_now() - start);
+
+	start = bench_now();
+	for (now = 1; timerwheel_count(w) > 0; now++) {
+		fired += timerwheel_advance(w, now, &expired);
+		ideque_init(&expired); /* drop the batch */
+	}
+	bench_report("timerwheel advance (timers fired)", fired, bench_now() - start);
+	printf("%u cancelled, %llu fired over %llu ticks\n", cancelled,
+	       (unsigned long long) fired, (unsigned long long) now - 1);
+
+	timerwheel_free(w);
+	free(timers);
+	return 0;
+}
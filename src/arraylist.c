@@ -31,6 +31,9 @@
 #include <malloc.h>
 #include <string.h>
 #include "arraylist.h"
+#ifdef ARRAYLIST_FILTER
+#include "bloomfilter.h"
+#endif /* ARRAYLIST_FILTER */
 
 #define DEFAULT_ARRAYLIST_SIZE 10
 
@@ -62,6 +65,79 @@ arraylist_memcheck(ArrayList list) {
 	return ARRAYLIST_SUCCESS;
 }
 
+/* Make room for extra more items in one step
+ * 
+ * Fixed size lists without the room return ARRAYLIST_ERROR, as does a
+ * failed allocation.
+ */
+static uint8_t
+arraylist_reserve(ArrayList list, uint32_t extra) {
+	void *new_table;
+	if (list->capacity - list->number_items >= extra) {
+		return ARRAYLIST_SUCCESS;
+	}
+	if (list->list_type == ARRAYLIST_TYPE_FIXED) {
+		return ARRAYLIST_ERROR;
+	}
+	new_table = malloc(sizeof(void*) * (list->number_items + extra));
+	if (new_table == NULL) {
+		return ARRAYLIST_ERROR;
+	}
+	memcpy(new_table, list->ptr_table, sizeof(void*) * list->number_items);
+	free(list->ptr_table);
+	list->ptr_table = new_table;
+	list->capacity = list->number_items + extra;
+	return ARRAYLIST_SUCCESS;
+}
+
+#ifdef ARRAYLIST_FILTER
+/* Add the items from index from on, written straight into the ptr_table,
+ * to the list's filter if it has one
+ */
+static void
+arraylist_filter_added(ArrayList list, uint32_t from) {
+	if (list->filter != NULL) {
+		for (; from < list->number_items; from++) {
+			bloomfilter_add(list->filter, list->ptr_table[from]);
+		}
+	}
+}
+
+static void
+arraylist_filter_add(ArrayList list, const void *item) {
+	if (list->filter != NULL) {
+		bloomfilter_add(list->filter, item);
+	}
+}
+
+static void
+arraylist_filter_remove(ArrayList list, const void *item) {
+	if (list->filter != NULL) {
+		bloomfilter_remove(list->filter, item);
+	}
+}
+
+/* Return non-zero if the list's filter says item is certainly not there */
+static int
+arraylist_filter_rejects(ArrayList list, const void *item) {
+	return list->filter != NULL && !bloomfilter_contains(list->filter, item);
+}
+
+/* Record that the filter let through an item that was not there */
+static void
+arraylist_filter_missed(ArrayList list) {
+	if (list->filter != NULL) {
+		bloomfilter_note_false_positive(list->filter);
+	}
+}
+#else
+#define arraylist_filter_added(list, from) ((void) (from))
+#define arraylist_filter_add(list, item) ((void) 0)
+#define arraylist_filter_remove(list, item) ((void) 0)
+#define arraylist_filter_rejects(list, item) (0)
+#define arraylist_filter_missed(list) ((void) 0)
+#endif /* ARRAYLIST_FILTER */
+
 /*
  * Interface function implementations
  */
@@ -105,6 +181,7 @@ arraylist_create_heap_size(const uint32_t items,
 	list->capacity = items;
 	list->list_type = ARRAYLIST_TYPE_EXPANDING;
 	list->compare_func = compare_func;
+	list->filter = NULL;
 	return list;
 }
 
@@ -129,6 +206,7 @@ arraylist_create_static(const void *dataPtr, const uint32_t size,
 	list->capacity = size;
 	list->list_type = ARRAYLIST_TYPE_FIXED;
 	list->compare_func = compare_func;
+	list->filter = NULL;
 	return list;
 }
 
@@ -163,6 +241,7 @@ arraylist_append(ArrayList list, void *item) {
 	/* all clear at this point, append away */
 	list->ptr_table[list->number_items] = item;
 	list->number_items++;
+	arraylist_filter_add(list, item);
 	return ARRAYLIST_SUCCESS;
 }
 
@@ -234,6 +313,7 @@ arraylist_insert(ArrayList list, const int insert_index, void *item) {
 
 	list->ptr_table[insert_index] = item;
 	list->number_items++;
+	arraylist_filter_add(list, item);
 
 	return ARRAYLIST_SUCCESS;
 }
@@ -247,15 +327,8 @@ arraylist_insert(ArrayList list, const int insert_index, void *item) {
  */
 void*
 arraylist_remove(ArrayList list, const void* item) {
-	int i;
-	void **tmp;
-	for (i = 0; i < list->number_items; i++) {
-		tmp = list->ptr_table[i];
-		if (tmp == item) {
-			return arraylist_pop_item(list, i);
-		}
-	}
-	return NULL;
+	int32_t i = arraylist_index(list, item);
+	return i >= 0 ? arraylist_pop_item(list, i) : NULL;
 }
 
 /* Pop the rightmost element from the list
@@ -279,6 +352,7 @@ arraylist_pop_item(ArrayList list, const int popIndex) {
 
 	/* copy the ptr while we still have access then overwrite */
 	popped_item = list->ptr_table[popIndex];
+	arraylist_filter_remove(list, popped_item);
 
 	/* shift items to the right left by one */
 	for (i = popIndex; i < list->number_items; i++) {
@@ -292,16 +366,21 @@ arraylist_pop_item(ArrayList list, const int popIndex) {
 /* Get the index of the first item equal to the specified item
  * 
  * If an item cannot be found in the list that does not match the specified
- * index, then -1 is returned.
+ * index, then -1 is returned.  With a filter set (see arraylist_set_filter())
+ * most items that are not in the list are turned away without a search.
  */
 int32_t
 arraylist_index(ArrayList list, const void *item) {
 	int i;
+	if (arraylist_filter_rejects(list, item)) {
+		return -1;
+	}
 	for (i = 0; i < list->number_items; i++) {
 		if (list->ptr_table[i] == item) {
 			return (int32_t) i;
 		}
 	}
+	arraylist_filter_missed(list);
 	return -1; /* Error */
 }
 
@@ -386,3 +465,326 @@ void
 arraylist_sort(ArrayList list) {
 	arraylist_quicksort(list, 0, list->number_items - 1);
 }
+
+/* Return true if the next item of list a comes before that of list b
+ * 
+ * A list with nothing left loses to any other, and items that compare
+ * equal are taken from the earlier list first so that the merge is stable.
+ */
+static int
+merge_beats(ArrayListMerge merge, uint32_t a, uint32_t b) {
+	int8_t order;
+	if (merge->pos[a] == merge->lists[a]->number_items) {
+		return 0;
+	} else if (merge->pos[b] == merge->lists[b]->number_items) {
+		return 1;
+	}
+	order = (*merge->compare_func)(merge->lists[a]->ptr_table[merge->pos[a]],
+	                               merge->lists[b]->ptr_table[merge->pos[b]]);
+	return order < 0 || (order == 0 && a < b);
+}
+
+/* Start merging k lists, each sorted by compare_func
+ * 
+ * The lists are merged with a loser tree: each inner node of a tournament
+ * between the lists remembers the loser of its match, so after the winner's
+ * item is taken only the matches on its path to the root are replayed.
+ * Each item then costs about log2(k) comparisons.  The lists must not be
+ * changed until the merge is freed.  NULL is returned if memory cannot be
+ * allocated.
+ */
+ArrayListMerge
+arraylist_merge_create(ArrayList *lists, const uint32_t k,
+                       int8_t(*compare_func)(void*, void*)) {
+	ArrayListMerge merge;
+	uint32_t *winners, i, node;
+
+	merge = malloc(sizeof(struct arraylist_merge_t) + (3 * k + 1) * sizeof(uint32_t));
+	if (merge == NULL) {
+		return NULL;
+	}
+	merge->lists = lists;
+	merge->k = k;
+	merge->compare_func = compare_func;
+	merge->pos = (uint32_t *) (merge + 1);
+	merge->tree = merge->pos + k;
+	memset(merge->pos, 0, k * sizeof(uint32_t));
+
+	/* play the tournament bottom up, with leaf i at k + i and each inner
+	 * node holding its winner, then replace each winner by the child that
+	 * lost to it, from the root down so every child is still a winner
+	 */
+	winners = merge->tree;
+	for (i = 0; i < k; i++) {
+		winners[k + i] = i;
+	}
+	for (node = k; node-- > 1;) {
+		winners[node] = merge_beats(merge, winners[2 * node + 1], winners[2 * node])
+		                ? winners[2 * node + 1] : winners[2 * node];
+	}
+	merge->tree[0] = k > 1 ? winners[1] : 0;
+	for (node = 1; node < k; node++) {
+		merge->tree[node] = winners[2 * node] == winners[node]
+		                    ? winners[2 * node + 1] : winners[2 * node];
+	}
+	return merge;
+}
+
+/* Move up to n of the next merged items into out and return how many were
+ * moved, 0 once every list has been merged
+ */
+uint32_t
+arraylist_merge_next(ArrayListMerge merge, void **out, const uint32_t n) {
+	uint32_t count, winner, node, tmp;
+	if (merge->k == 0) {
+		return 0;
+	}
+	for (count = 0; count < n; count++) {
+		winner = merge->tree[0];
+		if (merge->pos[winner] == merge->lists[winner]->number_items) {
+			break; /* the best list is empty, so all of them are */
+		}
+		out[count] = merge->lists[winner]->ptr_table[merge->pos[winner]++];
+
+		/* replay the winner's matches on the way back to the root */
+		for (node = (merge->k + winner) / 2; node >= 1; node /= 2) {
+			if (merge_beats(merge, merge->tree[node], winner)) {
+				tmp = merge->tree[node];
+				merge->tree[node] = winner;
+				winner = tmp;
+			}
+		}
+		merge->tree[0] = winner;
+	}
+	return count;
+}
+
+/* Free a merge started with arraylist_merge_create().  The lists are not
+ * freed.
+ */
+void
+arraylist_merge_free(ArrayListMerge merge) {
+	free(merge);
+}
+
+/* Append the items of k lists, each sorted by out's compare_func, to out in
+ * sorted order
+ * 
+ * This takes O(n log k) time for n items in total, against O(n log n) for
+ * extending out with every list and sorting it.  Items that compare equal
+ * keep the order of the lists they came from.  ARRAYLIST_ERROR is returned
+ * if out is fixed size and too small, or memory cannot be allocated.
+ */
+uint8_t
+arraylist_merge_k(ArrayList *lists, const uint32_t k, ArrayList out) {
+	ArrayListMerge merge;
+	uint32_t i, start, total = 0;
+
+	for (i = 0; i < k; i++) {
+		total += lists[i]->number_items;
+	}
+	if (arraylist_reserve(out, total) != ARRAYLIST_SUCCESS) {
+		return ARRAYLIST_ERROR;
+	}
+	if ((merge = arraylist_merge_create(lists, k, out->compare_func)) == NULL) {
+		return ARRAYLIST_ERROR;
+	}
+	start = out->number_items;
+	out->number_items += arraylist_merge_next(merge, out->ptr_table + out->number_items, total);
+	arraylist_merge_free(merge);
+	arraylist_filter_added(out, start);
+	return ARRAYLIST_SUCCESS;
+}
+
+/* Return the first index from lo on whose item is not less than item
+ * 
+ * This is a galloping (exponential) search: it steps ahead 1, 2, 4, 8, ...
+ * places at a time until it passes item, then binary searches the last
+ * step.  Finding an index d places ahead takes about 2 log2(d)
+ * comparisons, so walking a short list through a long one costs
+ * O(k log(n / k)) rather than O(n).
+ */
+static uint32_t
+arraylist_gallop(ArrayList list, uint32_t lo, void *item,
+                 int8_t(*compare_func)(void*, void*)) {
+	uint32_t step = 1, hi = lo, mid;
+	while (hi < list->number_items && (*compare_func)(list->ptr_table[hi], item) < 0) {
+		lo = hi + 1;
+		hi = lo + step;
+		step *= 2;
+	}
+	if (hi > list->number_items) {
+		hi = list->number_items;
+	}
+
+	/* the answer is in [lo, hi] */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if ((*compare_func)(list->ptr_table[mid], item) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/* Append list->ptr_table[from] to [to - 1] to out, which has the room */
+static void
+arraylist_copy_run(ArrayList out, ArrayList list, uint32_t from, uint32_t to) {
+	memcpy(out->ptr_table + out->number_items, list->ptr_table + from,
+	       sizeof(void*) * (to - from));
+	out->number_items += to - from;
+}
+
+/* Append the union of sorted lists a and b to out
+ * 
+ * a and b must be sorted by a's compare_func, and out must be a different
+ * list.  Items found in both are written once, taking a's.  If an item
+ * repeats, it is written as many times as it appears in whichever of a or
+ * b has more of it.  The shorter list is walked item by item while the
+ * longer one is galloped through and copied in runs, so there are
+ * O(k log(n / k)) comparisons for lists of k and n items.
+ * ARRAYLIST_ERROR is returned if out is fixed size and too small, or
+ * memory cannot be allocated.
+ */
+uint8_t
+arraylist_union(ArrayList a, ArrayList b, ArrayList out) {
+	ArrayList small = a, big = b;
+	uint32_t i, j = 0, next, start = out->number_items;
+
+	if (a->number_items > b->number_items) {
+		small = b;
+		big = a;
+	}
+	if (arraylist_reserve(out, a->number_items + b->number_items) != ARRAYLIST_SUCCESS) {
+		return ARRAYLIST_ERROR;
+	}
+	for (i = 0; i < small->number_items; i++) {
+		next = arraylist_gallop(big, j, small->ptr_table[i], a->compare_func);
+		arraylist_copy_run(out, big, j, next);
+		if (next < big->number_items
+		    && (*a->compare_func)(big->ptr_table[next], small->ptr_table[i]) == 0) {
+			out->ptr_table[out->number_items++] = a->ptr_table[small == a ? i : next];
+			next++;
+		} else {
+			out->ptr_table[out->number_items++] = small->ptr_table[i];
+		}
+		j = next;
+	}
+	arraylist_copy_run(out, big, j, big->number_items);
+	arraylist_filter_added(out, start);
+	return ARRAYLIST_SUCCESS;
+}
+
+/* Append the items of sorted list a that are also in sorted list b to out
+ * 
+ * The same rules as arraylist_union() apply; an item that repeats is
+ * written as many times as it appears in whichever list has fewer of it.
+ * Only the shorter list is read in full, so intersecting k items with n
+ * takes O(k log(n / k)) comparisons.
+ */
+uint8_t
+arraylist_intersection(ArrayList a, ArrayList b, ArrayList out) {
+	ArrayList small = a, big = b;
+	uint32_t i, j = 0, start = out->number_items;
+
+	if (a->number_items > b->number_items) {
+		small = b;
+		big = a;
+	}
+	if (arraylist_reserve(out, small->number_items) != ARRAYLIST_SUCCESS) {
+		return ARRAYLIST_ERROR;
+	}
+	for (i = 0; i < small->number_items; i++) {
+		j = arraylist_gallop(big, j, small->ptr_table[i], a->compare_func);
+		if (j == big->number_items) {
+			break;
+		}
+		if ((*a->compare_func)(big->ptr_table[j], small->ptr_table[i]) == 0) {
+			out->ptr_table[out->number_items++] = a->ptr_table[small == a ? i : j];
+			j++;
+		}
+	}
+	arraylist_filter_added(out, start);
+	return ARRAYLIST_SUCCESS;
+}
+
+/* Append the items of sorted list a that are not in sorted list b to out
+ * 
+ * The same rules as arraylist_union() apply; each item of b cancels one
+ * equal item of a.  Comparisons are O(k log(n / k)) whichever list is the
+ * shorter, though every item kept from a is still copied.
+ */
+uint8_t
+arraylist_difference(ArrayList a, ArrayList b, ArrayList out) {
+	uint32_t i = 0, j = 0, next, start = out->number_items;
+
+	if (arraylist_reserve(out, a->number_items) != ARRAYLIST_SUCCESS) {
+		return ARRAYLIST_ERROR;
+	}
+	if (a->number_items <= b->number_items) {
+		for (i = 0; i < a->number_items; i++) {
+			j = arraylist_gallop(b, j, a->ptr_table[i], a->compare_func);
+			if (j < b->number_items
+			    && (*a->compare_func)(b->ptr_table[j], a->ptr_table[i]) == 0) {
+				j++;
+			} else {
+				out->ptr_table[out->number_items++] = a->ptr_table[i];
+			}
+		}
+		arraylist_filter_added(out, start);
+		return ARRAYLIST_SUCCESS;
+	}
+	for (j = 0; j < b->number_items && i < a->number_items; j++) {
+		next = arraylist_gallop(a, i, b->ptr_table[j], a->compare_func);
+		arraylist_copy_run(out, a, i, next);
+		if (next < a->number_items
+		    && (*a->compare_func)(a->ptr_table[next], b->ptr_table[j]) == 0) {
+			next++;
+		}
+		i = next;
+	}
+	arraylist_copy_run(out, a, i, a->number_items);
+	arraylist_filter_added(out, start);
+	return ARRAYLIST_SUCCESS;
+}
+
+/* Remove repeats from a sorted list in place, keeping the first of each
+ * run of equal items, and return the number of items left
+ */
+uint32_t
+arraylist_unique(ArrayList list) {
+	uint32_t i, kept = 0;
+	for (i = 0; i < list->number_items; i++) {
+		if (kept == 0
+		    || (*list->compare_func)(list->ptr_table[kept - 1], list->ptr_table[i]) != 0) {
+			list->ptr_table[kept++] = list->ptr_table[i];
+		} else {
+			arraylist_filter_remove(list, list->ptr_table[i]);
+		}
+	}
+	list->number_items = kept;
+	return kept;
+}
+
+/* Keep filter up to date with the list's items, so that arraylist_index(),
+ * arraylist_contains() and arraylist_remove() can turn away most items
+ * that are not in the list without searching it
+ * 
+ * The filter is cleared and the current items added.  From then on every
+ * list operation adds and removes items in it as well, except writes made
+ * straight into ptr_table.  The filter is not freed with the list, and
+ * passing NULL detaches it.  Since the list compares items by address, the
+ * filter's hash can be the default one.
+ */
+#ifdef ARRAYLIST_FILTER
+void
+arraylist_set_filter(ArrayList list, BloomFilter filter) {
+	list->filter = filter;
+	if (filter != NULL) {
+		bloomfilter_clear(filter);
+		arraylist_filter_added(list, 0);
+	}
+}
+#endif /* ARRAYLIST_FILTER */
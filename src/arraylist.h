@@ -32,15 +32,37 @@
 #define ARRAYLIST_ERROR 0x01
 #define ARRAYLIST_INDEX_ERROR 0x02
 
+/* Keep an attached BloomFilter up to date, see arraylist_set_filter().
+ * Remove this to build arraylist.c on its own, without bloomfilter.c.
+ */
+#define ARRAYLIST_FILTER
+
+struct bloomfilter_t;
+
 typedef struct _list_t {
 	void **ptr_table;
 	uint32_t number_items;
 	uint32_t capacity;
 	uint8_t list_type;
 	int8_t(*compare_func)(void*, void*);
+	struct bloomfilter_t *filter;
 } ListType;
 typedef ListType *ArrayList;
 
+/* State for merging k sorted lists a batch at a time.  tree[0] is the list
+ * whose next item comes first; tree[1] to tree[k - 1] hold the loser of
+ * the match at each inner node of the tournament, whose leaves are the
+ * lists.  pos[i] is the next unmerged index in lists[i].
+ */
+struct arraylist_merge_t {
+	ArrayList *lists;
+	uint32_t k;
+	uint32_t *pos;
+	uint32_t *tree;
+	int8_t(*compare_func)(void*, void*);
+};
+typedef struct arraylist_merge_t *ArrayListMerge;
+
 ArrayList arraylist_create(int8_t(*compare_func)(void*, void*));
 ArrayList arraylist_create_heap(int8_t(*compare_func)(void*, void*));
 ArrayList arraylist_create_heap_size(const uint32_t items, 
@@ -61,5 +83,17 @@ uint32_t arraylist_count(ArrayList list);
 void arraylist_reverse(ListType *listPtr);
 void arraylist_quicksort(ArrayList list, uint32_t left, uint32_t right);
 void arraylist_sort(ArrayList list);
+uint8_t arraylist_merge_k(ArrayList *lists, const uint32_t k, ArrayList out);
+ArrayListMerge arraylist_merge_create(ArrayList *lists, const uint32_t k,
+                                      int8_t(*compare_func)(void*, void*));
+uint32_t arraylist_merge_next(ArrayListMerge merge, void **out, const uint32_t n);
+void arraylist_merge_free(ArrayListMerge merge);
+uint8_t arraylist_union(ArrayList a, ArrayList b, ArrayList out);
+uint8_t arraylist_intersection(ArrayList a, ArrayList b, ArrayList out);
+uint8_t arraylist_difference(ArrayList a, ArrayList b, ArrayList out);
+uint32_t arraylist_unique(ArrayList list);
+#ifdef ARRAYLIST_FILTER
+void arraylist_set_filter(ArrayList list, struct bloomfilter_t *filter);
+#endif /* ARRAYLIST_FILTER */
 
 #endif
@@ -0,0 +1,247 @@
+/*
+ * blockingdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A thread-safe blocking queue for handing items from producer threads to
+ * consumer threads, using the two-lock design from Michael and Scott's PODC
+ * 1996 paper plus a condition variable for consumers that want to sleep until
+ * an item arrives.
+ *
+ * Items go in on the right with blockingdeque_append() and come out on the
+ * left with blockingdeque_popleft(), _popleft_wait() or _drain(), matching the
+ * deque module's append/popleft pair.  As with the deque, NULL is returned to
+ * mean "nothing there", so NULL should not be stored.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include "blockingdeque.h"
+
+/* Initialize a blocking deque that has already been allocated */
+blockingdeque_result_t
+blockingdeque_init(BlockingDeque d) {
+	struct blockingdeque_node_t *dummy;
+	pthread_condattr_t attr;
+	assert(d != NULL);
+
+	if ((dummy = malloc(sizeof(struct blockingdeque_node_t))) == NULL) {
+		return BLOCKINGDEQUE_ALLOC_ERROR;
+	}
+	dummy->value = NULL;
+	atomic_init(&dummy->next, NULL);
+	d->head = dummy;
+	d->tail = dummy;
+	atomic_init(&d->waiters, 0);
+	atomic_init(&d->number_items, 0);
+	pthread_mutex_init(&d->head_lock, NULL);
+	pthread_mutex_init(&d->tail_lock, NULL);
+
+	/* timeouts are measured against the monotonic clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&d->not_empty, &attr);
+	pthread_condattr_destroy(&attr);
+	return BLOCKINGDEQUE_SUCCESS;
+}
+
+/* Create a blocking deque and return a reference, or NULL if memory could
+ * not be allocated.
+ */
+BlockingDeque
+blockingdeque_create(void) {
+	BlockingDeque d = malloc(sizeof(struct blockingdeque_t));
+	if (d != NULL && blockingdeque_init(d) != BLOCKINGDEQUE_SUCCESS) {
+		free(d);
+		d = NULL;
+	}
+	return d;
+}
+
+/* Release the nodes and locks of a deque initialized with
+ * blockingdeque_init().  The items themselves are not freed.
+ */
+void
+blockingdeque_destroy(BlockingDeque d) {
+	struct blockingdeque_node_t *node, *next;
+	for (node = d->head; node != NULL; node = next) {
+		next = atomic_load_explicit(&node->next, memory_order_relaxed);
+		free(node);
+	}
+	d->head = NULL;
+	d->tail = NULL;
+	pthread_cond_destroy(&d->not_empty);
+	pthread_mutex_destroy(&d->tail_lock);
+	pthread_mutex_destroy(&d->head_lock);
+}
+
+/* Free a deque allocated with blockingdeque_create() */
+void
+blockingdeque_free(BlockingDeque d) {
+	blockingdeque_destroy(d);
+	free(d);
+}
+
+/* Append an item to the right end of the deque, waking one waiting
+ * consumer if there is one.
+ *
+ * The node is allocated before the lock is taken, so the critical section
+ * is just two pointer writes.
+ */
+blockingdeque_result_t
+blockingdeque_append(BlockingDeque d, void* item) {
+	struct blockingdeque_node_t *node;
+
+	if ((node = malloc(sizeof(struct blockingdeque_node_t))) == NULL) {
+		return BLOCKINGDEQUE_ALLOC_ERROR;
+	}
+	node->value = item;
+	atomic_init(&node->next, NULL);
+
+	/* count the item before linking it, so a consumer that takes it
+	 * never decrements the count below zero
+	 */
+	pthread_mutex_lock(&d->tail_lock);
+	atomic_fetch_add(&d->number_items, 1);
+	atomic_store(&d->tail->next, node);
+	d->tail = node;
+	pthread_mutex_unlock(&d->tail_lock);
+
+	/* A consumer registers as a waiter before it re-checks for items, so
+	 * either it sees our node or we see it waiting.
+	 */
+	if (atomic_load(&d->waiters) > 0) {
+		pthread_mutex_lock(&d->head_lock);
+		pthread_cond_signal(&d->not_empty);
+		pthread_mutex_unlock(&d->head_lock);
+	}
+	return BLOCKINGDEQUE_SUCCESS;
+}
+
+/* Unlink the first item.  The head lock must be held and the deque must
+ * not be empty.  Returns the old dummy node, which the caller frees once
+ * the lock is released.
+ */
+static struct blockingdeque_node_t *
+blockingdeque_unlink(BlockingDeque d, void** value) {
+	struct blockingdeque_node_t *dummy = d->head;
+	struct blockingdeque_node_t *first = atomic_load(&dummy->next);
+	*value = first->value;
+	first->value = NULL;
+	d->head = first;
+	atomic_fetch_sub(&d->number_items, 1);
+	return dummy;
+}
+
+/* Compute the absolute CLOCK_MONOTONIC deadline timeout_ms from now */
+static void
+blockingdeque_deadline(struct timespec *ts, int32_t timeout_ms) {
+	clock_gettime(CLOCK_MONOTONIC, ts);
+	ts->tv_sec += timeout_ms / 1000;
+	ts->tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+	if (ts->tv_nsec >= 1000000000L) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+/* Remove the leftmost item, waiting up to timeout_ms milliseconds for one
+ * to arrive.  A timeout of 0 does not wait at all and
+ * BLOCKINGDEQUE_WAIT_FOREVER waits until an item arrives.
+ *
+ * Returns NULL if the timeout expires with the deque still empty.
+ */
+void*
+blockingdeque_popleft_wait(BlockingDeque d, int32_t timeout_ms) {
+	struct blockingdeque_node_t *dummy = NULL;
+	struct timespec deadline;
+	void* value = NULL;
+	int rc = 0;
+
+	pthread_mutex_lock(&d->head_lock);
+	if (atomic_load(&d->head->next) == NULL && timeout_ms != 0) {
+		if (timeout_ms > 0) {
+			blockingdeque_deadline(&deadline, timeout_ms);
+		}
+		atomic_fetch_add(&d->waiters, 1);
+		while (atomic_load(&d->head->next) == NULL && rc != ETIMEDOUT) {
+			if (timeout_ms > 0) {
+				rc = pthread_cond_timedwait(&d->not_empty, &d->head_lock, &deadline);
+			} else {
+				pthread_cond_wait(&d->not_empty, &d->head_lock);
+			}
+		}
+		atomic_fetch_sub(&d->waiters, 1);
+	}
+	if (atomic_load(&d->head->next) != NULL) {
+		dummy = blockingdeque_unlink(d, &value);
+	}
+	pthread_mutex_unlock(&d->head_lock);
+	free(dummy);
+	return value;
+}
+
+/* Remove the leftmost item without waiting, or return NULL if empty */
+void*
+blockingdeque_popleft(BlockingDeque d) {
+	return blockingdeque_popleft_wait(d, 0);
+}
+
+/* Remove up to max items from the left into out, under a single
+ * acquisition of the head lock, without waiting.  Returns the number of
+ * items removed.
+ *
+ * The removed nodes are chained together and freed after the lock is
+ * released.
+ */
+uint32_t
+blockingdeque_drain(BlockingDeque d, void** out, uint32_t max) {
+	struct blockingdeque_node_t *first, *node, *next;
+	uint32_t i, n = 0;
+
+	pthread_mutex_lock(&d->head_lock);
+	first = d->head;
+	while (n < max && (next = atomic_load(&d->head->next)) != NULL) {
+		out[n++] = next->value;
+		next->value = NULL;
+		d->head = next;
+	}
+	if (n > 0) {
+		atomic_fetch_sub(&d->number_items, n);
+	}
+	pthread_mutex_unlock(&d->head_lock);
+
+	/* free the old dummy and every node but the new dummy */
+	for (node = first, i = 0; i < n; i++, node = next) {
+		next = atomic_load_explicit(&node->next, memory_order_relaxed);
+		free(node);
+	}
+	return n;
+}
+
+/* Return the number of items in the deque.  When other threads are active
+ * this is only a snapshot.
+ */
+uint32_t
+blockingdeque_count(BlockingDeque d) {
+	return atomic_load(&d->number_items);
+}
@@ -0,0 +1,71 @@
+/*
+ * blockingdeque.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BLOCKINGDEQUE_H
+#define BLOCKINGDEQUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define BLOCKINGDEQUE_WAIT_FOREVER (-1)
+
+typedef enum {
+	BLOCKINGDEQUE_SUCCESS = 0,
+	BLOCKINGDEQUE_FAILURE = 1,
+	BLOCKINGDEQUE_ALLOC_ERROR = 2
+} blockingdeque_result_t;
+
+struct blockingdeque_node_t {
+	void* value;
+	_Atomic(struct blockingdeque_node_t*) next;
+};
+
+/* head always points at a dummy node, the first item is head->next.
+ * Producers only ever take tail_lock and consumers head_lock, so the two
+ * ends do not contend; a producer only touches head_lock to wake a
+ * consumer that is actually waiting.
+ */
+struct blockingdeque_t {
+	pthread_mutex_t head_lock;
+	pthread_cond_t not_empty;
+	struct blockingdeque_node_t *head;
+	atomic_uint waiters;
+	pthread_mutex_t tail_lock;
+	struct blockingdeque_node_t *tail;
+	atomic_uint number_items;
+};
+
+typedef struct blockingdeque_t *BlockingDeque;
+
+BlockingDeque           blockingdeque_create(void);
+blockingdeque_result_t  blockingdeque_init(BlockingDeque d);
+void                    blockingdeque_destroy(BlockingDeque d);
+void                    blockingdeque_free(BlockingDeque d);
+blockingdeque_result_t  blockingdeque_append(BlockingDeque d, void* item);
+void*                   blockingdeque_popleft(BlockingDeque d);
+void*                   blockingdeque_popleft_wait(BlockingDeque d, int32_t timeout_ms);
+uint32_t                blockingdeque_drain(BlockingDeque d, void** out, uint32_t max);
+uint32_t                blockingdeque_count(BlockingDeque d);
+#endif
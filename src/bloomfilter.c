@@ -0,0 +1,204 @@
+/*
+ * bloomfilter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A counting, blocked Bloom filter for answering "definitely not present" in
+ * O(1) before a linear search.
+ *
+ * Each item hashes to one 64 byte block and sets six of its 128 four bit
+ * counters; a lookup that finds any of them zero proves the item was never
+ * added, and touches only that one cache line.  Counters rather than bits let
+ * items be removed again.  A counter that reaches 15 stays there, which can
+ * only cost false positives, never false negatives.
+ *
+ * At the default eight items per block, about 16 counters per item, around
+ * one absent lookup in 400 gets through.  Adding more items than the filter
+ * was sized for raises the rate; bloomfilter_estimated_fp_rate() tells how far
+ * it has risen and a larger filter can be built in its place.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bloomfilter.h"
+
+#define BLOOMFILTER_PROBES (6)
+#define BLOOMFILTER_COUNTER_MAX (15)
+
+static uint32_t
+default_hash(const void * item) {
+	uint64_t h = (uint64_t) (uintptr_t) item * 0x9e3779b97f4a7c15ULL;
+	return (uint32_t) (h >> 32);
+}
+
+/* Create a filter sized for items items.  hash must give equal items equal
+ * hashes; if NULL, items are hashed by address.  NULL is returned if
+ * memory cannot be allocated.
+ */
+BloomFilter
+bloomfilter_create(uint32_t items, bloomfilter_hash_func_t hash) {
+	BloomFilter f = malloc(sizeof(struct bloomfilter_t));
+	uint32_t number_blocks = items / BLOOMFILTER_ITEMS_PER_BLOCK + 1;
+	if (f == NULL) {
+		return NULL;
+	}
+
+	/* over-allocate so the blocks can start on a cache line */
+	f->memory = malloc((size_t) number_blocks * BLOOMFILTER_BLOCK_BYTES
+	                   + BLOOMFILTER_BLOCK_BYTES - 1);
+	if (f->memory == NULL) {
+		free(f);
+		return NULL;
+	}
+	f->blocks = (uint8_t *) (((uintptr_t) f->memory + BLOOMFILTER_BLOCK_BYTES - 1)
+	                         & ~(uintptr_t) (BLOOMFILTER_BLOCK_BYTES - 1));
+	f->number_blocks = number_blocks;
+	f->hash_func = hash != NULL ? hash : default_hash;
+	f->lookups = f->rejected = f->false_positives = 0;
+	bloomfilter_clear(f);
+	return f;
+}
+
+/* Free the filter */
+void
+bloomfilter_free(BloomFilter f) {
+	free(f->memory);
+	free(f);
+}
+
+/* Return the block for item, and its probe positions in *probes: the top
+ * half of a mixed 64 bit hash picks the block, and the top 42 bits of a
+ * second multiply of the whole hash give seven bits for each counter
+ */
+static uint8_t *
+bloomfilter_locate(BloomFilter f, const void* item, uint64_t *probes) {
+	uint64_t h = (f->hash_func)(item) * 0x9e3779b97f4a7c15ULL;
+	h ^= h >> 29;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 32;
+	*probes = (h * 0x94d049bb133111ebULL) >> 22;
+	return f->blocks + ((h >> 32) * f->number_blocks >> 32) * BLOOMFILTER_BLOCK_BYTES;
+}
+
+/* Add item.  O(1). */
+void
+bloomfilter_add(BloomFilter f, const void* item) {
+	uint64_t probes;
+	uint8_t *block = bloomfilter_locate(f, item, &probes);
+	uint32_t i, pos, shift;
+	for (i = 0; i < BLOOMFILTER_PROBES; i++, probes >>= 7) {
+		pos = probes & 127;
+		shift = (pos & 1) * 4;
+		if (((block[pos >> 1] >> shift) & 15) < BLOOMFILTER_COUNTER_MAX) {
+			block[pos >> 1] += 1 << shift;
+		}
+	}
+	f->number_items++;
+}
+
+/* Remove item, which must have been added and not removed since.  O(1). */
+void
+bloomfilter_remove(BloomFilter f, const void* item) {
+	uint64_t probes;
+	uint8_t *block = bloomfilter_locate(f, item, &probes);
+	uint32_t i, pos, shift, count;
+	for (i = 0; i < BLOOMFILTER_PROBES; i++, probes >>= 7) {
+		pos = probes & 127;
+		shift = (pos & 1) * 4;
+		count = (block[pos >> 1] >> shift) & 15;
+		if (count > 0 && count < BLOOMFILTER_COUNTER_MAX) {
+			block[pos >> 1] -= 1 << shift;
+		}
+	}
+	f->number_items--;
+}
+
+/* Return false if item is certainly not in the filter, true if it may be.
+ * O(1), reading a single cache line.
+ */
+bool
+bloomfilter_contains(BloomFilter f, const void* item) {
+	uint64_t probes;
+	uint8_t *block = bloomfilter_locate(f, item, &probes);
+	uint32_t i, pos;
+	f->lookups++;
+	for (i = 0; i < BLOOMFILTER_PROBES; i++, probes >>= 7) {
+		pos = probes & 127;
+		if (((block[pos >> 1] >> ((pos & 1) * 4)) & 15) == 0) {
+			f->rejected++;
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Record that a lookup bloomfilter_contains() let through turned out not
+ * to be present, for bloomfilter_observed_fp_rate()
+ */
+void
+bloomfilter_note_false_positive(BloomFilter f) {
+	f->false_positives++;
+}
+
+/* Remove every item */
+void
+bloomfilter_clear(BloomFilter f) {
+	memset(f->blocks, 0, (size_t) f->number_blocks * BLOOMFILTER_BLOCK_BYTES);
+	f->number_items = 0;
+}
+
+/* Return the number of items in the filter */
+uint32_t
+bloomfilter_count(BloomFilter f) {
+	return f->number_items;
+}
+
+/* Return the chance that an item not in the filter is let through, given
+ * what is in it now.  An absent item lands in a block at random and gets
+ * through if all six of its counters there are set, so this averages the
+ * sixth power of each block's fraction of non-zero counters.  O(size of
+ * the filter).
+ */
+double
+bloomfilter_estimated_fp_rate(BloomFilter f) {
+	double sum = 0, fill;
+	uint32_t b, i, set;
+	uint8_t *block;
+	for (b = 0; b < f->number_blocks; b++) {
+		block = f->blocks + (size_t) b * BLOOMFILTER_BLOCK_BYTES;
+		for (i = set = 0; i < BLOOMFILTER_BLOCK_BYTES; i++) {
+			set += (block[i] & 15) != 0;
+			set += (block[i] >> 4) != 0;
+		}
+		fill = set / 128.0;
+		sum += fill * fill * fill * fill * fill * fill;
+	}
+	return sum / f->number_blocks;
+}
+
+/* Return the fraction of lookups of absent items that the filter let
+ * through, as reported with bloomfilter_note_false_positive(), or 0 before
+ * any such lookup
+ */
+double
+bloomfilter_observed_fp_rate(BloomFilter f) {
+	uint64_t absent = f->rejected + f->false_positives;
+	return absent == 0 ? 0 : (double) f->false_positives / absent;
+}
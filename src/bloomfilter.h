@@ -0,0 +1,63 @@
+/*
+ * bloomfilter.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BLOOMFILTER_BLOCK_BYTES (64)
+#define BLOOMFILTER_ITEMS_PER_BLOCK (8)
+
+/* The filter is an array of 64 byte blocks, each holding 128 four bit
+ * counters, so every lookup stays within one cache line.  lookups counts
+ * the calls to bloomfilter_contains(), rejected those answered false, and
+ * false_positives those the owner found were wrong.
+ */
+struct bloomfilter_t {
+	uint8_t *blocks;
+	void *memory;
+	uint32_t number_blocks;
+	uint32_t number_items;
+	uint64_t lookups;
+	uint64_t rejected;
+	uint64_t false_positives;
+	uint32_t(*hash_func)(const void *);
+};
+
+typedef struct bloomfilter_t *BloomFilter;
+typedef uint32_t(*bloomfilter_hash_func_t)(const void*);
+
+BloomFilter  bloomfilter_create(uint32_t items, bloomfilter_hash_func_t hash);
+void         bloomfilter_free(BloomFilter f);
+void         bloomfilter_add(BloomFilter f, const void* item);
+void         bloomfilter_remove(BloomFilter f, const void* item);
+bool         bloomfilter_contains(BloomFilter f, const void* item);
+void         bloomfilter_note_false_positive(BloomFilter f);
+void         bloomfilter_clear(BloomFilter f);
+uint32_t     bloomfilter_count(BloomFilter f);
+double       bloomfilter_estimated_fp_rate(BloomFilter f);
+double       bloomfilter_observed_fp_rate(BloomFilter f);
+#endif
@@ -0,0 +1,347 @@
+/*
+ * bytering.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A growable ring buffer of bytes for framing I/O, the byte oriented
+ * companion of the ring deque.
+ *
+ * bytering_read_fd() and bytering_write_fd() move data between a file
+ * descriptor and the ring with a single readv()/writev() over the (at most
+ * two) free or used regions, so data is never staged in a temporary buffer.
+ * bytering_find() and bytering_peek_spans() let a protocol parser look for
+ * delimiters and inspect frames in place before consuming them.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include "bytering.h"
+
+/* Map an offset from the first byte onto a buffer index */
+static uint32_t
+bytering_index(ByteRing r, uint32_t offset) {
+	uint32_t idx = r->first + offset;
+	return idx >= r->capacity ? idx - r->capacity : idx;
+}
+
+/* Copy n bytes starting at offset out of the ring, handling the wrap */
+static void
+bytering_copy_out(ByteRing r, uint32_t offset, uint8_t *out, uint32_t n) {
+	uint32_t start = bytering_index(r, offset);
+	uint32_t firstRun = r->capacity - start;
+	if (firstRun >= n) {
+		memcpy(out, r->buffer + start, n);
+	} else {
+		memcpy(out, r->buffer + start, firstRun);
+		memcpy(out + firstRun, r->buffer, n - firstRun);
+	}
+}
+
+/* Create a byte ring with room for capacity bytes, that doubles in size
+ * whenever more room is needed.  Returns NULL if memory cannot be allocated.
+ */
+ByteRing
+bytering_create(uint32_t capacity) {
+	ByteRing r = malloc(sizeof(struct bytering_t));
+	if (r == NULL) {
+		return NULL;
+	}
+	if (capacity == 0) {
+		capacity = BYTERING_DEFAULT_SIZE;
+	}
+	if ((r->buffer = malloc(capacity)) == NULL) {
+		free(r);
+		return NULL;
+	}
+	r->capacity = capacity;
+	r->first = 0;
+	r->number_bytes = 0;
+	r->ring_type = BYTERING_TYPE_EXPANDING;
+	return r;
+}
+
+/* Initialize a byte ring over a caller supplied buffer.  It never grows, and
+ * must not be passed to bytering_free().
+ */
+void
+bytering_init_static(ByteRing r, uint8_t *buffer, uint32_t capacity) {
+	assert(r != NULL && buffer != NULL);
+	r->buffer = buffer;
+	r->capacity = capacity;
+	r->first = 0;
+	r->number_bytes = 0;
+	r->ring_type = BYTERING_TYPE_FIXED;
+}
+
+/* Free a byte ring created with bytering_create() */
+void
+bytering_free(ByteRing r) {
+	free(r->buffer);
+	free(r);
+}
+
+/* Return the number of bytes in the ring */
+uint32_t
+bytering_count(ByteRing r) {
+	return r->number_bytes;
+}
+
+/* Return the number of bytes that can be added without growing */
+uint32_t
+bytering_space(ByteRing r) {
+	return r->capacity - r->number_bytes;
+}
+
+/* Make sure at least n more bytes fit, growing an expanding ring if needed.
+ * Returns BYTERING_FAILURE if a fixed ring does not have the room, and
+ * BYTERING_ALLOC_ERROR if the ring cannot grow, either because memory ran
+ * out or because it would pass BYTERING_MAX_SIZE bytes.
+ */
+bytering_result_t
+bytering_reserve(ByteRing r, uint32_t n) {
+	uint8_t *newBuffer;
+	uint32_t newCapacity = r->capacity;
+
+	if (bytering_space(r) >= n) {
+		return BYTERING_SUCCESS;
+	}
+	if (r->ring_type == BYTERING_TYPE_FIXED) {
+		return BYTERING_FAILURE;
+	}
+	if (n > BYTERING_MAX_SIZE - r->number_bytes) {
+		return BYTERING_ALLOC_ERROR;
+	}
+	while (newCapacity - r->number_bytes < n) {
+		newCapacity = newCapacity > BYTERING_MAX_SIZE / 2
+		              ? BYTERING_MAX_SIZE : newCapacity * 2;
+	}
+	if ((newBuffer = malloc(newCapacity)) == NULL) {
+		return BYTERING_ALLOC_ERROR;
+	}
+	bytering_copy_out(r, 0, newBuffer, r->number_bytes);
+	free(r->buffer);
+	r->buffer = newBuffer;
+	r->capacity = newCapacity;
+	r->first = 0;
+	return BYTERING_SUCCESS;
+}
+
+/* Append n bytes of data, growing if possible.  Returns the number of bytes
+ * written, which is less than n if the ring filled up: a fixed ring is out
+ * of room, or an expanding one could not grow (see bytering_reserve()).
+ */
+uint32_t
+bytering_write(ByteRing r, const void *data, uint32_t n) {
+	uint32_t start, firstRun;
+	if (bytering_reserve(r, n) != BYTERING_SUCCESS) {
+		n = bytering_space(r);
+	}
+	start = bytering_index(r, r->number_bytes);
+	firstRun = r->capacity - start;
+	if (firstRun >= n) {
+		memcpy(r->buffer + start, data, n);
+	} else {
+		memcpy(r->buffer + start, data, firstRun);
+		memcpy(r->buffer, (const uint8_t*) data + firstRun, n - firstRun);
+	}
+	r->number_bytes += n;
+	return n;
+}
+
+/* Copy up to n bytes from the front of the ring without consuming them.
+ * Returns the number of bytes copied.
+ */
+uint32_t
+bytering_peek(ByteRing r, void *out, uint32_t n) {
+	if (n > r->number_bytes) {
+		n = r->number_bytes;
+	}
+	bytering_copy_out(r, 0, out, n);
+	return n;
+}
+
+/* Copy up to n bytes from the front of the ring and consume them.  Returns
+ * the number of bytes read.
+ */
+uint32_t
+bytering_read(ByteRing r, void *out, uint32_t n) {
+	return bytering_consume(r, bytering_peek(r, out, n));
+}
+
+/* Drop up to n bytes from the front of the ring.  Returns the number of
+ * bytes dropped.  This operation is O(1).
+ */
+uint32_t
+bytering_consume(ByteRing r, uint32_t n) {
+	if (n > r->number_bytes) {
+		n = r->number_bytes;
+	}
+	r->number_bytes -= n;
+	/* an empty ring restarts at 0 so the next read gets one long region */
+	r->first = r->number_bytes == 0 ? 0 : bytering_index(r, n);
+	return n;
+}
+
+/* Drop everything in the ring */
+void
+bytering_clear(ByteRing r) {
+	r->first = 0;
+	r->number_bytes = 0;
+}
+
+/* Expose the contents in place as at most two regions, *a (*alen bytes)
+ * followed by *b (*blen bytes).  Returns the total number of bytes.  The
+ * regions stay valid until the ring is next modified.
+ */
+uint32_t
+bytering_peek_spans(ByteRing r, const uint8_t **a, uint32_t *alen,
+                    const uint8_t **b, uint32_t *blen) {
+	uint32_t firstRun = r->capacity - r->first;
+	*a = r->buffer + r->first;
+	if (firstRun >= r->number_bytes) {
+		*alen = r->number_bytes;
+		*b = NULL;
+		*blen = 0;
+	} else {
+		*alen = firstRun;
+		*b = r->buffer;
+		*blen = r->number_bytes - firstRun;
+	}
+	return r->number_bytes;
+}
+
+/* Return the offset of the first occurrence of the len byte delimiter, or
+ * BYTERING_NOT_FOUND.  Matches that straddle the end of the buffer are
+ * found too.
+ *
+ * Candidates are located with memchr() on the first delimiter byte, so the
+ * scan runs at memchr speed over each region.
+ */
+int64_t
+bytering_find(ByteRing r, const void *delim, uint32_t len) {
+	const uint8_t *d = delim;
+	const uint8_t *hit;
+	uint32_t offset = 0, start, runEnd, i;
+
+	if (len == 0) {
+		return 0;
+	}
+	while (offset + len <= r->number_bytes) {
+		/* scan the rest of the current contiguous region */
+		start = bytering_index(r, offset);
+		runEnd = start < r->first ? r->first : r->capacity;
+		if (runEnd - start > r->number_bytes - offset) {
+			runEnd = start + (r->number_bytes - offset);
+		}
+		hit = memchr(r->buffer + start, d[0], runEnd - start);
+		if (hit == NULL) {
+			offset += runEnd - start;
+			continue;
+		}
+		offset += (uint32_t) (hit - (r->buffer + start));
+		if (offset + len > r->number_bytes) {
+			break;
+		}
+		for (i = 1; i < len; i++) {
+			if (r->buffer[bytering_index(r, offset + i)] != d[i]) {
+				break;
+			}
+		}
+		if (i == len) {
+			return offset;
+		}
+		offset++;
+	}
+	return BYTERING_NOT_FOUND;
+}
+
+/* Read from fd straight into the free space of the ring with one readv().
+ * An expanding ring that is full is grown first, up to BYTERING_MAX_SIZE.
+ *
+ * Returns the number of bytes read, 0 at end of file, or -1 with errno set:
+ * ENOBUFS if the ring is full and cannot grow (it is fixed, or already
+ * BYTERING_MAX_SIZE), ENOMEM if growing it failed to allocate.
+ */
+ssize_t
+bytering_read_fd(ByteRing r, int fd) {
+	struct iovec iov[2];
+	uint32_t start, space, firstRun, grow;
+	int iovcnt = 1;
+	ssize_t result;
+
+	if (bytering_space(r) == 0) {
+		grow = BYTERING_MAX_SIZE - r->number_bytes;
+		grow = r->capacity < grow ? r->capacity : grow;
+		if (r->ring_type == BYTERING_TYPE_FIXED || grow == 0) {
+			errno = ENOBUFS;
+			return -1;
+		}
+		if (bytering_reserve(r, grow) != BYTERING_SUCCESS) {
+			errno = ENOMEM;
+			return -1;
+		}
+	}
+	space = bytering_space(r);
+	start = bytering_index(r, r->number_bytes);
+	firstRun = r->capacity - start;
+	iov[0].iov_base = r->buffer + start;
+	if (firstRun >= space) {
+		iov[0].iov_len = space;
+	} else {
+		iov[0].iov_len = firstRun;
+		iov[1].iov_base = r->buffer;
+		iov[1].iov_len = space - firstRun;
+		iovcnt = 2;
+	}
+	if ((result = readv(fd, iov, iovcnt)) > 0) {
+		r->number_bytes += (uint32_t) result;
+	}
+	return result;
+}
+
+/* Write the contents of the ring to fd with one writev() and consume
+ * whatever was written.
+ *
+ * Returns the number of bytes written or -1 with errno set.
+ */
+ssize_t
+bytering_write_fd(ByteRing r, int fd) {
+	struct iovec iov[2];
+	const uint8_t *a, *b;
+	uint32_t alen, blen;
+	int iovcnt;
+	ssize_t result;
+
+	if (bytering_peek_spans(r, &a, &alen, &b, &blen) == 0) {
+		return 0;
+	}
+	iov[0].iov_base = (void*) a;
+	iov[0].iov_len = alen;
+	iov[1].iov_base = (void*) b;
+	iov[1].iov_len = blen;
+	iovcnt = blen > 0 ? 2 : 1;
+	if ((result = writev(fd, iov, iovcnt)) > 0) {
+		bytering_consume(r, (uint32_t) result);
+	}
+	return result;
+}
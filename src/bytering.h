@@ -0,0 +1,72 @@
+/*
+ * bytering.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BYTERING_H
+#define BYTERING_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define BYTERING_TYPE_FIXED 0x00
+#define BYTERING_TYPE_EXPANDING 0x01
+#define BYTERING_DEFAULT_SIZE (4096)
+#define BYTERING_MAX_SIZE (0x80000000u)
+#define BYTERING_NOT_FOUND (-1)
+
+typedef enum {
+	BYTERING_SUCCESS = 0,
+	BYTERING_FAILURE = 1,
+	BYTERING_ALLOC_ERROR = 2
+} bytering_result_t;
+
+/* The data lives in buffer[first], buffer[first + 1], ... wrapping around
+ * at capacity.
+ */
+struct bytering_t {
+	uint8_t *buffer;
+	uint32_t capacity;
+	uint32_t first;
+	uint32_t number_bytes;
+	uint8_t ring_type;
+};
+
+typedef struct bytering_t *ByteRing;
+
+ByteRing           bytering_create(uint32_t capacity);
+void               bytering_init_static(ByteRing r, uint8_t *buffer, uint32_t capacity);
+void               bytering_free(ByteRing r);
+uint32_t           bytering_count(ByteRing r);
+uint32_t           bytering_space(ByteRing r);
+bytering_result_t  bytering_reserve(ByteRing r, uint32_t n);
+uint32_t           bytering_write(ByteRing r, const void *data, uint32_t n);
+uint32_t           bytering_peek(ByteRing r, void *out, uint32_t n);
+uint32_t           bytering_read(ByteRing r, void *out, uint32_t n);
+uint32_t           bytering_consume(ByteRing r, uint32_t n);
+void               bytering_clear(ByteRing r);
+uint32_t           bytering_peek_spans(ByteRing r, const uint8_t **a, uint32_t *alen,
+                                       const uint8_t **b, uint32_t *blen);
+int64_t            bytering_find(ByteRing r, const void *delim, uint32_t len);
+ssize_t            bytering_read_fd(ByteRing r, int fd);
+ssize_t            bytering_write_fd(ByteRing r, int fd);
+#endif
@@ -0,0 +1,205 @@
+/*
+ * counter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A Counter tallies how many times each key has been seen, after Python's
+ * collections.Counter.  It is a HashMap from keys to counts.
+ *
+ * counter_most_common() keeps the k largest counts seen so far in a min-heap
+ * while walking the map, so finding the top k of n keys is O(n log k) and
+ * needs no memory beyond the caller's k entries; the map is never sorted.
+ */
+#include <stdlib.h>
+#include "counter.h"
+
+/* Create an empty counter.  hash and comp work on keys; if either is NULL
+ * the keys are hashed and compared by address.  NULL is returned if memory
+ * cannot be allocated.
+ */
+Counter
+counter_create(hashmap_hash_func_t hash, hashmap_comparater_t comp) {
+	return counter_create_size(0, hash, comp);
+}
+
+/* Create an empty counter with room for items distinct keys before its
+ * map has to grow.
+ */
+Counter
+counter_create_size(uint32_t items, hashmap_hash_func_t hash,
+                    hashmap_comparater_t comp) {
+	Counter c = malloc(sizeof(struct counter_t));
+	if (c == NULL) {
+		return NULL;
+	}
+	if ((c->counts = hashmap_create_size(items, hash, comp)) == NULL) {
+		free(c);
+		return NULL;
+	}
+	c->total = 0;
+	return c;
+}
+
+/* Free the counter.  The keys are not freed. */
+void
+counter_free(Counter c) {
+	hashmap_free(c->counts);
+	free(c);
+}
+
+/* Add one to the count for key.  O(1) on average. */
+counter_result_t
+counter_increment(Counter c, void* key) {
+	return counter_add(c, key, 1);
+}
+
+/* Add n to the count for key, starting it at zero if key has not been
+ * seen.  COUNTER_FAILURE is returned, and nothing counted, if key cannot
+ * be added to the map.
+ */
+counter_result_t
+counter_add(Counter c, void* key, uintptr_t n) {
+	void **count = hashmap_setdefault(c->counts, key, (void*) 0);
+	if (count == NULL) {
+		return COUNTER_FAILURE;
+	}
+	*count = (void*) ((uintptr_t) *count + n);
+	c->total += n;
+	return COUNTER_SUCCESS;
+}
+
+/* Count each item of keys once, like counter_increment() on each in turn.
+ * On failure the keys before the one that failed have been counted.
+ */
+counter_result_t
+counter_update(Counter c, ArrayList keys) {
+	void **count;
+	uint32_t i;
+	for (i = 0; i < keys->number_items; i++) {
+		if ((count = hashmap_setdefault(c->counts, keys->ptr_table[i], (void*) 0)) == NULL) {
+			c->total += i;
+			return COUNTER_FAILURE;
+		}
+		*count = (void*) ((uintptr_t) *count + 1);
+	}
+	c->total += keys->number_items;
+	return COUNTER_SUCCESS;
+}
+
+/* Return the count for key, 0 if it has not been seen */
+uintptr_t
+counter_get(Counter c, const void* key) {
+	return (uintptr_t) hashmap_get(c->counts, key);
+}
+
+/* Forget key and return the count it had */
+uintptr_t
+counter_remove(Counter c, const void* key) {
+	uintptr_t count = (uintptr_t) hashmap_remove(c->counts, key);
+	c->total -= count;
+	return count;
+}
+
+/* Restore the min-heap order of the first n entries below pos */
+static void
+counter_sift_down(struct counter_entry_t *heap, uint32_t n, uint32_t pos) {
+	struct counter_entry_t entry = heap[pos];
+	uint32_t child;
+	while ((child = 2 * pos + 1) < n) {
+		if (child + 1 < n && heap[child + 1].count < heap[child].count) {
+			child++;
+		}
+		if (heap[child].count >= entry.count) {
+			break;
+		}
+		heap[pos] = heap[child];
+		pos = child;
+	}
+	heap[pos] = entry;
+}
+
+/* Store the k keys with the highest counts in out, highest first, and
+ * return how many were stored (fewer than k if fewer keys were counted).
+ * Keys with equal counts come in no particular order.  O(n log k) for n
+ * distinct keys.
+ */
+uint32_t
+counter_most_common(Counter c, uint32_t k, struct counter_entry_t *out) {
+	struct counter_entry_t entry, tmp;
+	uint32_t iter = 0, n = 0, i;
+	void *count;
+
+	if (k == 0) {
+		return 0;
+	}
+	while (hashmap_next(c->counts, &iter, &entry.key, &count)) {
+		entry.count = (uintptr_t) count;
+		if (n < k) {
+			/* fill out, then heapify it once it holds k entries */
+			out[n++] = entry;
+			if (n == k) {
+				for (i = k / 2; i-- > 0;) {
+					counter_sift_down(out, k, i);
+				}
+			}
+		} else if (entry.count > out[0].count) {
+			out[0] = entry;
+			counter_sift_down(out, k, 0);
+		}
+	}
+	if (n < k) {
+		for (i = n / 2; i-- > 0;) {
+			counter_sift_down(out, n, i);
+		}
+	}
+
+	/* moving each minimum to the end leaves out sorted highest first */
+	for (i = n; i > 1; i--) {
+		tmp = out[0];
+		out[0] = out[i - 1];
+		out[i - 1] = tmp;
+		counter_sift_down(out, i - 1, 0);
+	}
+	return n;
+}
+
+/* Return the number of distinct keys counted */
+uint32_t
+counter_count(Counter c) {
+	return hashmap_count(c->counts);
+}
+
+/* Return the sum of all the counts */
+uint64_t
+counter_total(Counter c) {
+	return c->total;
+}
+
+/* Iterate over the keys and their counts, as with hashmap_next() */
+bool
+counter_next(Counter c, uint32_t *iter, void** key, uintptr_t *count) {
+	void *value;
+	if (!hashmap_next(c->counts, iter, key, &value)) {
+		return false;
+	}
+	*count = (uintptr_t) value;
+	return true;
+}
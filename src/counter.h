@@ -0,0 +1,65 @@
+/*
+ * counter.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <stdint.h>
+#include "arraylist.h"
+#include "hashmap.h"
+
+typedef enum {
+	COUNTER_SUCCESS = 0,
+	COUNTER_FAILURE = 1
+} counter_result_t;
+
+struct counter_entry_t {
+	void* key;
+	uintptr_t count;
+};
+
+/* The counts are stored in place of the values of a hash map, so bumping
+ * the count of a key already seen is a single probe of the map.
+ */
+struct counter_t {
+	HashMap counts;
+	uint64_t total;
+};
+
+typedef struct counter_t *Counter;
+
+Counter           counter_create(hashmap_hash_func_t hash, hashmap_comparater_t comp);
+Counter           counter_create_size(uint32_t items, hashmap_hash_func_t hash,
+                                      hashmap_comparater_t comp);
+void              counter_free(Counter c);
+counter_result_t  counter_increment(Counter c, void* key);
+counter_result_t  counter_add(Counter c, void* key, uintptr_t n);
+counter_result_t  counter_update(Counter c, ArrayList keys);
+uintptr_t         counter_get(Counter c, const void* key);
+uintptr_t         counter_remove(Counter c, const void* key);
+uint32_t          counter_most_common(Counter c, uint32_t k, struct counter_entry_t *out);
+uint32_t          counter_count(Counter c);
+uint64_t          counter_total(Counter c);
+bool              counter_next(Counter c, uint32_t *iter, void** key, uintptr_t *count);
+#endif
@@ -31,6 +31,53 @@
 #include <malloc.h>
 #endif /* DEQUE_STATIC */
 
+#ifdef DEQUE_FILTER
+#include "bloomfilter.h"
+
+/* Add item, just linked in, to the deque's filter if it has one */
+static void
+deque_filter_add(Deque d, void* item) {
+	if (d->filter != NULL) {
+		bloomfilter_add(d->filter, item);
+	}
+}
+
+/* Take item, just unlinked, out of the deque's filter if it has one */
+static void
+deque_filter_remove(Deque d, void* item) {
+	if (d->filter != NULL) {
+		bloomfilter_remove(d->filter, item);
+	}
+}
+
+static void
+deque_filter_clear(Deque d) {
+	if (d->filter != NULL) {
+		bloomfilter_clear(d->filter);
+	}
+}
+
+/* Return true if the deque's filter says item is certainly not there */
+static bool
+deque_filter_rejects(Deque d, void* item) {
+	return d->filter != NULL && !bloomfilter_contains(d->filter, item);
+}
+
+/* Record that the filter let through an item that was not there */
+static void
+deque_filter_missed(Deque d) {
+	if (d->filter != NULL) {
+		bloomfilter_note_false_positive(d->filter);
+	}
+}
+#else
+#define deque_filter_add(d, item) ((void) 0)
+#define deque_filter_remove(d, item) ((void) 0)
+#define deque_filter_clear(d) ((void) 0)
+#define deque_filter_rejects(d, item) (false)
+#define deque_filter_missed(d) ((void) 0)
+#endif /* DEQUE_FILTER */
+
 /* The default comparator which simplies does a simple comparison based on
  * memory address.  It is really only useful to compare if two pointers point
  * to the same piece of data, beyond that less than or equal are not very
@@ -65,34 +112,130 @@ deque_init(Deque d, deque_comparater_t compare_func) {
 	d->head = NULL;
 	d->tail = NULL;
 	d->number_items = 0;
+	d->maxlen = DEQUE_UNBOUNDED;
+	d->evict_func = NULL;
+	d->evict_arg = NULL;
+	d->free_nodes = NULL;
+	d->node_block = NULL;
+	d->node_block_size = 0;
+	d->filter = NULL;
+#ifdef DEQUE_STATIC
+	memset(d->nodes, 0, sizeof(d->nodes));
+#endif
+}
+
+/* Initialize a deque that holds at most maxlen items, like python's
+ * deque(maxlen=N).  Once the deque is full, appending to one end evicts the
+ * item at the other end in O(1).  A maxlen of DEQUE_UNBOUNDED (0) gives an
+ * ordinary unbounded deque.
+ *
+ * When a full deque evicts an item, the evicted node is reused for the new
+ * item, so a full window does not allocate or free anything.
+ */
+void
+deque_init_bounded(Deque d, uint32_t maxlen, deque_comparater_t compare_func) {
+	deque_init(d, compare_func);
+	d->maxlen = maxlen;
+}
+
+/* Hand a block of nodes to the deque.  Nodes from the block are used before
+ * any others and go back on the free list when released, the block itself
+ * is owned by whoever allocated it.
+ */
+static void
+deque_set_node_block(Deque d, struct deque_node_t *nodes, uint32_t count) {
+	uint32_t i;
+	d->node_block = nodes;
+	d->node_block_size = count;
+	for (i = count; i > 0; i--) {
+		nodes[i - 1].next = d->free_nodes;
+		d->free_nodes = &nodes[i - 1];
+	}
+}
+
+/* Initialize a bounded deque whose nodes all come from the caller supplied
+ * array nodes, which must hold maxlen nodes and outlive the deque.  The
+ * deque never allocates or frees memory for nodes.
+ *
+ * This is useful for sliding windows kept in static storage, or when the
+ * deque is part of a larger structure that is allocated up front.
+ */
+void
+deque_init_preallocated(Deque d, uint32_t maxlen, deque_comparater_t compare_func,
+                        struct deque_node_t *nodes) {
+	assert(maxlen != DEQUE_UNBOUNDED && nodes != NULL);
+	deque_init_bounded(d, maxlen, compare_func);
+	deque_set_node_block(d, nodes, maxlen);
+}
+
+/* Set a function to be called as func(item, arg) for every item evicted from
+ * a bounded deque.  This is the place to free the evicted item or to fold it
+ * out of a running aggregate.  Passing NULL removes the callback.
+ */
+void
+deque_set_evict_func(Deque d, deque_evict_func_t func, void* arg) {
+	d->evict_func = func;
+	d->evict_arg = arg;
+}
+
+/* Keep filter up to date with the deque's items, so that deque_contains()
+ * and deque_remove() can turn away most items that are not in the deque
+ * without walking it.
+ *
+ * The filter is cleared and the current items added; from then on every
+ * deque operation adds and removes items in it as well.  Its hash must
+ * agree with the deque's compare_func: items that compare equal must hash
+ * the same.  The filter is not freed with the deque, and passing NULL
+ * detaches it.
+ */
+#ifdef DEQUE_FILTER
+void
+deque_set_filter(Deque d, BloomFilter filter) {
+	DequeNode node;
+	d->filter = filter;
+	if (filter != NULL) {
+		bloomfilter_clear(filter);
+		for (node = d->tail; node != NULL; node = node->next) {
+			bloomfilter_add(filter, node->value);
+		}
+	}
+}
+#endif /* DEQUE_FILTER */
+
+/* Return the maximum number of items, or DEQUE_UNBOUNDED */
+uint32_t
+deque_maxlen(Deque d) {
+	return d->maxlen;
 }
 
 
 #ifdef DEQUE_STATIC
 static struct deque_node_t *
-deque_alloc_node(Deque d) {
-	struct deque_node_t * node;
+deque_alloc_storage(Deque d) {
 	int i;
-	/* find the first unused node */		
-	while ((node = &d->nodes[i++])->in_use);
-	if (node != NULL)
-		node->in_use = true;
-	return node;
+	/* find the first unused node */
+	for (i = 0; i < DEQUE_MAX_NODES; i++) {
+		if (!d->nodes[i].in_use) {
+			d->nodes[i].in_use = true;
+			return &d->nodes[i];
+		}
+	}
+	return NULL; /* all nodes are in use */
 }
 
 static void
-deque_free_node(struct deque_node_t * node) {
+deque_free_storage(struct deque_node_t * node) {
 	node->in_use = false;
 }
 #else
 #include <malloc.h>
 static struct deque_node_t *
-deque_alloc_node(Deque d) {
+deque_alloc_storage(Deque d) {
 	return (struct deque_node_t *)malloc(sizeof(struct deque_node_t));
 }
 
 static void
-deque_free_node(struct deque_node_t * node)
+deque_free_storage(struct deque_node_t * node)
 {
 	free(node);
 }
@@ -120,43 +263,169 @@ deque_create(deque_comparater_t compare_func) {
 	return d;
 }
 
+/* Create a deque holding at most maxlen items, see deque_init_bounded().
+ * Not available with DEQUE_STATIC; use deque_init_bounded() there.
+ */
+Deque
+deque_create_bounded(uint32_t maxlen, deque_comparater_t compare_func) {
+	Deque d = deque_create(compare_func);
+	if (d != NULL) {
+		d->maxlen = maxlen;
+	}
+	return d;
+}
+
 
 /* Copy the deque and return a reference to the new deque
  *
  * This is a shallow copy, so only the deque container data structures are
  * copied, not the values referenced.
+ *
+ * The new deque and the nodes for all of the copied items are allocated
+ * with a single malloc(), and the nodes are linked directly rather than
+ * appended one at a time.  Nodes released by the copy go back on its free
+ * list, and deque_free() releases everything at once.  NULL is returned if
+ * memory cannot be allocated.
+ *
+ * Not available with DEQUE_STATIC, where a deque's nodes live inside it and
+ * there is no heap to copy into.
  */
 Deque
 deque_copy(Deque d) {
     Deque newDeque;
     DequeNode tmp;
-    newDeque = deque_create(d->compare_func);
-    tmp = d->head;
-    while (tmp != NULL) {
-        deque_append(newDeque, tmp->value);
-        tmp = tmp->next;
+    struct deque_node_t *nodes;
+    uint32_t i = 0;
+
+    newDeque = malloc(sizeof(struct deque_t)
+                      + d->number_items * sizeof(struct deque_node_t));
+    if (newDeque == NULL) {
+        return NULL;
+    }
+    deque_init_bounded(newDeque, d->maxlen, d->compare_func);
+    deque_set_evict_func(newDeque, d->evict_func, d->evict_arg);
+    if (d->number_items == 0) {
+        return newDeque;
+    }
+
+    /* the nodes live right after the deque in the same allocation */
+    nodes = (struct deque_node_t *) (newDeque + 1);
+    newDeque->node_block = nodes;
+    newDeque->node_block_size = d->number_items;
+    for (tmp = d->tail; tmp != NULL; tmp = tmp->next, i++) {
+        nodes[i].value = tmp->value;
+        nodes[i].prev = i > 0 ? &nodes[i - 1] : NULL;
+        nodes[i].next = i + 1 < d->number_items ? &nodes[i + 1] : NULL;
     }
+    newDeque->tail = &nodes[0];
+    newDeque->head = &nodes[d->number_items - 1];
+    newDeque->number_items = d->number_items;
     return newDeque;
 }
 #endif /* DEQUE_STATIC */
 
+/* Get a node for a new item, from the deque's node block if it has a free
+ * one and from the regular node storage otherwise.
+ *
+ * A preallocated deque never gets to the regular storage: it holds at most
+ * maxlen items and its block has maxlen nodes.
+ */
+static struct deque_node_t *
+deque_alloc_node(Deque d) {
+	struct deque_node_t *node;
+	if ((node = d->free_nodes) != NULL) {
+		d->free_nodes = node->next;
+		return node;
+	}
+	return deque_alloc_storage(d);
+}
+
+static bool
+deque_in_node_block(Deque d, struct deque_node_t *node) {
+	uintptr_t start = (uintptr_t) d->node_block;
+	uintptr_t end = (uintptr_t) (d->node_block + d->node_block_size);
+	return (uintptr_t) node >= start && (uintptr_t) node < end;
+}
+
+static void
+deque_free_node(Deque d, struct deque_node_t *node) {
+	if (deque_in_node_block(d, node)) {
+		node->next = d->free_nodes;
+		d->free_nodes = node;
+	} else {
+		deque_free_storage(node);
+	}
+}
+
+/* Unlink a node from the deque, keeping head and tail up to date, without
+ * freeing it.
+ */
+static void
+deque_unlink_node(Deque d, DequeNode node) {
+	if (node->prev != NULL) {
+		node->prev->next = node->next;
+	} else {
+		d->tail = node->next;
+	}
+	if (node->next != NULL) {
+		node->next->prev = node->prev;
+	} else {
+		d->head = node->prev;
+	}
+	d->number_items--;
+	deque_filter_remove(d, node->value);
+}
+
+/* Get a node for an item about to be added at one end.  If the deque is
+ * bounded and full, the node at the other end (evict_end) is unlinked,
+ * its item handed to the eviction callback and the node reused.
+ */
+static struct deque_node_t *
+deque_make_room(Deque d, DequeNode evict_end) {
+	void* evicted;
+	if (d->maxlen == DEQUE_UNBOUNDED || d->number_items < d->maxlen) {
+		return deque_alloc_node(d);
+	}
+	evicted = evict_end->value;
+	deque_unlink_node(d, evict_end);
+	if (d->evict_func != NULL) {
+		(d->evict_func)(evicted, d->evict_arg);
+	}
+	return evict_end;
+}
+
 /* Free the data allocated for the deque and all nodes */
 void
 deque_free(Deque d) {
+	d->filter = NULL; /* the filter may already have been freed */
 	deque_clear(d);
 	free(d);
 }
 
 /* Append the specified item to the right end of the deque (head).
+ *
+ * If the deque is bounded and full, the leftmost item is evicted.
  */
 deque_result_t
 deque_append(Deque d, void* item) {
-	deque_result_t retcode;	
+	return deque_append_node(d, item, NULL);
+}
+
+/* Append the specified item to the right end of the deque and, if node is
+ * not NULL, store a handle to the node holding it in *node.
+ *
+ * The handle stays valid until the item leaves the deque (popped, removed,
+ * evicted or cleared) and can be passed to deque_remove_node(),
+ * deque_move_to_front() and deque_move_to_back(), which are all O(1).
+ */
+deque_result_t
+deque_append_node(Deque d, void* item, DequeNode *node) {
+	deque_result_t retcode = DEQUE_SUCCESS;
 	DequeNode newNode;
 	assert(d != NULL);
 
 	/* allocate memory for the new node and put it in a valid state */
-	newNode = deque_alloc_node(d);
+	newNode = deque_make_room(d, d->tail);
 	if (newNode == NULL) {
 		retcode = DEQUE_ALLOC_ERROR;
 	} else {
@@ -166,26 +435,39 @@ deque_append(Deque d, void* item) {
 	
 		if (d->head != NULL) {
 			d->head->next = newNode;
-		}
-		if (d->tail == NULL) {
+		} else {
 			d->tail = newNode; /* only one item */
 		}
 		d->head = newNode;
 		d->number_items++;
+		deque_filter_add(d, item);
+		if (node != NULL) {
+			*node = newNode;
+		}
 	}
 	return retcode;
 }
 
-/* Append the specified item to the left end of the deque (tail). 
+/* Append the specified item to the left end of the deque (tail).
+ *
+ * If the deque is bounded and full, the rightmost item is evicted.
  */
 deque_result_t
 deque_appendleft(Deque d, void* item) {
+	return deque_appendleft_node(d, item, NULL);
+}
+
+/* Append the specified item to the left end of the deque, returning a
+ * handle to its node in *node as deque_append_node() does.
+ */
+deque_result_t
+deque_appendleft_node(Deque d, void* item, DequeNode *node) {
 	DequeNode newNode;
 	deque_result_t retcode = DEQUE_SUCCESS;
 	assert(d != NULL);
 
 	/* create the new node and put it in a valid state */
-	newNode = deque_alloc_node(d);
+	newNode = deque_make_room(d, d->head);
 	if (newNode == NULL) {
 		retcode = DEQUE_ALLOC_ERROR;
 	} else {
@@ -195,12 +477,15 @@ deque_appendleft(Deque d, void* item) {
 	
 		if (d->tail != NULL) {
 			d->tail->prev = newNode;
-		}
-		if (d->head == NULL) {
-			d->head = d->tail;
+		} else {
+			d->head = newNode; /* only one item */
 		}
 		d->tail = newNode;
 		d->number_items++;
+		deque_filter_add(d, item);
+		if (node != NULL) {
+			*node = newNode;
+		}
 	}
 	return retcode;
 }
@@ -214,14 +499,15 @@ deque_result_t
 deque_clear(Deque d) {
 	DequeNode tmp;
 	assert(d != NULL);
-	while (d->head != NULL) {
-		tmp = d->head;
-		d->head = tmp->next;
-		deque_free_node(tmp);
+	while (d->tail != NULL) {
+		tmp = d->tail;
+		d->tail = tmp->next;
+		deque_free_node(d, tmp);
 	}
 	d->head = NULL;
 	d->tail = NULL;
 	d->number_items = 0;
+	deque_filter_clear(d);
 	return DEQUE_SUCCESS;
 }
 
@@ -238,10 +524,9 @@ deque_pop(Deque d) {
 	if ((prevHead = d->head) == NULL) {
 		return NULL;
 	} else {
-		d->head = prevHead->prev;
-		d->number_items--;
+		deque_unlink_node(d, prevHead);
 		value = prevHead->value;
-		deque_free_node(prevHead);
+		deque_free_node(d, prevHead);
 		return value;
 	}
 }
@@ -270,13 +555,9 @@ deque_popleft(Deque d) {
 		return NULL;
 	} else {
 		prevTail = d->tail;
-		d->tail = prevTail->next;
-		if (d->tail != NULL) {
-			d->tail->prev = NULL;
-		}
-		d->number_items--;
+		deque_unlink_node(d, prevTail);
 		value = prevTail->value;
-		deque_free_node(prevTail);
+		deque_free_node(d, prevTail);
 		return value;
 	}
 }
@@ -306,21 +587,19 @@ void*
 deque_remove(Deque d, void* item) {
 	void* value;
 	DequeNode tmp = d->tail;
+	if (deque_filter_rejects(d, item)) {
+		return NULL;
+	}
 	while (tmp != NULL) {
 		if ((d->compare_func)(tmp->value, item) == 0) {
 			value = tmp->value;
-			if (tmp->prev != NULL) {
-				tmp->prev->next = tmp->next;
-			}
-			if (tmp->next != NULL) {
-				tmp->next->prev = tmp->prev;
-			}
-			deque_free_node(tmp);
-			d->number_items--;
+			deque_unlink_node(d, tmp);
+			deque_free_node(d, tmp);
 			return value;
 		}
 		tmp = tmp->next;
 	}
+	deque_filter_missed(d);
 	return NULL; /* item not found in deque */
 }
 
@@ -423,16 +702,475 @@ deque_reverse(Deque d) {
 	d->head = currNode;
 }
 
-/* Return TRUE if the deque contains the specified item and FALSE if not */
+/* Return TRUE if the deque contains the specified item and FALSE if not.
+ * With a filter set (see deque_set_filter()) most items that are not in
+ * the deque are turned away without a search.
+ */
 uint8_t
 deque_contains(Deque d, void* item) {
 	DequeNode tmp = d->tail;
+	if (deque_filter_rejects(d, item)) {
+		return FALSE;
+	}
 	while (tmp != NULL) {
 		if ((d->compare_func)(tmp->value, item) == 0) {
 			return TRUE;
 		}
 		tmp = tmp->next;
 	}
+	deque_filter_missed(d);
 	return FALSE; /* item not found in deque */
 }
 
+
+/* Append n items from an array to the right end of the deque, in order.
+ * An ArrayList can be passed as (list->ptr_table, list->number_items).
+ *
+ * For an unbounded deque the new nodes are chained up first and then linked
+ * in at once, so if memory runs out the deque is left unchanged and
+ * DEQUE_ALLOC_ERROR is returned.  A bounded deque appends item by item,
+ * evicting as it goes, which reuses nodes rather than allocating them once
+ * the deque is full.
+ */
+deque_result_t
+deque_extend(Deque d, void** items, uint32_t n) {
+	DequeNode first = NULL;
+	DequeNode last = NULL;
+	DequeNode node;
+	deque_result_t result;
+	uint32_t i;
+
+	if (d->maxlen != DEQUE_UNBOUNDED) {
+		for (i = 0; i < n; i++) {
+			if ((result = deque_append(d, items[i])) != DEQUE_SUCCESS) {
+				return result;
+			}
+		}
+		return DEQUE_SUCCESS;
+	}
+
+	for (i = 0; i < n; i++) {
+		if ((node = deque_alloc_node(d)) == NULL) {
+			while (first != NULL) {
+				node = first->next;
+				deque_free_node(d, first);
+				first = node;
+			}
+			return DEQUE_ALLOC_ERROR;
+		}
+		node->value = items[i];
+		node->prev = last;
+		node->next = NULL;
+		if (last != NULL) {
+			last->next = node;
+		} else {
+			first = node;
+		}
+		last = node;
+	}
+	if (first == NULL) {
+		return DEQUE_SUCCESS;
+	}
+
+	/* link the chain in at the right end */
+	first->prev = d->head;
+	if (d->head != NULL) {
+		d->head->next = first;
+	} else {
+		d->tail = first;
+	}
+	d->head = last;
+	d->number_items += n;
+	for (i = 0; i < n; i++) {
+		deque_filter_add(d, items[i]);
+	}
+	return DEQUE_SUCCESS;
+}
+
+/* Append n items from an array to the left end of the deque.  As with
+ * python's deque.extendleft() the items end up in reverse order, items[n-1]
+ * becoming the leftmost.
+ */
+deque_result_t
+deque_extendleft(Deque d, void** items, uint32_t n) {
+	deque_result_t result;
+	uint32_t i;
+	for (i = 0; i < n; i++) {
+		if ((result = deque_appendleft(d, items[i])) != DEQUE_SUCCESS) {
+			return result;
+		}
+	}
+	return DEQUE_SUCCESS;
+}
+
+/* Pop up to n items from the right end into out, rightmost first.  Returns
+ * the number of items popped.
+ */
+uint32_t
+deque_pop_n(Deque d, void** out, uint32_t n) {
+	DequeNode node;
+	uint32_t i;
+	for (i = 0; i < n && (node = d->head) != NULL; i++) {
+		out[i] = node->value;
+		deque_unlink_node(d, node);
+		deque_free_node(d, node);
+	}
+	return i;
+}
+
+/* Pop up to n items from the left end into out, leftmost first.  Returns
+ * the number of items popped.
+ */
+uint32_t
+deque_popleft_n(Deque d, void** out, uint32_t n) {
+	DequeNode node;
+	uint32_t i;
+	for (i = 0; i < n && (node = d->tail) != NULL; i++) {
+		out[i] = node->value;
+		deque_unlink_node(d, node);
+		deque_free_node(d, node);
+	}
+	return i;
+}
+
+/* Move all of the items of other onto the right end of d, leaving other
+ * empty.  If d cannot get the nodes for them DEQUE_ALLOC_ERROR is returned
+ * and neither deque is changed.
+ *
+ * When both deques use ordinary heap nodes and d is unbounded this is O(1):
+ * the two lists are simply linked together, though if d has a filter each
+ * item is still added to it, which is O(m).  Otherwise the nodes belong to
+ * other's storage and the items are moved one at a time, in O(m) for m
+ * items in other, with d evicting as needed if it is bounded.  With
+ * DEQUE_STATIC defined every node belongs to a deque's own pool, so the
+ * O(1) path is compiled out and items are always moved one at a time.
+ */
+deque_result_t
+deque_splice(Deque d, Deque other) {
+	DequeNode node, reserved = NULL;
+	uint32_t needed, i;
+	assert(d != other);
+
+	if (other->tail == NULL) {
+		return DEQUE_SUCCESS;
+	}
+#ifndef DEQUE_STATIC
+	if (other->node_block == NULL && d->maxlen == DEQUE_UNBOUNDED) {
+		for (node = other->tail; d->filter != NULL && node != NULL; node = node->next) {
+			deque_filter_add(d, node->value);
+		}
+		deque_filter_clear(other);
+		other->tail->prev = d->head;
+		if (d->head != NULL) {
+			d->head->next = other->tail;
+		} else {
+			d->tail = other->tail;
+		}
+		d->head = other->head;
+		d->number_items += other->number_items;
+		other->head = NULL;
+		other->tail = NULL;
+		other->number_items = 0;
+		return DEQUE_SUCCESS;
+	}
+#endif /* DEQUE_STATIC */
+
+	/* take every node the moves need up front, so that running out leaves
+	 * both deques as they were; a full bounded deque reuses evicted nodes
+	 */
+	needed = other->number_items;
+	if (d->maxlen != DEQUE_UNBOUNDED) {
+		i = d->number_items < d->maxlen ? d->maxlen - d->number_items : 0;
+		needed = needed < i ? needed : i;
+	}
+	for (i = 0; i < needed; i++) {
+		if ((node = deque_alloc_node(d)) == NULL) {
+			while ((node = reserved) != NULL) {
+				reserved = node->next;
+				deque_free_node(d, node);
+			}
+			return DEQUE_ALLOC_ERROR;
+		}
+		node->next = reserved;
+		reserved = node;
+	}
+	/* deque_append() takes nodes from the free list first */
+	while ((node = reserved) != NULL) {
+		reserved = node->next;
+		node->next = d->free_nodes;
+		d->free_nodes = node;
+	}
+	while (other->tail != NULL) {
+		deque_append(d, other->tail->value);
+		deque_popleft(other);
+	}
+	return DEQUE_SUCCESS;
+}
+
+/* Turn a python style index (negative counts from the right) into a position
+ * from the left.  Returns FALSE if the result is not below limit.
+ */
+static bool
+deque_normalize_index(Deque d, int32_t index, uint32_t limit, uint32_t *pos) {
+	int64_t i = index < 0 ? (int64_t) d->number_items + index : index;
+	if (i < 0 || i >= limit) {
+		return FALSE;
+	}
+	*pos = (uint32_t) i;
+	return TRUE;
+}
+
+/* Find the node at position pos from the left, walking in from whichever
+ * end is nearer.  This is O(min(pos, n - pos)).
+ */
+static DequeNode
+deque_node_at(Deque d, uint32_t pos) {
+	DequeNode node;
+	uint32_t i;
+	if (pos < d->number_items / 2) {
+		node = d->tail;
+		for (i = 0; i < pos; i++) {
+			node = node->next;
+		}
+	} else {
+		node = d->head;
+		for (i = d->number_items - 1; i > pos; i--) {
+			node = node->prev;
+		}
+	}
+	return node;
+}
+
+/* Get the item at index, counting from 0 at the left end.  Negative indices
+ * count from the right, -1 being the rightmost item.  NULL is returned if
+ * the index is out of range.
+ *
+ * The list is walked from the nearer end, so this is O(n/2) at worst and
+ * O(1) near either end.  Use a RingDeque for O(1) access anywhere.
+ */
+void*
+deque_getitem(Deque d, int32_t index) {
+	uint32_t pos;
+	if (!deque_normalize_index(d, index, d->number_items, &pos)) {
+		return NULL;
+	}
+	return deque_node_at(d, pos)->value;
+}
+
+/* Replace the item at index (see deque_getitem()).  Returns
+ * DEQUE_INDEX_ERROR if the index is out of range.
+ */
+deque_result_t
+deque_setitem(Deque d, int32_t index, void* item) {
+	DequeNode node;
+	uint32_t pos;
+	if (!deque_normalize_index(d, index, d->number_items, &pos)) {
+		return DEQUE_INDEX_ERROR;
+	}
+	node = deque_node_at(d, pos);
+	deque_filter_remove(d, node->value);
+	deque_filter_add(d, item);
+	node->value = item;
+	return DEQUE_SUCCESS;
+}
+
+/* Insert item so that it ends up at index, shifting the items from index on
+ * one place to the right.  An index equal to the number of items appends.
+ * Negative indices count from the right as in deque_getitem().
+ *
+ * Returns DEQUE_INDEX_ERROR if the index is out of range and, as python
+ * does, DEQUE_FAILURE if the deque is bounded and already full.  The
+ * position is found from the nearer end in O(min(index, n - index)).
+ */
+deque_result_t
+deque_insert(Deque d, int32_t index, void* item) {
+	DequeNode node, newNode;
+	uint32_t pos;
+
+	if (!deque_normalize_index(d, index, d->number_items + 1, &pos)) {
+		return DEQUE_INDEX_ERROR;
+	}
+	if (d->maxlen != DEQUE_UNBOUNDED && d->number_items >= d->maxlen) {
+		return DEQUE_FAILURE;
+	}
+	if (pos == d->number_items) {
+		return deque_append(d, item);
+	}
+	if ((newNode = deque_alloc_node(d)) == NULL) {
+		return DEQUE_ALLOC_ERROR;
+	}
+
+	/* link the new node in just left of the node now at pos */
+	node = deque_node_at(d, pos);
+	newNode->value = item;
+	newNode->next = node;
+	newNode->prev = node->prev;
+	if (node->prev != NULL) {
+		node->prev->next = newNode;
+	} else {
+		d->tail = newNode;
+	}
+	node->prev = newNode;
+	d->number_items++;
+	deque_filter_add(d, item);
+	return DEQUE_SUCCESS;
+}
+
+/* Remove the item at index (see deque_getitem()) and return it, or NULL if
+ * the index is out of range.  O(min(index, n - index)).
+ */
+void*
+deque_del(Deque d, int32_t index) {
+	DequeNode node;
+	void* value;
+	uint32_t pos;
+	if (!deque_normalize_index(d, index, d->number_items, &pos)) {
+		return NULL;
+	}
+	node = deque_node_at(d, pos);
+	value = node->value;
+	deque_unlink_node(d, node);
+	deque_free_node(d, node);
+	return value;
+}
+
+/* Remove the item held by node, a handle from deque_append_node() or
+ * deque_appendleft_node(), and return it.  The handle is invalid afterwards.
+ *
+ * Unlike deque_remove() there is no search, so this is O(1).
+ */
+void*
+deque_remove_node(Deque d, DequeNode node) {
+	void* value = node->value;
+	deque_unlink_node(d, node);
+	deque_free_node(d, node);
+	return value;
+}
+
+/* Move the item held by node to the left end of the deque (tail), where
+ * deque_popleft() will find it next.  The handle stays valid.  O(1).
+ */
+void
+deque_move_to_front(Deque d, DequeNode node) {
+	if (node == d->tail) {
+		return;
+	}
+	deque_unlink_node(d, node);
+	node->prev = NULL;
+	node->next = d->tail;
+	if (d->tail != NULL) {
+		d->tail->prev = node;
+	} else {
+		d->head = node;
+	}
+	d->tail = node;
+	d->number_items++;
+	deque_filter_add(d, node->value);
+}
+
+/* Move the item held by node to the right end of the deque (head), as if it
+ * had just been appended.  The handle stays valid.  O(1).
+ *
+ * Keeping items in order of use this way, with the least recently used one
+ * at the left end, is the bookkeeping half of an LRU cache.
+ */
+void
+deque_move_to_back(Deque d, DequeNode node) {
+	if (node == d->head) {
+		return;
+	}
+	deque_unlink_node(d, node);
+	node->next = NULL;
+	node->prev = d->head;
+	if (d->head != NULL) {
+		d->head->next = node;
+	} else {
+		d->tail = node;
+	}
+	d->head = node;
+	d->number_items++;
+	deque_filter_add(d, node->value);
+}
+
+/* Sort the deque in ascending order from left to right using the deque's
+ * compare_func.  The sort is stable: items that compare equal keep their
+ * relative order.
+ *
+ * This is a bottom-up merge sort on the nodes themselves.  Each pass merges
+ * neighbouring sorted runs of width 1, 2, 4, ... by relinking next pointers
+ * only, and the prev pointers are rebuilt in one final walk, so nothing is
+ * allocated and the extra memory used is O(1).  It runs in O(n log n) time
+ * regardless of the input.
+ *
+ * Returns the number of calls made to compare_func, which is never more
+ * than n * ceil(log2(n)), so the cost of an expensive comparator can be
+ * accounted for.
+ */
+uint64_t
+deque_sort(Deque d) {
+	DequeNode list = d->tail, p, q, e, last;
+	uint32_t width, merges, psize, qsize;
+	uint64_t comparisons = 0;
+
+	if (list == NULL) {
+		return 0;
+	}
+	for (width = 1; ; width *= 2) {
+		p = list;
+		list = NULL;
+		last = NULL;
+		merges = 0;
+		while (p != NULL) {
+			merges++;
+			/* p starts a run of up to width nodes and q the one after it */
+			q = p;
+			for (psize = 0; psize < width && q != NULL; psize++) {
+				q = q->next;
+			}
+			qsize = width;
+			while (psize > 0 || (qsize > 0 && q != NULL)) {
+				if (psize == 0) {
+					e = q;
+					q = q->next;
+					qsize--;
+				} else if (qsize == 0 || q == NULL) {
+					e = p;
+					p = p->next;
+					psize--;
+				} else {
+					comparisons++;
+					/* ties go to the left run to keep the sort stable */
+					if ((d->compare_func)(p->value, q->value) <= 0) {
+						e = p;
+						p = p->next;
+						psize--;
+					} else {
+						e = q;
+						q = q->next;
+						qsize--;
+					}
+				}
+				if (last != NULL) {
+					last->next = e;
+				} else {
+					list = e;
+				}
+				last = e;
+			}
+			p = q;
+		}
+		last->next = NULL;
+		if (merges <= 1) {
+			break;
+		}
+	}
+
+	last = NULL;
+	for (e = list; e != NULL; e = e->next) {
+		e->prev = last;
+		last = e;
+	}
+	d->tail = list;
+	d->head = last;
+	return comparisons;
+}
@@ -31,10 +31,16 @@
 #define DEQUE_STATIC
 #define DEQUE_MAX_NODES (10)
 
+/* Keep an attached BloomFilter up to date, see deque_set_filter().  Remove
+ * this to build deque.c on its own, without bloomfilter.c.
+ */
+#define DEQUE_FILTER
+
 typedef enum {
 	DEQUE_SUCCESS = 0,
 	DEQUE_FAILURE = 1,
-	DEQUE_ALLOC_ERROR = 2
+	DEQUE_ALLOC_ERROR = 2,
+	DEQUE_INDEX_ERROR = 3
 } deque_result_t;
 
 #define TRUE  (true)
@@ -44,6 +50,10 @@ typedef enum {
 #define DEQUE_MAX_NODES (20)
 #endif
 
+#define DEQUE_UNBOUNDED (0)
+
+struct bloomfilter_t;
+
 struct deque_node_t {
 	void* value;
 	struct deque_node_t *next;
@@ -58,6 +68,13 @@ struct deque_t {
 	struct deque_node_t *tail;
 	uint32_t number_items;
 	int8_t(*compare_func)(const void *, const void *);
+	uint32_t maxlen;
+	void(*evict_func)(void *, void *);
+	void *evict_arg;
+	struct deque_node_t *free_nodes;
+	struct deque_node_t *node_block;
+	uint32_t node_block_size;
+	struct bloomfilter_t *filter;
 #ifdef DEQUE_STATIC
 	struct deque_node_t nodes[DEQUE_MAX_NODES];
 #endif
@@ -66,15 +83,41 @@ struct deque_t {
 typedef struct deque_node_t *DequeNode;
 typedef struct deque_t *Deque;
 typedef int8_t(*deque_comparater_t)(const void*, const void*);
+typedef void(*deque_evict_func_t)(void*, void*);
 
 #ifndef DEQUE_STATIC
 Deque           deque_create(deque_comparater_t comp);
+Deque           deque_create_bounded(uint32_t maxlen, deque_comparater_t comp);
 Deque           deque_copy(Deque d);
 #endif
 void            deque_init(Deque d, deque_comparater_t comp);
+void            deque_init_bounded(Deque d, uint32_t maxlen, deque_comparater_t comp);
+void            deque_init_preallocated(Deque d, uint32_t maxlen,
+                                        deque_comparater_t comp,
+                                        struct deque_node_t *nodes);
+void            deque_set_evict_func(Deque d, deque_evict_func_t func, void* arg);
+#ifdef DEQUE_FILTER
+void            deque_set_filter(Deque d, struct bloomfilter_t *filter);
+#endif /* DEQUE_FILTER */
+uint32_t        deque_maxlen(Deque d);
+deque_result_t  deque_extend(Deque d, void** items, uint32_t n);
+deque_result_t  deque_extendleft(Deque d, void** items, uint32_t n);
+uint32_t        deque_pop_n(Deque d, void** out, uint32_t n);
+uint32_t        deque_popleft_n(Deque d, void** out, uint32_t n);
+deque_result_t  deque_splice(Deque d, Deque other);
+void*           deque_getitem(Deque d, int32_t index);
+deque_result_t  deque_setitem(Deque d, int32_t index, void* item);
+deque_result_t  deque_insert(Deque d, int32_t index, void* item);
+void*           deque_del(Deque d, int32_t index);
 void            deque_free(Deque d);
 deque_result_t  deque_append(Deque d, void* item);
 deque_result_t  deque_appendleft(Deque d, void* item);
+deque_result_t  deque_append_node(Deque d, void* item, DequeNode *node);
+deque_result_t  deque_appendleft_node(Deque d, void* item, DequeNode *node);
+void*           deque_remove_node(Deque d, DequeNode node);
+void            deque_move_to_front(Deque d, DequeNode node);
+void            deque_move_to_back(Deque d, DequeNode node);
+uint64_t        deque_sort(Deque d);
 deque_result_t  deque_clear(Deque d);
 void*           deque_peek(Deque d);
 void*           deque_pop(Deque d);
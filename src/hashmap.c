@@ -0,0 +1,479 @@
+/*
+ * hashmap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A hash map using open addressing with Robin Hood probing.
+ *
+ * Each key goes in the first slot at or after its home slot (chosen from its
+ * hash) whose occupant is closer to its own home; the displaced occupant
+ * carries on the same way.  This keeps probe sequences short and, because
+ * keys along a probe are sorted by distance from home, a lookup can stop at
+ * the first slot holding a key closer to home than it would be.  Deleting
+ * shifts the following keys of the run back one slot, so no tombstones are
+ * left behind to lengthen later probes.
+ *
+ * The distances and a tag byte from each key's hash are kept in two byte
+ * arrays apart from the entries.  With SSE2 a lookup checks sixteen slots
+ * per step: one compare finds the slots whose tag matches and another finds
+ * where the probe can stop, and only matching entries are touched.  Other
+ * targets use the same arrays one slot at a time.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "hashmap.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Distances are stored plus one and must stay below the highest signed
+ * byte for the SIMD compare, which also bounds the slots past the end.
+ */
+#define HASHMAP_MAX_DIST (126)
+#define HASHMAP_GROUP (16)
+
+static uint32_t
+default_hash(const void * key) {
+	uint64_t h = (uint64_t) (uintptr_t) key * 0x9e3779b97f4a7c15ULL;
+	return (uint32_t) (h >> 32);
+}
+
+static int8_t
+default_comparator(const void * a, const void * b) {
+	if (a == b) {
+		return 0;
+	} else {
+		return a > b ? 1 : -1;
+	}
+}
+
+/* FNV-1a hash of a NUL terminated string, for maps keyed by strings */
+uint32_t
+hashmap_hash_string(const void * key) {
+	const unsigned char *s = key;
+	uint32_t h = 2166136261u;
+	while (*s != '\0') {
+		h = (h ^ *s++) * 16777619u;
+	}
+	return h;
+}
+
+static uint32_t
+hashmap_home(HashMap m, uint32_t hash) {
+	return (uint32_t) (hash * 0x9e3779b9u) >> m->shift;
+}
+
+static uint8_t
+hashmap_tag(uint32_t hash) {
+	return (uint8_t) hash;
+}
+
+/* Point m at freshly allocated empty tables with capacity home slots, a
+ * power of two.  Returns false if memory cannot be allocated.
+ */
+static bool
+hashmap_alloc_tables(HashMap m, uint32_t capacity) {
+	uint32_t slots = capacity + HASHMAP_MAX_DIST;
+	uint32_t shift = 32;
+	void *block;
+
+	/* the byte arrays are padded so a group read never runs off the end */
+	block = malloc(slots * sizeof(struct hashmap_entry_t) + 2 * (slots + HASHMAP_GROUP));
+	if (block == NULL) {
+		return false;
+	}
+	for (; (UINT32_C(1) << (32 - shift)) < capacity; shift--);
+	m->entries = block;
+	m->dist = (uint8_t *) (m->entries + slots);
+	m->tags = m->dist + slots + HASHMAP_GROUP;
+	memset(m->dist, 0, 2 * (slots + HASHMAP_GROUP));
+	m->capacity = capacity;
+	m->shift = shift;
+	m->number_items = 0;
+	return true;
+}
+
+/* Create an empty hash map.  hash and comp work on keys; if either is NULL
+ * the keys are hashed and compared by address.
+ */
+HashMap
+hashmap_create(hashmap_hash_func_t hash, hashmap_comparater_t comp) {
+	return hashmap_create_size(0, hash, comp);
+}
+
+/* Create an empty hash map with room for items keys before it has to grow.
+ * NULL is returned if memory cannot be allocated.
+ */
+HashMap
+hashmap_create_size(uint32_t items, hashmap_hash_func_t hash,
+                    hashmap_comparater_t comp) {
+	HashMap m = malloc(sizeof(struct hashmap_t));
+	uint32_t capacity = HASHMAP_MIN_CAPACITY;
+	if (m == NULL) {
+		return NULL;
+	}
+	while (capacity - capacity / 8 < items) {
+		capacity *= 2;
+	}
+	if (!hashmap_alloc_tables(m, capacity)) {
+		free(m);
+		return NULL;
+	}
+	m->hash_func = hash != NULL ? hash : default_hash;
+	m->compare_func = comp != NULL ? comp : default_comparator;
+	return m;
+}
+
+/* Free the map.  The keys and values are not freed. */
+void
+hashmap_free(HashMap m) {
+	free(m->entries);
+	free(m);
+}
+
+/* Return the slot holding key, or -1 if it is not in the map */
+static int64_t
+hashmap_find(HashMap m, const void* key, uint32_t hash) {
+	uint32_t pos = hashmap_home(m, hash);
+	uint8_t tag = hashmap_tag(hash);
+#ifdef __SSE2__
+	const __m128i tags = _mm_set1_epi8((char) tag);
+	const __m128i step = _mm_set1_epi8(HASHMAP_GROUP);
+	__m128i expected = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8,
+	                                 9, 10, 11, 12, 13, 14, 15, 16);
+	uint32_t stop, match, slot;
+
+	for (;; pos += HASHMAP_GROUP) {
+		/* a key is never further along than a slot that is empty or
+		 * holds a key closer to home than the probe has come
+		 */
+		stop = _mm_movemask_epi8(_mm_cmplt_epi8(
+			_mm_loadu_si128((const __m128i *) (m->dist + pos)), expected));
+		match = _mm_movemask_epi8(_mm_cmpeq_epi8(
+			_mm_loadu_si128((const __m128i *) (m->tags + pos)), tags));
+		if (stop != 0) {
+			match &= (stop & -stop) - 1;
+		}
+		while (match != 0) {
+			slot = pos + __builtin_ctz(match);
+			if (m->entries[slot].hash == hash
+			    && (m->compare_func)(m->entries[slot].key, key) == 0) {
+				return slot;
+			}
+			match &= match - 1;
+		}
+		if (stop != 0) {
+			return -1;
+		}
+		expected = _mm_add_epi8(expected, step);
+	}
+#else
+	uint32_t dist;
+	for (dist = 1; m->dist[pos] >= dist; pos++, dist++) {
+		if (m->tags[pos] == tag && m->entries[pos].hash == hash
+		    && (m->compare_func)(m->entries[pos].key, key) == 0) {
+			return pos;
+		}
+	}
+	return -1;
+#endif
+}
+
+/* Return true if a key with this hash can be inserted without any key
+ * ending up more than HASHMAP_MAX_DIST - 1 slots from home.  This follows
+ * the displacements hashmap_place() would make, reading only distances.
+ */
+static bool
+hashmap_can_place(HashMap m, uint32_t hash) {
+	uint32_t pos = hashmap_home(m, hash);
+	uint8_t dist;
+	for (dist = 1; dist <= HASHMAP_MAX_DIST; pos++, dist++) {
+		if (m->dist[pos] == 0) {
+			return true;
+		}
+		if (m->dist[pos] < dist) {
+			dist = m->dist[pos];
+		}
+	}
+	return false;
+}
+
+/* Robin Hood insertion of an entry whose key is not in the map.  Each
+ * occupant closer to its home than the entry is to its own gives up its
+ * slot and moves on in its place.  Returns the slot the entry went into,
+ * or -1, leaving the table unchanged, if some key would end up too far
+ * from home.
+ */
+static int64_t
+hashmap_place(HashMap m, struct hashmap_entry_t entry) {
+	struct hashmap_entry_t tmpEntry;
+	uint32_t pos = hashmap_home(m, entry.hash);
+	uint8_t dist = 1, tag = hashmap_tag(entry.hash), tmp;
+	int64_t slot = -1;
+
+	if (!hashmap_can_place(m, entry.hash)) {
+		return -1;
+	}
+	for (;; pos++, dist++) {
+		if (m->dist[pos] == 0) {
+			m->entries[pos] = entry;
+			m->dist[pos] = dist;
+			m->tags[pos] = tag;
+			m->number_items++;
+			return slot >= 0 ? slot : pos;
+		}
+		if (m->dist[pos] < dist) {
+			if (slot < 0) {
+				slot = pos;
+			}
+			tmpEntry = m->entries[pos];
+			m->entries[pos] = entry;
+			entry = tmpEntry;
+			tmp = m->dist[pos];
+			m->dist[pos] = dist;
+			dist = tmp;
+			tmp = m->tags[pos];
+			m->tags[pos] = tag;
+			tag = tmp;
+		}
+	}
+}
+
+/* Move every entry into new tables with capacity home slots.  The map is
+ * left unchanged if memory runs out (HASHMAP_ALLOC_ERROR) or some key would
+ * be too far from home in the new table (HASHMAP_FAILURE).
+ */
+static hashmap_result_t
+hashmap_rehash(HashMap m, uint32_t capacity) {
+	struct hashmap_t old = *m;
+	uint32_t i, slots = old.capacity + HASHMAP_MAX_DIST;
+
+	if (!hashmap_alloc_tables(m, capacity)) {
+		*m = old;
+		return HASHMAP_ALLOC_ERROR;
+	}
+	for (i = 0; i < slots; i++) {
+		if (old.dist[i] != 0 && hashmap_place(m, old.entries[i]) < 0) {
+			free(m->entries);
+			*m = old;
+			return HASHMAP_FAILURE;
+		}
+	}
+	free(old.entries);
+	return HASHMAP_SUCCESS;
+}
+
+/* Return true if growing past capacity to shorten probes is pointless:
+ * a table this sparse only has overlong probes if the hash function sends
+ * too many keys to the same few slots.
+ */
+static bool
+hashmap_too_sparse(HashMap m, uint32_t capacity) {
+	return capacity / 64 > m->number_items || capacity >= (UINT32_C(1) << 31);
+}
+
+/* Rehash into at least capacity home slots, doubling further while probes
+ * are still too long, up to hashmap_too_sparse().
+ */
+static hashmap_result_t
+hashmap_grow(HashMap m, uint32_t capacity) {
+	hashmap_result_t result;
+	while ((result = hashmap_rehash(m, capacity)) == HASHMAP_FAILURE
+	       && !hashmap_too_sparse(m, capacity)) {
+		capacity *= 2;
+	}
+	return result;
+}
+
+/* Make room for at least items keys in total, so that inserting up to that
+ * many does not rehash.
+ */
+hashmap_result_t
+hashmap_reserve(HashMap m, uint32_t items) {
+	uint32_t capacity = m->capacity;
+	while (capacity - capacity / 8 < items) {
+		capacity *= 2;
+	}
+	if (capacity == m->capacity) {
+		return HASHMAP_SUCCESS;
+	}
+	return hashmap_grow(m, capacity);
+}
+
+/* Insert key, which is not in the map, with value and return its slot in
+ * *slot.  The table doubles when it would be more than 7/8 full, or when
+ * the key's probe would get too long.  HASHMAP_FAILURE is returned if the
+ * key cannot be placed even in a mostly empty table.
+ */
+static hashmap_result_t
+hashmap_insert(HashMap m, void* key, void* value, uint32_t hash, int64_t *slot) {
+	struct hashmap_entry_t entry;
+	hashmap_result_t result;
+
+	if ((result = hashmap_reserve(m, m->number_items + 1)) != HASHMAP_SUCCESS) {
+		return result;
+	}
+	entry.key = key;
+	entry.value = value;
+	entry.hash = hash;
+	while ((*slot = hashmap_place(m, entry)) < 0) {
+		if (hashmap_too_sparse(m, m->capacity)) {
+			return HASHMAP_FAILURE;
+		}
+		if ((result = hashmap_grow(m, 2 * m->capacity)) != HASHMAP_SUCCESS) {
+			return result;
+		}
+	}
+	return HASHMAP_SUCCESS;
+}
+
+/* Map key to value, replacing the value if key is already present.  O(1)
+ * on average.
+ */
+hashmap_result_t
+hashmap_put(HashMap m, void* key, void* value) {
+	uint32_t hash = (m->hash_func)(key);
+	int64_t slot;
+
+	if ((slot = hashmap_find(m, key, hash)) >= 0) {
+		m->entries[slot].value = value;
+		return HASHMAP_SUCCESS;
+	}
+	return hashmap_insert(m, key, value, hash, &slot);
+}
+
+/* Return a pointer to the value for key, first putting key with value if
+ * it is not in the map.  The key is hashed once, and a key that is present
+ * is found with a single probe; a new key is probed for again to place it.
+ * This is the way to update a value in place, such as a count.  The
+ * pointer is good until the map is next changed.  NULL is returned if key
+ * cannot be inserted.
+ */
+void**
+hashmap_setdefault(HashMap m, void* key, void* value) {
+	uint32_t hash = (m->hash_func)(key);
+	int64_t slot;
+
+	if ((slot = hashmap_find(m, key, hash)) < 0
+	    && hashmap_insert(m, key, value, hash, &slot) != HASHMAP_SUCCESS) {
+		return NULL;
+	}
+	return &m->entries[slot].value;
+}
+
+/* Put n keys with their values.  The table is sized for all of them up
+ * front, so it is rehashed at most once.
+ */
+hashmap_result_t
+hashmap_put_batch(HashMap m, void** keys, void** values, uint32_t n) {
+	hashmap_result_t result;
+	uint32_t i;
+	if ((result = hashmap_reserve(m, m->number_items + n)) != HASHMAP_SUCCESS) {
+		return result;
+	}
+	for (i = 0; i < n; i++) {
+		if ((result = hashmap_put(m, keys[i], values[i])) != HASHMAP_SUCCESS) {
+			return result;
+		}
+	}
+	return HASHMAP_SUCCESS;
+}
+
+/* Return the value for key, or NULL if key is not in the map.  Use
+ * hashmap_contains() if NULL values are stored.  O(1) on average.
+ */
+void*
+hashmap_get(HashMap m, const void* key) {
+	int64_t slot = hashmap_find(m, key, (m->hash_func)(key));
+	return slot >= 0 ? m->entries[slot].value : NULL;
+}
+
+/* Return a pointer to the value for key, or NULL if key is not in the map.
+ * The pointer is good until the map is next changed.
+ */
+void**
+hashmap_lookup(HashMap m, const void* key) {
+	int64_t slot = hashmap_find(m, key, (m->hash_func)(key));
+	return slot >= 0 ? &m->entries[slot].value : NULL;
+}
+
+/* Return true if key is in the map */
+bool
+hashmap_contains(HashMap m, const void* key) {
+	return hashmap_find(m, key, (m->hash_func)(key)) >= 0;
+}
+
+/* Remove key and return its value, or NULL if key is not in the map.  The
+ * rest of the key's run moves back a slot.  O(1) on average.
+ */
+void*
+hashmap_remove(HashMap m, const void* key) {
+	int64_t slot = hashmap_find(m, key, (m->hash_func)(key));
+	uint32_t pos;
+	void* value;
+
+	if (slot < 0) {
+		return NULL;
+	}
+	pos = (uint32_t) slot;
+	value = m->entries[pos].value;
+	while (m->dist[pos + 1] > 1) {
+		m->entries[pos] = m->entries[pos + 1];
+		m->dist[pos] = m->dist[pos + 1] - 1;
+		m->tags[pos] = m->tags[pos + 1];
+		pos++;
+	}
+	m->dist[pos] = 0;
+	m->number_items--;
+	return value;
+}
+
+/* Remove every key, keeping the tables */
+void
+hashmap_clear(HashMap m) {
+	memset(m->dist, 0, m->capacity + HASHMAP_MAX_DIST);
+	m->number_items = 0;
+}
+
+/* Return the number of keys in the map */
+uint32_t
+hashmap_count(HashMap m) {
+	return m->number_items;
+}
+
+/* Iterate over the map.  Set *iter to 0 and call until false is returned;
+ * each call stores the next key and value.  The order is arbitrary and the
+ * map must not be modified during the iteration.
+ */
+bool
+hashmap_next(HashMap m, uint32_t *iter, void** key, void** value) {
+	uint32_t slots = m->capacity + HASHMAP_MAX_DIST;
+	for (; *iter < slots; (*iter)++) {
+		if (m->dist[*iter] != 0) {
+			*key = m->entries[*iter].key;
+			*value = m->entries[*iter].value;
+			(*iter)++;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,81 @@
+/*
+ * hashmap.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HASHMAP_MIN_CAPACITY (16)
+
+typedef enum {
+	HASHMAP_SUCCESS = 0,
+	HASHMAP_FAILURE = 1,
+	HASHMAP_ALLOC_ERROR = 2
+} hashmap_result_t;
+
+struct hashmap_entry_t {
+	void* key;
+	void* value;
+	uint32_t hash;
+};
+
+/* Slot i holds entries[i] when dist[i] is non-zero, dist[i] - 1 slots
+ * past the key's home slot, and tags[i] is a byte of the key's hash.
+ * There are capacity home slots plus room for the longest probe past the
+ * last one, so probes never wrap around.
+ */
+struct hashmap_t {
+	struct hashmap_entry_t *entries;
+	uint8_t *dist;
+	uint8_t *tags;
+	uint32_t capacity;
+	uint32_t shift;
+	uint32_t number_items;
+	uint32_t(*hash_func)(const void *);
+	int8_t(*compare_func)(const void *, const void *);
+};
+
+typedef struct hashmap_t *HashMap;
+typedef uint32_t(*hashmap_hash_func_t)(const void*);
+typedef int8_t(*hashmap_comparater_t)(const void*, const void*);
+
+HashMap           hashmap_create(hashmap_hash_func_t hash, hashmap_comparater_t comp);
+HashMap           hashmap_create_size(uint32_t items, hashmap_hash_func_t hash,
+                                      hashmap_comparater_t comp);
+void              hashmap_free(HashMap m);
+hashmap_result_t  hashmap_reserve(HashMap m, uint32_t items);
+hashmap_result_t  hashmap_put(HashMap m, void* key, void* value);
+hashmap_result_t  hashmap_put_batch(HashMap m, void** keys, void** values, uint32_t n);
+void**            hashmap_setdefault(HashMap m, void* key, void* value);
+void*             hashmap_get(HashMap m, const void* key);
+void**            hashmap_lookup(HashMap m, const void* key);
+bool              hashmap_contains(HashMap m, const void* key);
+void*             hashmap_remove(HashMap m, const void* key);
+void              hashmap_clear(HashMap m);
+uint32_t          hashmap_count(HashMap m);
+bool              hashmap_next(HashMap m, uint32_t *iter, void** key, void** value);
+uint32_t          hashmap_hash_string(const void* key);
+#endif
@@ -0,0 +1,171 @@
+/*
+ * ideque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * An intrusive deque.  Rather than allocating a node per item, the
+ * caller embeds a struct ideque_link_t in its own objects and gets the object
+ * back from a link with IDEQUE_ENTRY().  No operation allocates or frees
+ * memory, and an object can be removed in O(1) given a pointer to it.
+ *
+ * The links form a ring through a sentinel in the deque itself, so linking
+ * and unlinking never have to special case an empty deque or either end.
+ */
+#include <assert.h>
+#include "ideque.h"
+
+/* Initialize an empty intrusive deque */
+void
+ideque_init(IDeque d) {
+	d->sentinel.next = &d->sentinel;
+	d->sentinel.prev = &d->sentinel;
+	d->number_items = 0;
+}
+
+/* Mark a link as not being in any deque, see ideque_is_linked() */
+void
+ideque_link_init(IDequeLink link) {
+	link->next = NULL;
+	link->prev = NULL;
+}
+
+/* Return true if link is currently in a deque.  This only works if the
+ * link was passed to ideque_link_init() before it was first appended;
+ * links are reset the same way whenever they are popped or removed.
+ */
+bool
+ideque_is_linked(IDequeLink link) {
+	return link->next != NULL;
+}
+
+static void
+ideque_link_between(IDeque d, IDequeLink link, IDequeLink prev, IDequeLink next) {
+	link->prev = prev;
+	link->next = next;
+	prev->next = link;
+	next->prev = link;
+	d->number_items++;
+}
+
+/* Append link to the right end of the deque (head).  O(1). */
+void
+ideque_append(IDeque d, IDequeLink link) {
+	ideque_link_between(d, link, d->sentinel.prev, &d->sentinel);
+}
+
+/* Append link to the left end of the deque (tail).  O(1). */
+void
+ideque_appendleft(IDeque d, IDequeLink link) {
+	ideque_link_between(d, link, &d->sentinel, d->sentinel.next);
+}
+
+/* Return the rightmost link or NULL if the deque is empty */
+IDequeLink
+ideque_peek(IDeque d) {
+	return d->number_items > 0 ? d->sentinel.prev : NULL;
+}
+
+/* Return the leftmost link or NULL if the deque is empty */
+IDequeLink
+ideque_peekleft(IDeque d) {
+	return d->number_items > 0 ? d->sentinel.next : NULL;
+}
+
+/* Remove link from the deque it is in, which must be d.  O(1). */
+void
+ideque_remove(IDeque d, IDequeLink link) {
+	assert(ideque_is_linked(link) && d->number_items > 0);
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next = NULL;
+	link->prev = NULL;
+	d->number_items--;
+}
+
+/* Remove and return the rightmost link or NULL if the deque is empty */
+IDequeLink
+ideque_pop(IDeque d) {
+	IDequeLink link = ideque_peek(d);
+	if (link != NULL) {
+		ideque_remove(d, link);
+	}
+	return link;
+}
+
+/* Remove and return the leftmost link or NULL if the deque is empty */
+IDequeLink
+ideque_popleft(IDeque d) {
+	IDequeLink link = ideque_peekleft(d);
+	if (link != NULL) {
+		ideque_remove(d, link);
+	}
+	return link;
+}
+
+/* Move link, which must be in d, to the right end.  O(1). */
+void
+ideque_move_to_back(IDeque d, IDequeLink link) {
+	ideque_remove(d, link);
+	ideque_append(d, link);
+}
+
+/* Move every link of other onto the right end of d, keeping their order,
+ * and leave other empty.  O(1) regardless of the number of links.
+ */
+void
+ideque_splice(IDeque d, IDeque other) {
+	IDequeLink first, last;
+	if (other->number_items == 0) {
+		return;
+	}
+	first = other->sentinel.next;
+	last = other->sentinel.prev;
+	first->prev = d->sentinel.prev;
+	d->sentinel.prev->next = first;
+	last->next = &d->sentinel;
+	d->sentinel.prev = last;
+	d->number_items += other->number_items;
+	ideque_init(other);
+}
+
+/* Return the link to the right of link, or NULL if link is the rightmost.
+ * Together with ideque_peekleft() this walks the deque from left to right:
+ *
+ *   for (l = ideque_peekleft(d); l != NULL; l = ideque_next(d, l))
+ *
+ * The link returned must be fetched before link is removed.
+ */
+IDequeLink
+ideque_next(IDeque d, IDequeLink link) {
+	return link->next != &d->sentinel ? link->next : NULL;
+}
+
+/* Return the link to the left of link, or NULL if link is the leftmost */
+IDequeLink
+ideque_prev(IDeque d, IDequeLink link) {
+	return link->prev != &d->sentinel ? link->prev : NULL;
+}
+
+/* Return the number of links in the deque */
+uint32_t
+ideque_count(IDeque d) {
+	return d->number_items;
+}
@@ -0,0 +1,72 @@
+/*
+ * ideque.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef IDEQUE_H
+#define IDEQUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Embed one of these in each object that can be put in an IDeque.  An
+ * object can be in as many intrusive deques at once as it has links.
+ */
+struct ideque_link_t {
+	struct ideque_link_t *next;
+	struct ideque_link_t *prev;
+};
+
+/* The links form a ring through the sentinel: sentinel.next is the leftmost
+ * link (tail) and sentinel.prev the rightmost (head), as in the Deque.
+ */
+struct ideque_t {
+	struct ideque_link_t sentinel;
+	uint32_t number_items;
+};
+
+typedef struct ideque_t *IDeque;
+typedef struct ideque_link_t *IDequeLink;
+
+/* Recover a pointer to the object of the given type containing link as
+ * the named member.  link must not be NULL.
+ */
+#define IDEQUE_ENTRY(link, type, member) \
+	((type *) ((char *) (link) - offsetof(type, member)))
+
+void        ideque_init(IDeque d);
+void        ideque_link_init(IDequeLink link);
+bool        ideque_is_linked(IDequeLink link);
+void        ideque_append(IDeque d, IDequeLink link);
+void        ideque_appendleft(IDeque d, IDequeLink link);
+IDequeLink  ideque_peek(IDeque d);
+IDequeLink  ideque_pop(IDeque d);
+IDequeLink  ideque_peekleft(IDeque d);
+IDequeLink  ideque_popleft(IDeque d);
+void        ideque_remove(IDeque d, IDequeLink link);
+void        ideque_move_to_back(IDeque d, IDequeLink link);
+void        ideque_splice(IDeque d, IDeque other);
+IDequeLink  ideque_next(IDeque d, IDequeLink link);
+IDequeLink  ideque_prev(IDeque d, IDequeLink link);
+uint32_t    ideque_count(IDeque d);
+#endif
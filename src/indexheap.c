@@ -0,0 +1,210 @@
+/*
+ * indexheap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * An indexed priority queue: a 4-ary min-heap of caller supplied nodes in
+ * which every node records its own position in the heap array.  Given the
+ * node, an item whose priority changed can be sifted into place and any item
+ * can be removed in O(log n), without the O(n) search that arraylist_index()
+ * would need.  This is the decrease-key operation Dijkstra's and Prim's
+ * algorithms and deadline schedulers rely on.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "indexheap.h"
+
+/* Create an empty heap ordered by comp, smallest item first */
+IndexHeap
+indexheap_create(indexheap_comparater_t comp) {
+	return indexheap_create_size(INDEXHEAP_DEFAULT_SIZE, comp);
+}
+
+/* Create an empty heap with room for capacity nodes before it has to grow.
+ * NULL is returned if memory cannot be allocated.
+ */
+IndexHeap
+indexheap_create_size(uint32_t capacity, indexheap_comparater_t comp) {
+	IndexHeap h;
+	assert(comp != NULL);
+	if ((h = malloc(sizeof(struct indexheap_t))) == NULL) {
+		return NULL;
+	}
+	capacity = capacity > 0 ? capacity : INDEXHEAP_DEFAULT_SIZE;
+	if ((h->heap = malloc(capacity * sizeof(IndexHeapNode))) == NULL) {
+		free(h);
+		return NULL;
+	}
+	h->number_items = 0;
+	h->capacity = capacity;
+	h->compare_func = comp;
+	return h;
+}
+
+/* Free the heap.  The nodes and items are not freed. */
+void
+indexheap_free(IndexHeap h) {
+	free(h->heap);
+	free(h);
+}
+
+/* Mark a node as not being in any heap */
+void
+indexheap_node_init(IndexHeapNode node) {
+	node->item = NULL;
+	node->position = INDEXHEAP_NOT_QUEUED;
+}
+
+/* Return true if node is queued in h.  O(1). */
+bool
+indexheap_contains(IndexHeap h, IndexHeapNode node) {
+	return node->position < h->number_items && h->heap[node->position] == node;
+}
+
+static void
+indexheap_set(IndexHeap h, uint32_t pos, IndexHeapNode node) {
+	h->heap[pos] = node;
+	node->position = pos;
+}
+
+/* Move node up from pos while it compares less than its parent.  Returns
+ * true if it moved.
+ */
+static bool
+indexheap_sift_up(IndexHeap h, uint32_t pos, IndexHeapNode node) {
+	uint32_t start = pos, parent;
+	while (pos > 0) {
+		parent = (pos - 1) / INDEXHEAP_ARITY;
+		if ((h->compare_func)(node->item, h->heap[parent]->item) >= 0) {
+			break;
+		}
+		indexheap_set(h, pos, h->heap[parent]);
+		pos = parent;
+	}
+	indexheap_set(h, pos, node);
+	return pos != start;
+}
+
+/* Move node down from pos while a child compares less than it */
+static void
+indexheap_sift_down(IndexHeap h, uint32_t pos, IndexHeapNode node) {
+	uint32_t n = h->number_items, child, last, best, i;
+	for (;;) {
+		child = INDEXHEAP_ARITY * pos + 1;
+		if (child >= n) {
+			break;
+		}
+		last = child + INDEXHEAP_ARITY < n ? child + INDEXHEAP_ARITY : n;
+		best = child;
+		for (i = child + 1; i < last; i++) {
+			if ((h->compare_func)(h->heap[i]->item, h->heap[best]->item) < 0) {
+				best = i;
+			}
+		}
+		if ((h->compare_func)(h->heap[best]->item, node->item) >= 0) {
+			break;
+		}
+		indexheap_set(h, pos, h->heap[best]);
+		pos = best;
+	}
+	indexheap_set(h, pos, node);
+}
+
+/* Queue item using node as its handle.  node must not already be queued.
+ * O(log n).
+ */
+indexheap_result_t
+indexheap_push(IndexHeap h, IndexHeapNode node, void* item) {
+	IndexHeapNode *newHeap;
+	if (h->number_items == h->capacity) {
+		newHeap = realloc(h->heap, 2 * h->capacity * sizeof(IndexHeapNode));
+		if (newHeap == NULL) {
+			return INDEXHEAP_ALLOC_ERROR;
+		}
+		h->heap = newHeap;
+		h->capacity *= 2;
+	}
+	node->item = item;
+	h->number_items++;
+	indexheap_sift_up(h, h->number_items - 1, node);
+	return INDEXHEAP_SUCCESS;
+}
+
+/* Return the smallest item without removing it, or NULL if empty.  O(1). */
+void*
+indexheap_peek(IndexHeap h) {
+	return h->number_items > 0 ? h->heap[0]->item : NULL;
+}
+
+/* Remove the smallest item and return its node, or NULL if empty */
+IndexHeapNode
+indexheap_pop_node(IndexHeap h) {
+	IndexHeapNode top;
+	if (h->number_items == 0) {
+		return NULL;
+	}
+	top = h->heap[0];
+	indexheap_remove(h, top);
+	return top;
+}
+
+/* Remove and return the smallest item, or NULL if empty.  O(log n). */
+void*
+indexheap_pop(IndexHeap h) {
+	IndexHeapNode top = indexheap_pop_node(h);
+	return top != NULL ? top->item : NULL;
+}
+
+/* Restore the heap order after the priority of node's item changed, in
+ * either direction.  O(log n).
+ */
+void
+indexheap_update_priority(IndexHeap h, IndexHeapNode node) {
+	assert(indexheap_contains(h, node));
+	if (!indexheap_sift_up(h, node->position, node)) {
+		indexheap_sift_down(h, node->position, node);
+	}
+}
+
+/* Remove node from the heap wherever it is and return its item.  O(log n). */
+void*
+indexheap_remove(IndexHeap h, IndexHeapNode node) {
+	uint32_t pos = node->position;
+	IndexHeapNode last;
+
+	assert(indexheap_contains(h, node));
+	h->number_items--;
+	if (pos < h->number_items) {
+		/* fill the hole with the last node and sift it whichever way */
+		last = h->heap[h->number_items];
+		if (!indexheap_sift_up(h, pos, last)) {
+			indexheap_sift_down(h, pos, last);
+		}
+	}
+	node->position = INDEXHEAP_NOT_QUEUED;
+	return node->item;
+}
+
+/* Return the number of queued items */
+uint32_t
+indexheap_count(IndexHeap h) {
+	return h->number_items;
+}
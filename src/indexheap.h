@@ -0,0 +1,73 @@
+/*
+ * indexheap.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef INDEXHEAP_H
+#define INDEXHEAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INDEXHEAP_ARITY (4)
+#define INDEXHEAP_DEFAULT_SIZE (16)
+#define INDEXHEAP_NOT_QUEUED (UINT32_MAX)
+
+typedef enum {
+	INDEXHEAP_SUCCESS = 0,
+	INDEXHEAP_FAILURE = 1,
+	INDEXHEAP_ALLOC_ERROR = 2
+} indexheap_result_t;
+
+/* A handle for an item in the heap, supplied by the caller (usually
+ * embedded next to the item).  position is the node's index in the heap
+ * array, kept up to date as it moves, or INDEXHEAP_NOT_QUEUED.
+ */
+struct indexheap_node_t {
+	void* item;
+	uint32_t position;
+};
+
+struct indexheap_t {
+	struct indexheap_node_t **heap;
+	uint32_t number_items;
+	uint32_t capacity;
+	int8_t(*compare_func)(const void *, const void *);
+};
+
+typedef struct indexheap_t *IndexHeap;
+typedef struct indexheap_node_t *IndexHeapNode;
+typedef int8_t(*indexheap_comparater_t)(const void*, const void*);
+
+IndexHeap           indexheap_create(indexheap_comparater_t comp);
+IndexHeap           indexheap_create_size(uint32_t capacity, indexheap_comparater_t comp);
+void                indexheap_free(IndexHeap h);
+void                indexheap_node_init(IndexHeapNode node);
+bool                indexheap_contains(IndexHeap h, IndexHeapNode node);
+indexheap_result_t  indexheap_push(IndexHeap h, IndexHeapNode node, void* item);
+void*               indexheap_peek(IndexHeap h);
+void*               indexheap_pop(IndexHeap h);
+IndexHeapNode       indexheap_pop_node(IndexHeap h);
+void                indexheap_update_priority(IndexHeap h, IndexHeapNode node);
+void*               indexheap_remove(IndexHeap h, IndexHeapNode node);
+uint32_t            indexheap_count(IndexHeap h);
+#endif
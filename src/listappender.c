@@ -0,0 +1,245 @@
+/*
+ * listappender.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * Concurrent appends to an ArrayList from many threads without a lock on the
+ * common path.
+ *
+ * An append takes its slots with a single atomic fetch-add on the reserved
+ * count, however many items it brings, and writes them into the table with
+ * no further synchronisation.  Only when a reservation runs past the table's
+ * capacity does anything wait: one of the appenders that ran out closes the
+ * gate to new writers, waits for the writers already inside to finish with
+ * the old table, copies it into one at least twice the size and reopens the
+ * gate.  Writers never see the table move under them.
+ *
+ * Appends finish in any order and none waits for another to publish.  Each
+ * adds its slots to a completed count, and the one that brings completed
+ * level with reserved knows every slot reserved so far is written, so it
+ * publishes that length.  listappender_published() is therefore always the
+ * length of a prefix that has been completely written, and catches up with
+ * the appends whenever those in flight have all returned.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "listappender.h"
+#ifdef ARRAYLIST_FILTER
+#include "bloomfilter.h"
+#endif /* ARRAYLIST_FILTER */
+
+#define LISTAPPENDER_MIN_CAPACITY (16)
+
+/* Start appending to list.  While appenders are running the list itself
+ * must not be used; listappender_finish() hands it back.
+ */
+void
+listappender_init(ListAppender a, ArrayList list) {
+	a->list = list;
+	atomic_init(&a->table, list->ptr_table);
+	atomic_init(&a->capacity, list->capacity);
+	atomic_init(&a->growing, false);
+	atomic_init(&a->failed, false);
+	atomic_init(&a->limit, UINT32_MAX);
+	a->number_retired = 0;
+	atomic_init(&a->reserved, list->number_items);
+	atomic_init(&a->writers, 0);
+	atomic_init(&a->completed, list->number_items);
+	atomic_init(&a->published, list->number_items);
+}
+
+/* Stop appending and bring the list, and its filter if it has one, up to
+ * date with the published items.  No appends may be running.  Tables
+ * retired by growth are freed now.
+ */
+void
+listappender_finish(ListAppender a) {
+	uint32_t i, published = atomic_load(&a->published);
+	a->list->ptr_table = atomic_load(&a->table);
+	a->list->capacity = atomic_load(&a->capacity);
+#ifdef ARRAYLIST_FILTER
+	for (i = a->list->number_items; a->list->filter != NULL && i < published; i++) {
+		bloomfilter_add(a->list->filter, a->list->ptr_table[i]);
+	}
+#endif /* ARRAYLIST_FILTER */
+	a->list->number_items = published;
+	for (i = 0; i < a->number_retired; i++) {
+		free(a->retired[i]);
+	}
+	a->number_retired = 0;
+}
+
+/* Count this thread among the writers, waiting out any growth in progress */
+static void
+listappender_enter(ListAppender a) {
+	for (;;) {
+		atomic_fetch_add(&a->writers, 1);
+		if (!atomic_load(&a->growing)) {
+			return;
+		}
+		atomic_fetch_sub(&a->writers, 1);
+		while (atomic_load(&a->growing)) {
+			sched_yield();
+		}
+	}
+}
+
+/* Called, outside the writers, by an appender whose slots end at needed,
+ * past the capacity.  One such appender grows the table to hold every slot
+ * reserved so far while the rest wait for it.  Returns the failure if the
+ * table cannot grow; once that happens every later append fails as well,
+ * so the slots given up are always the tail of those reserved.
+ */
+static listappender_result_t
+listappender_grow(ListAppender a, uint32_t needed) {
+	void **old, **table;
+	uint32_t capacity, reserved;
+	bool expected = false;
+
+	while (atomic_load(&a->capacity) < needed) {
+		if (atomic_load(&a->failed)) {
+			return a->list->list_type == ARRAYLIST_TYPE_FIXED
+			       ? LISTAPPENDER_FAILURE : LISTAPPENDER_ALLOC_ERROR;
+		}
+		if (!atomic_compare_exchange_strong(&a->growing, &expected, true)) {
+			expected = false;
+			sched_yield();
+			continue;
+		}
+
+		/* the gate is shut: once the writers inside are done, no one
+		 * touches the table or takes slots until it reopens
+		 */
+		while (atomic_load(&a->writers) > 0) {
+			sched_yield();
+		}
+		capacity = atomic_load(&a->capacity);
+		reserved = atomic_load(&a->reserved);
+		if (capacity < needed) {
+			old = atomic_load(&a->table);
+			table = NULL;
+			if (a->list->list_type != ARRAYLIST_TYPE_FIXED) {
+				capacity = capacity * 2 > LISTAPPENDER_MIN_CAPACITY
+				           ? capacity * 2 : LISTAPPENDER_MIN_CAPACITY;
+				capacity = capacity > reserved ? capacity : reserved;
+				table = malloc(capacity * sizeof(void*));
+			}
+			if (table == NULL) {
+				atomic_store(&a->failed, true);
+			} else {
+				memcpy(table, old, atomic_load(&a->capacity) * sizeof(void*));
+				a->retired[a->number_retired++] = old;
+				atomic_store(&a->table, table);
+				atomic_store(&a->capacity, capacity);
+			}
+		}
+		atomic_store(&a->growing, false);
+	}
+	return LISTAPPENDER_SUCCESS;
+}
+
+/* Lower the limit on publishing to start, the first slot of a failed append */
+static void
+listappender_give_up(ListAppender a, uint32_t start) {
+	uint32_t limit = atomic_load(&a->limit);
+	while (start < limit) {
+		if (atomic_compare_exchange_weak(&a->limit, &limit, start)) {
+			break;
+		}
+	}
+}
+
+/* Count n slots as done with, written or given up.  If no reserved slot is
+ * still outstanding, everything below reserved, up to the limit, is written
+ * and published is raised to it.
+ */
+static void
+listappender_complete(ListAppender a, uint32_t n) {
+	uint32_t completed, published, limit;
+
+	completed = atomic_fetch_add_explicit(&a->completed, n, memory_order_acq_rel) + n;
+	if (completed != atomic_load(&a->reserved)) {
+		return;
+	}
+	limit = atomic_load(&a->limit);
+	completed = completed < limit ? completed : limit;
+	published = atomic_load(&a->published);
+	while (published < completed) {
+		if (atomic_compare_exchange_weak_explicit(&a->published, &published,
+				completed, memory_order_release, memory_order_relaxed)) {
+			break;
+		}
+	}
+}
+
+/* Append n items as one run of adjacent slots.  Safe to call from any
+ * number of threads at once.  Returns LISTAPPENDER_FAILURE if the list is
+ * fixed size and the items do not fit, LISTAPPENDER_ALLOC_ERROR if it
+ * cannot grow; either way nothing is appended.
+ */
+listappender_result_t
+listappender_append_n(ListAppender a, void** items, uint32_t n) {
+	listappender_result_t result;
+	uint32_t start;
+
+	listappender_enter(a);
+	start = atomic_fetch_add(&a->reserved, n);
+	if (start + n > atomic_load(&a->capacity)) {
+		atomic_fetch_sub(&a->writers, 1);
+		if ((result = listappender_grow(a, start + n)) != LISTAPPENDER_SUCCESS) {
+			listappender_give_up(a, start);
+			listappender_complete(a, n);
+			return result;
+		}
+		listappender_enter(a);
+	}
+	memcpy(atomic_load(&a->table) + start, items, n * sizeof(void*));
+	atomic_fetch_sub(&a->writers, 1);
+	listappender_complete(a, n);
+	return LISTAPPENDER_SUCCESS;
+}
+
+/* Append one item, see listappender_append_n() */
+listappender_result_t
+listappender_append(ListAppender a, void* item) {
+	return listappender_append_n(a, &item, 1);
+}
+
+/* Return the number of items published: every index below it holds its
+ * item and may be read with listappender_get() while appends go on
+ */
+uint32_t
+listappender_published(ListAppender a) {
+	return atomic_load_explicit(&a->published, memory_order_acquire);
+}
+
+/* Return the item at index, which must be below a value returned by
+ * listappender_published() in this thread
+ * 
+ * The table is read after the published count, so it is at least as new as
+ * the one the item was written to, and tables are only retired, not freed,
+ * while appends may be running.
+ */
+void*
+listappender_get(ListAppender a, uint32_t index) {
+	return atomic_load(&a->table)[index];
+}
@@ -0,0 +1,76 @@
+/*
+ * listappender.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LISTAPPENDER_H
+#define LISTAPPENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "arraylist.h"
+
+#ifndef LISTAPPENDER_CACHE_LINE
+#define LISTAPPENDER_CACHE_LINE (64)
+#endif
+
+/* a table is retired each time it doubles, so 32 covers any uint32_t size */
+#define LISTAPPENDER_MAX_RETIRED (32)
+
+typedef enum {
+	LISTAPPENDER_SUCCESS = 0,
+	LISTAPPENDER_FAILURE = 1,
+	LISTAPPENDER_ALLOC_ERROR = 2
+} listappender_result_t;
+
+/* Appenders take slots from reserved, write them into table while counted
+ * in writers and then add them to completed.  published is the length of a
+ * prefix of the list known to be written; limit is the first slot given up
+ * by a failed append, past which nothing is ever published.  Tables replaced
+ * by growth are kept in retired until listappender_finish(), so a reader
+ * holding one never sees it freed.
+ */
+struct listappender_t {
+	ArrayList list;
+	_Atomic(void**) table;
+	atomic_uint capacity;
+	atomic_bool growing;
+	atomic_bool failed;
+	atomic_uint limit;
+	void **retired[LISTAPPENDER_MAX_RETIRED];
+	uint32_t number_retired;
+	_Alignas(LISTAPPENDER_CACHE_LINE) atomic_uint reserved;
+	_Alignas(LISTAPPENDER_CACHE_LINE) atomic_uint writers;
+	_Alignas(LISTAPPENDER_CACHE_LINE) atomic_uint completed;
+	_Alignas(LISTAPPENDER_CACHE_LINE) atomic_uint published;
+};
+
+typedef struct listappender_t *ListAppender;
+
+void                   listappender_init(ListAppender a, ArrayList list);
+void                   listappender_finish(ListAppender a);
+listappender_result_t  listappender_append(ListAppender a, void* item);
+listappender_result_t  listappender_append_n(ListAppender a, void** items, uint32_t n);
+uint32_t               listappender_published(ListAppender a);
+void*                  listappender_get(ListAppender a, uint32_t index);
+#endif
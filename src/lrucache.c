@@ -0,0 +1,236 @@
+/*
+ * lrucache.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A fixed capacity least recently used cache.  Lookups go through a chained
+ * hash table and the order of use is kept in a Deque through the node
+ * handles returned by deque_append_node(), so get and put are both O(1):
+ * a hit moves its node to the right end with deque_move_to_back() and a put
+ * into a full cache evicts the leftmost entry.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "lrucache.h"
+
+static uint32_t
+default_hash(const void * key) {
+	uint64_t h = (uint64_t) (uintptr_t) key * 0x9e3779b97f4a7c15ULL;
+	return (uint32_t) (h >> 32);
+}
+
+static int8_t
+default_comparator(const void * a, const void * b) {
+	if (a == b) {
+		return 0;
+	} else {
+		return a > b ? 1 : -1;
+	}
+}
+
+/* FNV-1a hash of a NUL terminated string, for caches keyed by strings */
+uint32_t
+lrucache_hash_string(const void * key) {
+	const unsigned char *s = key;
+	uint32_t h = 2166136261u;
+	while (*s != '\0') {
+		h = (h ^ *s++) * 16777619u;
+	}
+	return h;
+}
+
+/* Create a cache holding at most capacity entries.  hash and comp work on
+ * keys; if either is NULL the keys are hashed and compared by address.
+ *
+ * The cache, its entries, the deque nodes and the hash buckets are all
+ * allocated at once here, so get/put never allocate.  NULL is returned if
+ * memory cannot be allocated.
+ */
+LRUCache
+lrucache_create(uint32_t capacity, lrucache_hash_func_t hash,
+                lrucache_comparater_t comp) {
+	LRUCache c;
+	struct lrucache_entry_t *entries;
+	struct deque_node_t *nodes;
+	uint32_t i, number_buckets = 1;
+
+	assert(capacity > 0);
+	while (number_buckets < capacity) {
+		number_buckets <<= 1;
+	}
+	c = malloc(sizeof(struct lrucache_t)
+	           + capacity * sizeof(struct lrucache_entry_t)
+	           + capacity * sizeof(struct deque_node_t)
+	           + number_buckets * sizeof(struct lrucache_entry_t *));
+	if (c == NULL) {
+		return NULL;
+	}
+	entries = (struct lrucache_entry_t *) (c + 1);
+	nodes = (struct deque_node_t *) (entries + capacity);
+	c->buckets = (struct lrucache_entry_t **) (nodes + capacity);
+	c->bucket_mask = number_buckets - 1;
+	for (i = 0; i < number_buckets; i++) {
+		c->buckets[i] = NULL;
+	}
+	c->free_entries = NULL;
+	for (i = capacity; i > 0; i--) {
+		entries[i - 1].next = c->free_entries;
+		c->free_entries = &entries[i - 1];
+	}
+	deque_init_preallocated(&c->order, capacity, NULL, nodes);
+	c->hash_func = hash != NULL ? hash : default_hash;
+	c->compare_func = comp != NULL ? comp : default_comparator;
+	c->evict_func = NULL;
+	c->evict_arg = NULL;
+	return c;
+}
+
+/* Free the cache.  The keys and values are not freed. */
+void
+lrucache_free(LRUCache c) {
+	free(c);
+}
+
+/* Set a function to be called as func(key, value, arg) for every entry
+ * pushed out of a full cache by lrucache_put().  Passing NULL removes it.
+ */
+void
+lrucache_set_evict_func(LRUCache c, lrucache_evict_func_t func, void* arg) {
+	c->evict_func = func;
+	c->evict_arg = arg;
+}
+
+/* Find the bucket slot pointing at the entry for key, or at the NULL ending
+ * its chain if there is no such entry.
+ */
+static struct lrucache_entry_t **
+lrucache_lookup(LRUCache c, const void* key, uint32_t hash) {
+	struct lrucache_entry_t **slot = &c->buckets[hash & c->bucket_mask];
+	while (*slot != NULL) {
+		if ((*slot)->hash == hash && (c->compare_func)((*slot)->key, key) == 0) {
+			break;
+		}
+		slot = &(*slot)->next;
+	}
+	return slot;
+}
+
+/* Take an entry out of the hash table and the use order */
+static void
+lrucache_unlink(LRUCache c, struct lrucache_entry_t **slot) {
+	struct lrucache_entry_t *entry = *slot;
+	*slot = entry->next;
+	deque_remove_node(&c->order, entry->node);
+	entry->next = c->free_entries;
+	c->free_entries = entry;
+}
+
+/* Return the value cached for key, marking it as the most recently used
+ * entry, or NULL if key is not in the cache.  O(1) on average.
+ */
+void*
+lrucache_get(LRUCache c, const void* key) {
+	struct lrucache_entry_t *entry;
+	entry = *lrucache_lookup(c, key, (c->hash_func)(key));
+	if (entry == NULL) {
+		return NULL;
+	}
+	deque_move_to_back(&c->order, entry->node);
+	return entry->value;
+}
+
+/* Return the value cached for key without changing the use order */
+void*
+lrucache_peek(LRUCache c, const void* key) {
+	struct lrucache_entry_t *entry;
+	entry = *lrucache_lookup(c, key, (c->hash_func)(key));
+	return entry != NULL ? entry->value : NULL;
+}
+
+/* Cache value under key as the most recently used entry.  If key is already
+ * cached its value is replaced (the old value is not passed to the eviction
+ * callback).  If the cache is full the least recently used entry is evicted
+ * first.  O(1) on average.
+ */
+lrucache_result_t
+lrucache_put(LRUCache c, void* key, void* value) {
+	struct lrucache_entry_t **slot, *entry, *lru;
+	uint32_t hash = (c->hash_func)(key);
+
+	slot = lrucache_lookup(c, key, hash);
+	if ((entry = *slot) != NULL) {
+		entry->value = value;
+		deque_move_to_back(&c->order, entry->node);
+		return LRUCACHE_SUCCESS;
+	}
+
+	if (c->free_entries == NULL) {
+		lru = deque_peekleft(&c->order);
+		lrucache_unlink(c, lrucache_lookup(c, lru->key, lru->hash));
+		if (c->evict_func != NULL) {
+			(c->evict_func)(lru->key, lru->value, c->evict_arg);
+		}
+		/* the unlink may have changed the chain key hashes into */
+		slot = lrucache_lookup(c, key, hash);
+	}
+
+	entry = c->free_entries;
+	c->free_entries = entry->next;
+	entry->key = key;
+	entry->value = value;
+	entry->hash = hash;
+	if (deque_append_node(&c->order, entry, &entry->node) != DEQUE_SUCCESS) {
+		entry->next = c->free_entries;
+		c->free_entries = entry;
+		return LRUCACHE_FAILURE;
+	}
+	entry->next = NULL;
+	*slot = entry;
+	return LRUCACHE_SUCCESS;
+}
+
+/* Remove key from the cache and return its value, or NULL if it is not
+ * cached.  The eviction callback is not called.
+ */
+void*
+lrucache_remove(LRUCache c, const void* key) {
+	struct lrucache_entry_t **slot;
+	void* value;
+	slot = lrucache_lookup(c, key, (c->hash_func)(key));
+	if (*slot == NULL) {
+		return NULL;
+	}
+	value = (*slot)->value;
+	lrucache_unlink(c, slot);
+	return value;
+}
+
+/* Return the number of cached entries */
+uint32_t
+lrucache_count(LRUCache c) {
+	return deque_count(&c->order);
+}
+
+/* Return the maximum number of cached entries */
+uint32_t
+lrucache_capacity(LRUCache c) {
+	return deque_maxlen(&c->order);
+}
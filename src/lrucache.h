@@ -0,0 +1,78 @@
+/*
+ * lrucache.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <stdint.h>
+#include "deque.h"
+
+typedef enum {
+	LRUCACHE_SUCCESS = 0,
+	LRUCACHE_FAILURE = 1,
+	LRUCACHE_ALLOC_ERROR = 2
+} lrucache_result_t;
+
+typedef uint32_t(*lrucache_hash_func_t)(const void*);
+typedef int8_t(*lrucache_comparater_t)(const void*, const void*);
+typedef void(*lrucache_evict_func_t)(void*, void*, void*);
+
+struct lrucache_entry_t {
+	void* key;
+	void* value;
+	uint32_t hash;
+	DequeNode node;                 /* position in the use order */
+	struct lrucache_entry_t *next;  /* bucket chain or free list */
+};
+
+/* The entries are kept in a deque in order of use, least recently used at
+ * the left end, and hashed into chained buckets for lookup.  All storage is
+ * allocated by lrucache_create().
+ */
+struct lrucache_t {
+	struct deque_t order;
+	struct lrucache_entry_t **buckets;
+	uint32_t bucket_mask;
+	struct lrucache_entry_t *free_entries;
+	uint32_t(*hash_func)(const void *);
+	int8_t(*compare_func)(const void *, const void *);
+	void(*evict_func)(void *, void *, void *);
+	void *evict_arg;
+};
+
+typedef struct lrucache_t *LRUCache;
+
+LRUCache           lrucache_create(uint32_t capacity, lrucache_hash_func_t hash,
+                                   lrucache_comparater_t comp);
+void               lrucache_free(LRUCache c);
+void               lrucache_set_evict_func(LRUCache c, lrucache_evict_func_t func,
+                                           void* arg);
+void*              lrucache_get(LRUCache c, const void* key);
+void*              lrucache_peek(LRUCache c, const void* key);
+lrucache_result_t  lrucache_put(LRUCache c, void* key, void* value);
+void*              lrucache_remove(LRUCache c, const void* key);
+uint32_t           lrucache_count(LRUCache c);
+uint32_t           lrucache_capacity(LRUCache c);
+uint32_t           lrucache_hash_string(const void* key);
+#endif
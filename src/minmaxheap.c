@@ -0,0 +1,302 @@
+/*
+ * minmaxheap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A min-max heap (Atkinson et al.), a double ended priority queue in a
+ * plain array.  Levels alternate between min and max order, so the smallest
+ * item is at the root and the largest is one of its two children: both
+ * peeks are O(1) and popping from either end is O(log n).
+ *
+ * Like the ArrayList and RingDeque it either grows on demand or works in a
+ * fixed caller supplied buffer.  A fixed heap makes a bounded pool, and
+ * minmaxheap_push_evict() keeps the best items in it by throwing out the
+ * largest when it is full.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "minmaxheap.h"
+
+static int8_t
+default_comparator(const void * a, const void * b) {
+	if (a == b) {
+		return 0;
+	} else {
+		return a > b ? 1 : -1;
+	}
+}
+
+/* Create a min-max heap with memory allocated on the heap, starting with
+ * room for MINMAXHEAP_DEFAULT_SIZE items and doubling when full.
+ */
+MinMaxHeap
+minmaxheap_create(minmaxheap_comparater_t compare_func) {
+	return minmaxheap_create_size(MINMAXHEAP_DEFAULT_SIZE, compare_func);
+}
+
+/* Create a min-max heap with room for capacity items before it has to grow.
+ * Returns NULL if memory cannot be allocated.
+ */
+MinMaxHeap
+minmaxheap_create_size(uint32_t capacity, minmaxheap_comparater_t compare_func) {
+	MinMaxHeap h = malloc(sizeof(struct minmaxheap_t));
+	if (h == NULL) {
+		return NULL;
+	}
+	if (capacity == 0) {
+		capacity = MINMAXHEAP_DEFAULT_SIZE;
+	}
+	if ((h->buffer = malloc(capacity * sizeof(void*))) == NULL) {
+		free(h);
+		return NULL;
+	}
+	h->capacity = capacity;
+	h->number_items = 0;
+	h->heap_type = MINMAXHEAP_TYPE_EXPANDING;
+	h->compare_func = compare_func != NULL ? compare_func : default_comparator;
+	return h;
+}
+
+/* Initialize a min-max heap over a caller supplied buffer of capacity item
+ * pointers.  It never grows; pushing to a full heap returns
+ * MINMAXHEAP_FAILURE.  Such a heap must not be passed to minmaxheap_free().
+ */
+void
+minmaxheap_init_static(MinMaxHeap h, void **buffer, uint32_t capacity,
+                       minmaxheap_comparater_t compare_func) {
+	assert(h != NULL && buffer != NULL);
+	h->buffer = buffer;
+	h->capacity = capacity;
+	h->number_items = 0;
+	h->heap_type = MINMAXHEAP_TYPE_FIXED;
+	h->compare_func = compare_func != NULL ? compare_func : default_comparator;
+}
+
+/* Free a heap created with minmaxheap_create() and its buffer.  The items
+ * referenced are not freed.
+ */
+void
+minmaxheap_free(MinMaxHeap h) {
+	free(h->buffer);
+	free(h);
+}
+
+/* Return true if pos is on a min level */
+static bool
+minmaxheap_min_level(uint32_t pos) {
+	uint32_t level = 0;
+	for (pos++; pos > 1; pos >>= 1) {
+		level++;
+	}
+	return level % 2 == 0;
+}
+
+/* Compare two items the way a level wants them ordered: on a min level
+ * "before" means smaller, on a max level larger.
+ */
+static bool
+minmaxheap_before(MinMaxHeap h, void* a, void* b, bool min) {
+	int8_t cmp = (h->compare_func)(a, b);
+	return min ? cmp < 0 : cmp > 0;
+}
+
+static void
+minmaxheap_swap(MinMaxHeap h, uint32_t a, uint32_t b) {
+	void *t = h->buffer[a];
+	h->buffer[a] = h->buffer[b];
+	h->buffer[b] = t;
+}
+
+/* Move the item at pos up through the levels of its own kind */
+static void
+minmaxheap_bubble_up_levels(MinMaxHeap h, uint32_t pos, bool min) {
+	uint32_t grandparent;
+	while (pos > 2) {
+		grandparent = ((pos - 1) / 2 - 1) / 2;
+		if (!minmaxheap_before(h, h->buffer[pos], h->buffer[grandparent], min)) {
+			break;
+		}
+		minmaxheap_swap(h, pos, grandparent);
+		pos = grandparent;
+	}
+}
+
+/* Restore the heap after a new item was placed at pos */
+static void
+minmaxheap_bubble_up(MinMaxHeap h, uint32_t pos) {
+	bool min = minmaxheap_min_level(pos);
+	uint32_t parent;
+	if (pos > 0) {
+		parent = (pos - 1) / 2;
+		/* out of order with its parent: it belongs to the other kind */
+		if (minmaxheap_before(h, h->buffer[pos], h->buffer[parent], !min)) {
+			minmaxheap_swap(h, pos, parent);
+			pos = parent;
+			min = !min;
+		}
+	}
+	minmaxheap_bubble_up_levels(h, pos, min);
+}
+
+/* Restore the heap after the item at pos was replaced.  The new item sinks
+ * by grandchildren, swapping with its parent on the way whenever it is out
+ * of order with the level above.
+ */
+static void
+minmaxheap_trickle_down(MinMaxHeap h, uint32_t pos) {
+	bool min = minmaxheap_min_level(pos);
+	uint32_t n = h->number_items, first, best, i, end;
+
+	for (;;) {
+		first = 2 * pos + 1;
+		if (first >= n) {
+			return;
+		}
+		/* the best of the children and grandchildren */
+		best = first;
+		if (first + 1 < n && minmaxheap_before(h, h->buffer[first + 1], h->buffer[best], min)) {
+			best = first + 1;
+		}
+		end = 4 * pos + 7 < n ? 4 * pos + 7 : n;
+		for (i = 4 * pos + 3; i < end; i++) {
+			if (minmaxheap_before(h, h->buffer[i], h->buffer[best], min)) {
+				best = i;
+			}
+		}
+		if (!minmaxheap_before(h, h->buffer[best], h->buffer[pos], min)) {
+			return;
+		}
+		minmaxheap_swap(h, pos, best);
+		if (best <= first + 1) {
+			return; /* a child: nothing below it can be out of order */
+		}
+		if (minmaxheap_before(h, h->buffer[(best - 1) / 2], h->buffer[best], min)) {
+			minmaxheap_swap(h, best, (best - 1) / 2);
+		}
+		pos = best;
+	}
+}
+
+static minmaxheap_result_t
+minmaxheap_memcheck(MinMaxHeap h) {
+	void **newBuffer;
+	if (h->number_items < h->capacity) {
+		return MINMAXHEAP_SUCCESS;
+	}
+	if (h->heap_type == MINMAXHEAP_TYPE_FIXED) {
+		return MINMAXHEAP_FAILURE;
+	}
+	if ((newBuffer = realloc(h->buffer, 2 * h->capacity * sizeof(void*))) == NULL) {
+		return MINMAXHEAP_ALLOC_ERROR;
+	}
+	h->buffer = newBuffer;
+	h->capacity *= 2;
+	return MINMAXHEAP_SUCCESS;
+}
+
+/* Add an item.  O(log n).  A full fixed size heap returns
+ * MINMAXHEAP_FAILURE.
+ */
+minmaxheap_result_t
+minmaxheap_push(MinMaxHeap h, void* item) {
+	minmaxheap_result_t result;
+	if ((result = minmaxheap_memcheck(h)) != MINMAXHEAP_SUCCESS) {
+		return result;
+	}
+	h->buffer[h->number_items] = item;
+	minmaxheap_bubble_up(h, h->number_items++);
+	return MINMAXHEAP_SUCCESS;
+}
+
+/* Index of the largest item; the heap must not be empty */
+static uint32_t
+minmaxheap_max_index(MinMaxHeap h) {
+	if (h->number_items <= 2) {
+		return h->number_items - 1;
+	}
+	return (h->compare_func)(h->buffer[1], h->buffer[2]) >= 0 ? 1 : 2;
+}
+
+/* Remove the item at pos, filling the hole with the last item */
+static void*
+minmaxheap_take(MinMaxHeap h, uint32_t pos) {
+	void* item = h->buffer[pos];
+	h->number_items--;
+	if (pos < h->number_items) {
+		h->buffer[pos] = h->buffer[h->number_items];
+		minmaxheap_trickle_down(h, pos);
+	}
+	return item;
+}
+
+/* Push item into a heap that may be full.  If there is room (or the heap
+ * can grow) the item is added and NULL returned.  Otherwise the largest of
+ * the items and the new one is dropped and returned, so a fixed heap keeps
+ * the capacity smallest items it has seen.  O(log n).
+ */
+void*
+minmaxheap_push_evict(MinMaxHeap h, void* item) {
+	uint32_t pos;
+	void* evicted;
+	if (minmaxheap_push(h, item) == MINMAXHEAP_SUCCESS) {
+		return NULL;
+	}
+	if (h->number_items == 0) {
+		return item;
+	}
+	pos = minmaxheap_max_index(h);
+	if ((h->compare_func)(item, h->buffer[pos]) >= 0) {
+		return item;
+	}
+	evicted = minmaxheap_take(h, pos);
+	minmaxheap_push(h, item);
+	return evicted;
+}
+
+/* Return the smallest item, or NULL if empty.  O(1). */
+void*
+minmaxheap_peek_min(MinMaxHeap h) {
+	return h->number_items > 0 ? h->buffer[0] : NULL;
+}
+
+/* Return the largest item, or NULL if empty.  O(1). */
+void*
+minmaxheap_peek_max(MinMaxHeap h) {
+	return h->number_items > 0 ? h->buffer[minmaxheap_max_index(h)] : NULL;
+}
+
+/* Remove and return the smallest item, or NULL if empty.  O(log n). */
+void*
+minmaxheap_pop_min(MinMaxHeap h) {
+	return h->number_items > 0 ? minmaxheap_take(h, 0) : NULL;
+}
+
+/* Remove and return the largest item, or NULL if empty.  O(log n). */
+void*
+minmaxheap_pop_max(MinMaxHeap h) {
+	return h->number_items > 0 ? minmaxheap_take(h, minmaxheap_max_index(h)) : NULL;
+}
+
+/* Return the number of items in the heap */
+uint32_t
+minmaxheap_count(MinMaxHeap h) {
+	return h->number_items;
+}
@@ -0,0 +1,67 @@
+/*
+ * minmaxheap.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MINMAXHEAP_H
+#define MINMAXHEAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MINMAXHEAP_TYPE_FIXED 0x00
+#define MINMAXHEAP_TYPE_EXPANDING 0x01
+#define MINMAXHEAP_DEFAULT_SIZE (16)
+
+typedef enum {
+	MINMAXHEAP_SUCCESS = 0,
+	MINMAXHEAP_FAILURE = 1,
+	MINMAXHEAP_ALLOC_ERROR = 2
+} minmaxheap_result_t;
+
+/* Items on even levels of the tree (the root is level 0) are no greater
+ * than any of their descendants, and items on odd levels no smaller.
+ */
+struct minmaxheap_t {
+	void **buffer;
+	uint32_t capacity;
+	uint32_t number_items;
+	uint8_t heap_type;
+	int8_t(*compare_func)(const void *, const void *);
+};
+
+typedef struct minmaxheap_t *MinMaxHeap;
+typedef int8_t(*minmaxheap_comparater_t)(const void*, const void*);
+
+MinMaxHeap           minmaxheap_create(minmaxheap_comparater_t comp);
+MinMaxHeap           minmaxheap_create_size(uint32_t capacity, minmaxheap_comparater_t comp);
+void                 minmaxheap_init_static(MinMaxHeap h, void **buffer, uint32_t capacity,
+                                            minmaxheap_comparater_t comp);
+void                 minmaxheap_free(MinMaxHeap h);
+minmaxheap_result_t  minmaxheap_push(MinMaxHeap h, void* item);
+void*                minmaxheap_push_evict(MinMaxHeap h, void* item);
+void*                minmaxheap_peek_min(MinMaxHeap h);
+void*                minmaxheap_peek_max(MinMaxHeap h);
+void*                minmaxheap_pop_min(MinMaxHeap h);
+void*                minmaxheap_pop_max(MinMaxHeap h);
+uint32_t             minmaxheap_count(MinMaxHeap h);
+#endif
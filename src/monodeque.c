@@ -0,0 +1,184 @@
+/*
+ * monodeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A monotonic deque for sliding window minimums and maximums.
+ *
+ * Each sample is pushed with its position in the stream (a sample number or
+ * a timestamp).  A push first drops every newer sample it beats, since those
+ * can never be the window's extreme while the new one is in the window, and
+ * monodeque_expire() drops samples that have left the window from the other
+ * end.  The extreme is then always the leftmost entry.  Every sample is
+ * pushed and dropped at most once, so a window of any size costs O(1)
+ * amortized per sample:
+ *
+ *     for (i = 0; i < n; i++) {
+ *         monodeque_push(m, samples[i], i);
+ *         monodeque_expire(m, i + 1 - width);    (once i + 1 >= width)
+ *         window_min[i] = monodeque_front(m);
+ *     }
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "monodeque.h"
+
+static int8_t
+default_comparator(const void * a, const void * b) {
+	if (a == b) {
+		return 0;
+	} else {
+		return a > b ? 1 : -1;
+	}
+}
+
+/* Create a monotonic deque tracking the minimum (MONODEQUE_MIN) or maximum
+ * (MONODEQUE_MAX) of a sliding window, ordering samples with comp (or by
+ * address if comp is NULL).
+ *
+ * capacity bounds the number of samples alive at once; for a window of w
+ * samples it should be w.  The entries and their deque nodes are allocated
+ * here, so pushing never allocates.  NULL is returned if memory cannot be
+ * allocated.
+ */
+MonoDeque
+monodeque_create(uint32_t capacity, monodeque_kind_t kind, monodeque_comparater_t comp) {
+	MonoDeque m;
+	struct monodeque_entry_t *entries;
+	uint32_t i;
+
+	assert(capacity > 0);
+	m = malloc(sizeof(struct monodeque_t)
+	           + capacity * sizeof(struct monodeque_entry_t)
+	           + capacity * sizeof(struct deque_node_t));
+	if (m == NULL) {
+		return NULL;
+	}
+	entries = (struct monodeque_entry_t *) (m + 1);
+	m->free_entries = NULL;
+	for (i = capacity; i > 0; i--) {
+		entries[i - 1].next_free = m->free_entries;
+		m->free_entries = &entries[i - 1];
+	}
+	deque_init_preallocated(&m->window, capacity, NULL,
+	                        (struct deque_node_t *) (entries + capacity));
+	m->capacity = capacity;
+	m->pushed = 0;
+	m->kind = kind;
+	m->compare_func = comp != NULL ? comp : default_comparator;
+	return m;
+}
+
+/* Free the monotonic deque.  The samples are not freed. */
+void
+monodeque_free(MonoDeque m) {
+	free(m);
+}
+
+static void
+monodeque_release(MonoDeque m, struct monodeque_entry_t *entry) {
+	entry->next_free = m->free_entries;
+	m->free_entries = entry;
+}
+
+/* Return true if a sample compared as cmp against a newer one can never be
+ * the extreme again, i.e. the newer one is at least as good.
+ */
+static bool
+monodeque_dominated(MonoDeque m, int8_t cmp) {
+	return m->kind == MONODEQUE_MIN ? cmp >= 0 : cmp <= 0;
+}
+
+/* Add a sample at position pos, which must not be less than the position of
+ * the previous sample.  O(1) amortized.
+ *
+ * Samples pushed capacity or more pushes ago are dropped first, so a caller
+ * that never expires gets a window of the last capacity pushes.
+ */
+monodeque_result_t
+monodeque_push(MonoDeque m, void* item, uint64_t pos) {
+	struct monodeque_entry_t *entry;
+
+	while ((entry = deque_peekleft(&m->window)) != NULL
+	       && entry->seq + m->capacity <= m->pushed) {
+		monodeque_release(m, deque_popleft(&m->window));
+	}
+	while ((entry = deque_peek(&m->window)) != NULL
+	       && monodeque_dominated(m, (m->compare_func)(entry->item, item))) {
+		monodeque_release(m, deque_pop(&m->window));
+	}
+	entry = m->free_entries;
+	m->free_entries = entry->next_free;
+	entry->item = item;
+	entry->pos = pos;
+	entry->seq = m->pushed++;
+	if (deque_append(&m->window, entry) != DEQUE_SUCCESS) {
+		monodeque_release(m, entry);
+		return MONODEQUE_FAILURE;
+	}
+	return MONODEQUE_SUCCESS;
+}
+
+/* Drop the samples whose position is before upto, i.e. those that have
+ * slid out of a window starting at upto.  Returns the number dropped.
+ */
+uint32_t
+monodeque_expire(MonoDeque m, uint64_t upto) {
+	struct monodeque_entry_t *entry;
+	uint32_t dropped = 0;
+	while ((entry = deque_peekleft(&m->window)) != NULL && entry->pos < upto) {
+		monodeque_release(m, deque_popleft(&m->window));
+		dropped++;
+	}
+	return dropped;
+}
+
+/* Return the minimum (or maximum) sample in the window, or NULL if no
+ * samples are alive.  O(1).
+ */
+void*
+monodeque_front(MonoDeque m) {
+	struct monodeque_entry_t *entry = deque_peekleft(&m->window);
+	return entry != NULL ? entry->item : NULL;
+}
+
+/* Return the position of the sample returned by monodeque_front(), or 0 if
+ * no samples are alive.
+ */
+uint64_t
+monodeque_front_pos(MonoDeque m) {
+	struct monodeque_entry_t *entry = deque_peekleft(&m->window);
+	return entry != NULL ? entry->pos : 0;
+}
+
+/* Return the number of samples kept, which is at most the window size */
+uint32_t
+monodeque_count(MonoDeque m) {
+	return deque_count(&m->window);
+}
+
+/* Drop all samples */
+void
+monodeque_clear(MonoDeque m) {
+	while (deque_count(&m->window) > 0) {
+		monodeque_release(m, deque_popleft(&m->window));
+	}
+}
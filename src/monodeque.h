@@ -0,0 +1,73 @@
+/*
+ * monodeque.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MONODEQUE_H
+#define MONODEQUE_H
+
+#include <stdint.h>
+#include "deque.h"
+
+typedef enum {
+	MONODEQUE_SUCCESS = 0,
+	MONODEQUE_FAILURE = 1,
+	MONODEQUE_ALLOC_ERROR = 2
+} monodeque_result_t;
+
+typedef enum {
+	MONODEQUE_MIN = 0,
+	MONODEQUE_MAX = 1
+} monodeque_kind_t;
+
+struct monodeque_entry_t {
+	void* item;
+	uint64_t pos;
+	uint64_t seq;
+	struct monodeque_entry_t *next_free;
+};
+
+/* The entries in window run from oldest (left) to newest (right) and are
+ * strictly monotonic, so the minimum (or maximum) is always leftmost.
+ */
+struct monodeque_t {
+	struct deque_t window;
+	struct monodeque_entry_t *free_entries;
+	uint32_t capacity;
+	uint64_t pushed;
+	monodeque_kind_t kind;
+	int8_t(*compare_func)(const void *, const void *);
+};
+
+typedef struct monodeque_t *MonoDeque;
+typedef int8_t(*monodeque_comparater_t)(const void*, const void*);
+
+MonoDeque           monodeque_create(uint32_t capacity, monodeque_kind_t kind,
+                                     monodeque_comparater_t comp);
+void                monodeque_free(MonoDeque m);
+monodeque_result_t  monodeque_push(MonoDeque m, void* item, uint64_t pos);
+uint32_t            monodeque_expire(MonoDeque m, uint64_t upto);
+void*               monodeque_front(MonoDeque m);
+uint64_t            monodeque_front_pos(MonoDeque m);
+uint32_t            monodeque_count(MonoDeque m);
+void                monodeque_clear(MonoDeque m);
+#endif
@@ -0,0 +1,225 @@
+/*
+ * mpmcqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A bounded multi-producer/multi-consumer queue after Dmitry Vyukov's
+ * sequence-numbered ring.
+ *
+ * Producers and consumers each claim positions with a CAS on their own
+ * counter, and then hand the cell over through its sequence number, so a
+ * producer and a consumer never touch the same counter.  Items are pointers
+ * and NULL is reserved to mean "empty".
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "mpmcqueue.h"
+
+/* Initialize a queue that has already been allocated.  The capacity is
+ * rounded up to the next power of two.
+ */
+mpmcqueue_result_t
+mpmcqueue_init(MPMCQueue q, uint32_t capacity) {
+	size_t size = 2;
+	size_t i;
+	assert(q != NULL);
+	while (size < capacity) {
+		size <<= 1;
+	}
+	if ((q->cells = malloc(size * sizeof(struct mpmcqueue_cell_t))) == NULL) {
+		return MPMCQUEUE_ALLOC_ERROR;
+	}
+	for (i = 0; i < size; i++) {
+		atomic_init(&q->cells[i].sequence, i);
+		q->cells[i].value = NULL;
+	}
+	q->mask = size - 1;
+	atomic_init(&q->enqueue_pos, 0);
+	atomic_init(&q->dequeue_pos, 0);
+	return MPMCQUEUE_SUCCESS;
+}
+
+/* Create a queue able to hold at least capacity items, or NULL if memory
+ * could not be allocated.
+ */
+MPMCQueue
+mpmcqueue_create(uint32_t capacity) {
+	MPMCQueue q = aligned_alloc(MPMCQUEUE_CACHE_LINE, sizeof(struct mpmcqueue_t));
+	if (q != NULL && mpmcqueue_init(q, capacity) != MPMCQUEUE_SUCCESS) {
+		free(q);
+		q = NULL;
+	}
+	return q;
+}
+
+/* Release the ring owned by a queue initialized with mpmcqueue_init() */
+void
+mpmcqueue_destroy(MPMCQueue q) {
+	free(q->cells);
+	q->cells = NULL;
+}
+
+/* Free a queue allocated with mpmcqueue_create() */
+void
+mpmcqueue_free(MPMCQueue q) {
+	mpmcqueue_destroy(q);
+	free(q);
+}
+
+/* Claim up to n consecutive positions on counter pos.  A cell at position
+ * p is ready when its sequence equals p + offset (0 for producers, 1 for
+ * consumers).  Only the thread that owns position p can move the cell's
+ * sequence on, so cells seen as ready stay ready until the CAS on pos
+ * hands them to us.
+ *
+ * Returns the number of positions claimed and stores the first in *first.
+ */
+static uint32_t
+mpmcqueue_claim(MPMCQueue q, atomic_size_t *pos, size_t offset,
+                uint32_t n, size_t *first) {
+	struct mpmcqueue_cell_t *cell;
+	size_t p, seq;
+	intptr_t diff;
+	uint32_t ready;
+
+	p = atomic_load_explicit(pos, memory_order_relaxed);
+	for (;;) {
+		for (ready = 0; ready < n; ready++) {
+			cell = &q->cells[(p + ready) & q->mask];
+			seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+			if (seq != p + ready + offset) {
+				break;
+			}
+		}
+		if (ready == 0) {
+			cell = &q->cells[p & q->mask];
+			seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+			diff = (intptr_t) seq - (intptr_t) (p + offset);
+			if (diff < 0) {
+				return 0; /* full (producers) or empty (consumers) */
+			}
+			if (diff == 0) {
+				continue; /* became ready while we looked */
+			}
+			/* someone else claimed p, catch up */
+			p = atomic_load_explicit(pos, memory_order_relaxed);
+			continue;
+		}
+		if (atomic_compare_exchange_weak_explicit(pos, &p, p + ready,
+				memory_order_relaxed, memory_order_relaxed)) {
+			*first = p;
+			return ready;
+		}
+	}
+}
+
+/* Enqueue an item if there is room.  Safe to call from any thread.
+ *
+ * Returns MPMCQUEUE_FULL if the queue is full.  This operation is O(1) and
+ * lock-free.
+ */
+mpmcqueue_result_t
+mpmcqueue_try_enqueue(MPMCQueue q, void* item) {
+	return mpmcqueue_enqueue_batch(q, &item, 1) == 1 ? MPMCQUEUE_SUCCESS
+		: MPMCQUEUE_FULL;
+}
+
+/* Dequeue the oldest item.  Safe to call from any thread.
+ *
+ * Returns NULL if the queue is empty.  This operation is O(1) and
+ * lock-free.
+ */
+void*
+mpmcqueue_try_dequeue(MPMCQueue q) {
+	void* item;
+	return mpmcqueue_dequeue_batch(q, &item, 1) == 1 ? item : NULL;
+}
+
+/* Enqueue up to n items from an array, claiming all of their positions
+ * with a single CAS.  Safe to call from any thread.
+ *
+ * Returns the number of items enqueued, which is less than n only if the
+ * queue filled up.  Items that were enqueued keep their relative order.
+ */
+uint32_t
+mpmcqueue_enqueue_batch(MPMCQueue q, void** items, uint32_t n) {
+	struct mpmcqueue_cell_t *cell;
+	size_t first;
+	uint32_t i, claimed, done = 0;
+
+	while (done < n) {
+		claimed = mpmcqueue_claim(q, &q->enqueue_pos, 0, n - done, &first);
+		if (claimed == 0) {
+			break;
+		}
+		for (i = 0; i < claimed; i++) {
+			cell = &q->cells[(first + i) & q->mask];
+			cell->value = items[done + i];
+			atomic_store_explicit(&cell->sequence, first + i + 1,
+				memory_order_release);
+		}
+		done += claimed;
+	}
+	return done;
+}
+
+/* Dequeue up to n items into an array, claiming all of their positions
+ * with a single CAS.  Safe to call from any thread.
+ *
+ * Returns the number of items dequeued, 0 if the queue was empty.
+ */
+uint32_t
+mpmcqueue_dequeue_batch(MPMCQueue q, void** items, uint32_t n) {
+	struct mpmcqueue_cell_t *cell;
+	size_t first;
+	uint32_t i, claimed, done = 0;
+
+	while (done < n) {
+		claimed = mpmcqueue_claim(q, &q->dequeue_pos, 1, n - done, &first);
+		if (claimed == 0) {
+			break;
+		}
+		for (i = 0; i < claimed; i++) {
+			cell = &q->cells[(first + i) & q->mask];
+			items[done + i] = cell->value;
+			atomic_store_explicit(&cell->sequence, first + i + q->mask + 1,
+				memory_order_release);
+		}
+		done += claimed;
+	}
+	return done;
+}
+
+/* Return the number of items in the queue.  When other threads are active
+ * this is only a snapshot.
+ */
+uint32_t
+mpmcqueue_count(MPMCQueue q) {
+	size_t head = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+	return tail > head ? (uint32_t) (tail - head) : 0;
+}
+
+/* Return the number of items the queue can hold */
+uint32_t
+mpmcqueue_capacity(MPMCQueue q) {
+	return (uint32_t) (q->mask + 1);
+}
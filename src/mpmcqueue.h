@@ -0,0 +1,70 @@
+/*
+ * mpmcqueue.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifndef MPMCQUEUE_CACHE_LINE
+#define MPMCQUEUE_CACHE_LINE (64)
+#endif
+
+typedef enum {
+	MPMCQUEUE_SUCCESS = 0,
+	MPMCQUEUE_FULL = 1,
+	MPMCQUEUE_ALLOC_ERROR = 2
+} mpmcqueue_result_t;
+
+/* Each cell carries a sequence number that says whose turn it is: equal
+ * to the position when a producer may write it, position + 1 when a
+ * consumer may read it.
+ */
+struct mpmcqueue_cell_t {
+	atomic_size_t sequence;
+	void* value;
+};
+
+struct mpmcqueue_t {
+	_Alignas(MPMCQUEUE_CACHE_LINE) struct mpmcqueue_cell_t *cells;
+	size_t mask;
+	_Alignas(MPMCQUEUE_CACHE_LINE) atomic_size_t enqueue_pos;
+	_Alignas(MPMCQUEUE_CACHE_LINE) atomic_size_t dequeue_pos;
+};
+
+typedef struct mpmcqueue_t *MPMCQueue;
+
+MPMCQueue           mpmcqueue_create(uint32_t capacity);
+mpmcqueue_result_t  mpmcqueue_init(MPMCQueue q, uint32_t capacity);
+void                mpmcqueue_destroy(MPMCQueue q);
+void                mpmcqueue_free(MPMCQueue q);
+mpmcqueue_result_t  mpmcqueue_try_enqueue(MPMCQueue q, void* item);
+void*               mpmcqueue_try_dequeue(MPMCQueue q);
+uint32_t            mpmcqueue_enqueue_batch(MPMCQueue q, void** items, uint32_t n);
+uint32_t            mpmcqueue_dequeue_batch(MPMCQueue q, void** items, uint32_t n);
+uint32_t            mpmcqueue_count(MPMCQueue q);
+uint32_t            mpmcqueue_capacity(MPMCQueue q);
+#endif
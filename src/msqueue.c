@@ -0,0 +1,375 @@
+/*
+ * msqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * An unbounded lock-free queue (Michael and Scott, "Simple, Fast, and
+ * Practical Non-Blocking and Blocking Concurrent Queue Algorithms", PODC 1996)
+ * with hazard pointers (Michael, "Hazard Pointers: Safe Memory Reclamation
+ * for Lock-Free Objects", IEEE TPDS 2004) for memory reclamation.
+ *
+ * Each thread using the queue attaches once with msqueue_attach() and passes
+ * the returned handle to every call.  A dequeued node is only recycled once no
+ * thread has it in a hazard pointer, so a node is never reused while another
+ * thread may still read it.  Recycled nodes go to the retiring thread's pool,
+ * and pools spill over into a shared pool in batches so that a producer
+ * thread can reuse nodes retired by a consumer thread.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "msqueue.h"
+
+/* Take a node from the thread's pool, refilling it from the shared pool in
+ * one batch if needed, and only then fall back on malloc().
+ */
+static struct msqueue_node_t *
+msqueue_alloc_node(MSQueue q, MSQueueThread t) {
+	struct msqueue_node_t *node;
+	uint32_t i;
+
+	if (t->pool == NULL &&
+			atomic_load_explicit(&q->number_pooled, memory_order_relaxed) > 0) {
+		pthread_mutex_lock(&q->pool_lock);
+		for (i = 0; i < MSQUEUE_POOL_BATCH && q->pool != NULL; i++) {
+			node = q->pool;
+			q->pool = atomic_load_explicit(&node->next, memory_order_relaxed);
+			atomic_fetch_sub_explicit(&q->number_pooled, 1, memory_order_relaxed);
+			atomic_store_explicit(&node->next, t->pool, memory_order_relaxed);
+			t->pool = node;
+			t->number_pooled++;
+		}
+		pthread_mutex_unlock(&q->pool_lock);
+	}
+	if ((node = t->pool) != NULL) {
+		t->pool = atomic_load_explicit(&node->next, memory_order_relaxed);
+		t->number_pooled--;
+	} else {
+		node = malloc(sizeof(struct msqueue_node_t));
+	}
+	return node;
+}
+
+/* Move up to n nodes from the thread's pool to the shared pool */
+static void
+msqueue_spill_pool(MSQueue q, MSQueueThread t, uint32_t n) {
+	struct msqueue_node_t *node;
+	pthread_mutex_lock(&q->pool_lock);
+	while (n-- > 0 && (node = t->pool) != NULL) {
+		t->pool = atomic_load_explicit(&node->next, memory_order_relaxed);
+		t->number_pooled--;
+		atomic_store_explicit(&node->next, q->pool, memory_order_relaxed);
+		q->pool = node;
+		atomic_fetch_add_explicit(&q->number_pooled, 1, memory_order_relaxed);
+	}
+	pthread_mutex_unlock(&q->pool_lock);
+}
+
+/* Return a node that is no longer reachable by any thread to the pool */
+static void
+msqueue_recycle_node(MSQueue q, MSQueueThread t, struct msqueue_node_t *node) {
+	atomic_store_explicit(&node->next, t->pool, memory_order_relaxed);
+	t->pool = node;
+	t->number_pooled++;
+	if (t->number_pooled >= 2 * MSQUEUE_POOL_BATCH) {
+		msqueue_spill_pool(q, t, MSQUEUE_POOL_BATCH);
+	}
+}
+
+/* Recycle every retired node that is not protected by a hazard pointer.
+ *
+ * This is O(R * H) where R is the number of retired nodes and H the total
+ * number of hazard pointers, but it only runs once R has grown past a
+ * multiple of H, which makes the amortized cost per retired node O(H).
+ */
+static void
+msqueue_scan(MSQueue q, MSQueueThread t) {
+	struct msqueue_thread_t *other;
+	struct msqueue_node_t *node;
+	uint32_t i, j, kept = 0;
+	bool hazardous;
+
+	for (i = 0; i < t->number_retired; i++) {
+		node = t->retired[i];
+		hazardous = false;
+		other = atomic_load(&q->threads);
+		while (other != NULL && !hazardous) {
+			for (j = 0; j < MSQUEUE_HAZARDS; j++) {
+				if (atomic_load(&other->hazards[j]) == node) {
+					hazardous = true;
+				}
+			}
+			other = other->next;
+		}
+		if (hazardous) {
+			t->retired[kept++] = node;
+		} else {
+			msqueue_recycle_node(q, t, node);
+		}
+	}
+	t->number_retired = kept;
+}
+
+/* Retire a node that has just been unlinked from the queue */
+static void
+msqueue_retire_node(MSQueue q, MSQueueThread t, struct msqueue_node_t *node) {
+	uint32_t threshold;
+	struct msqueue_node_t **retired;
+
+	threshold = 2 * MSQUEUE_HAZARDS * atomic_load(&q->number_threads);
+	if (threshold < MSQUEUE_POOL_BATCH) {
+		threshold = MSQUEUE_POOL_BATCH;
+	}
+	if (t->number_retired == t->retired_capacity) {
+		retired = realloc(t->retired,
+			(t->retired_capacity + threshold) * sizeof(struct msqueue_node_t*));
+		if (retired == NULL) {
+			/* can't track it, scan to make room and try again */
+			msqueue_scan(q, t);
+			if (t->number_retired == t->retired_capacity) {
+				return; /* leak the node rather than risk reusing it */
+			}
+		} else {
+			t->retired = retired;
+			t->retired_capacity += threshold;
+		}
+	}
+	t->retired[t->number_retired++] = node;
+	if (t->number_retired >= threshold) {
+		msqueue_scan(q, t);
+	}
+}
+
+/* Initialize a queue that has already been allocated */
+msqueue_result_t
+msqueue_init(MSQueue q) {
+	struct msqueue_node_t *dummy;
+	assert(q != NULL);
+	if ((dummy = malloc(sizeof(struct msqueue_node_t))) == NULL) {
+		return MSQUEUE_ALLOC_ERROR;
+	}
+	dummy->value = NULL;
+	atomic_init(&dummy->next, NULL);
+	atomic_init(&q->head, dummy);
+	atomic_init(&q->tail, dummy);
+	atomic_init(&q->threads, NULL);
+	atomic_init(&q->number_threads, 0);
+	pthread_mutex_init(&q->pool_lock, NULL);
+	q->pool = NULL;
+	atomic_init(&q->number_pooled, 0);
+	return MSQUEUE_SUCCESS;
+}
+
+/* Create a queue and return a reference, or NULL if memory could not be
+ * allocated.
+ */
+MSQueue
+msqueue_create(void) {
+	MSQueue q = malloc(sizeof(struct msqueue_t));
+	if (q != NULL && msqueue_init(q) != MSQUEUE_SUCCESS) {
+		free(q);
+		q = NULL;
+	}
+	return q;
+}
+
+static void
+msqueue_free_chain(struct msqueue_node_t *node) {
+	struct msqueue_node_t *next;
+	while (node != NULL) {
+		next = atomic_load_explicit(&node->next, memory_order_relaxed);
+		free(node);
+		node = next;
+	}
+}
+
+/* Release every node and thread record owned by the queue.  No thread may
+ * be using the queue when this is called; the items still in the queue are
+ * not freed.
+ */
+void
+msqueue_destroy(MSQueue q) {
+	struct msqueue_thread_t *t, *next;
+	uint32_t i;
+
+	msqueue_free_chain(atomic_load(&q->head));
+	for (t = atomic_load(&q->threads); t != NULL; t = next) {
+		next = t->next;
+		for (i = 0; i < t->number_retired; i++) {
+			free(t->retired[i]);
+		}
+		free(t->retired);
+		msqueue_free_chain(t->pool);
+		free(t);
+	}
+	msqueue_free_chain(q->pool);
+	pthread_mutex_destroy(&q->pool_lock);
+}
+
+/* Free a queue allocated with msqueue_create() */
+void
+msqueue_free(MSQueue q) {
+	msqueue_destroy(q);
+	free(q);
+}
+
+/* Register the calling thread with the queue.  The returned handle must be
+ * passed to msqueue_enqueue()/msqueue_dequeue() and only used by this
+ * thread until msqueue_detach().  Returns NULL if memory could not be
+ * allocated.
+ */
+MSQueueThread
+msqueue_attach(MSQueue q) {
+	struct msqueue_thread_t *t;
+	struct msqueue_thread_t *head;
+	bool expected;
+	uint32_t i;
+
+	/* reuse a record left behind by a detached thread */
+	for (t = atomic_load(&q->threads); t != NULL; t = t->next) {
+		expected = false;
+		if (!atomic_load(&t->active) &&
+				atomic_compare_exchange_strong(&t->active, &expected, true)) {
+			return t;
+		}
+	}
+
+	if ((t = malloc(sizeof(struct msqueue_thread_t))) == NULL) {
+		return NULL;
+	}
+	for (i = 0; i < MSQUEUE_HAZARDS; i++) {
+		atomic_init(&t->hazards[i], NULL);
+	}
+	atomic_init(&t->active, true);
+	t->retired = NULL;
+	t->number_retired = 0;
+	t->retired_capacity = 0;
+	t->pool = NULL;
+	t->number_pooled = 0;
+
+	head = atomic_load(&q->threads);
+	do {
+		t->next = head;
+	} while (!atomic_compare_exchange_weak(&q->threads, &head, t));
+	atomic_fetch_add(&q->number_threads, 1);
+	return t;
+}
+
+/* Unregister a thread.  Whatever it could recycle is recycled, its node
+ * pool goes to the shared pool and the record is kept for reuse.
+ */
+void
+msqueue_detach(MSQueue q, MSQueueThread t) {
+	uint32_t i;
+	for (i = 0; i < MSQUEUE_HAZARDS; i++) {
+		atomic_store(&t->hazards[i], NULL);
+	}
+	msqueue_scan(q, t);
+	msqueue_spill_pool(q, t, t->number_pooled);
+	atomic_store(&t->active, false);
+}
+
+/* Append an item to the tail of the queue.
+ *
+ * This operation is lock-free and O(1) apart from contention; it only
+ * calls malloc() when neither the thread's pool nor the shared pool has a
+ * free node.
+ */
+msqueue_result_t
+msqueue_enqueue(MSQueue q, MSQueueThread t, void* item) {
+	struct msqueue_node_t *node, *tail, *next;
+
+	if ((node = msqueue_alloc_node(q, t)) == NULL) {
+		return MSQUEUE_ALLOC_ERROR;
+	}
+	node->value = item;
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+
+	for (;;) {
+		tail = atomic_load(&q->tail);
+		atomic_store(&t->hazards[0], tail);
+		if (tail != atomic_load(&q->tail)) {
+			continue;
+		}
+		next = atomic_load(&tail->next);
+		if (next != NULL) {
+			/* tail is lagging behind, help it along */
+			atomic_compare_exchange_strong(&q->tail, &tail, next);
+			continue;
+		}
+		if (atomic_compare_exchange_strong(&tail->next, &next, node)) {
+			atomic_compare_exchange_strong(&q->tail, &tail, node);
+			break;
+		}
+	}
+	atomic_store_explicit(&t->hazards[0], NULL, memory_order_release);
+	return MSQUEUE_SUCCESS;
+}
+
+/* Remove the item at the head of the queue and return it, or NULL if the
+ * queue is empty.
+ *
+ * This operation is lock-free and O(1) apart from contention and the
+ * amortized cost of reclamation.
+ */
+void*
+msqueue_dequeue(MSQueue q, MSQueueThread t) {
+	struct msqueue_node_t *head, *tail, *next;
+	void* value;
+
+	for (;;) {
+		head = atomic_load(&q->head);
+		atomic_store(&t->hazards[0], head);
+		if (head != atomic_load(&q->head)) {
+			continue;
+		}
+		tail = atomic_load(&q->tail);
+		next = atomic_load(&head->next);
+		atomic_store(&t->hazards[1], next);
+		if (head != atomic_load(&q->head)) {
+			continue;
+		}
+		if (next == NULL) {
+			value = NULL; /* empty */
+			break;
+		}
+		if (head == tail) {
+			atomic_compare_exchange_strong(&q->tail, &tail, next);
+			continue;
+		}
+		value = next->value;
+		if (atomic_compare_exchange_strong(&q->head, &head, next)) {
+			atomic_store_explicit(&t->hazards[0], NULL, memory_order_release);
+			atomic_store_explicit(&t->hazards[1], NULL, memory_order_release);
+			msqueue_retire_node(q, t, head);
+			return value;
+		}
+	}
+	atomic_store_explicit(&t->hazards[0], NULL, memory_order_release);
+	atomic_store_explicit(&t->hazards[1], NULL, memory_order_release);
+	return value;
+}
+
+/* Return TRUE if the queue was empty at the time of the call */
+bool
+msqueue_empty(MSQueue q) {
+	struct msqueue_node_t *head = atomic_load(&q->head);
+	return head == atomic_load(&q->tail) && atomic_load(&head->next) == NULL;
+}
@@ -0,0 +1,89 @@
+/*
+ * msqueue.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MSQUEUE_H
+#define MSQUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define MSQUEUE_HAZARDS (2)
+#define MSQUEUE_POOL_BATCH (64)
+
+typedef enum {
+	MSQUEUE_SUCCESS = 0,
+	MSQUEUE_FAILURE = 1,
+	MSQUEUE_ALLOC_ERROR = 2
+} msqueue_result_t;
+
+/* Same shape as the deque node (value/next), but singly linked and with an
+ * atomic link.
+ */
+struct msqueue_node_t {
+	void* value;
+	_Atomic(struct msqueue_node_t*) next;
+};
+
+/* Per-thread state: the thread's hazard pointers, the nodes it has
+ * retired but not yet recycled, and its private pool of free nodes.
+ * Records are never freed while the queue lives, a detached record is
+ * simply picked up again by the next thread to attach.
+ */
+struct msqueue_thread_t {
+	_Atomic(struct msqueue_node_t*) hazards[MSQUEUE_HAZARDS];
+	struct msqueue_thread_t *next;
+	atomic_bool active;
+	struct msqueue_node_t **retired;
+	uint32_t number_retired;
+	uint32_t retired_capacity;
+	struct msqueue_node_t *pool;
+	uint32_t number_pooled;
+};
+
+struct msqueue_t {
+	_Atomic(struct msqueue_node_t*) head;
+	_Atomic(struct msqueue_node_t*) tail;
+	_Atomic(struct msqueue_thread_t*) threads;
+	atomic_uint number_threads;
+	/* spill-over pool shared by all threads, moved in batches */
+	pthread_mutex_t pool_lock;
+	struct msqueue_node_t *pool;
+	atomic_uint number_pooled;
+};
+
+typedef struct msqueue_t *MSQueue;
+typedef struct msqueue_thread_t *MSQueueThread;
+
+MSQueue           msqueue_create(void);
+msqueue_result_t  msqueue_init(MSQueue q);
+void              msqueue_destroy(MSQueue q);
+void              msqueue_free(MSQueue q);
+MSQueueThread     msqueue_attach(MSQueue q);
+void              msqueue_detach(MSQueue q, MSQueueThread t);
+msqueue_result_t  msqueue_enqueue(MSQueue q, MSQueueThread t, void* item);
+void*             msqueue_dequeue(MSQueue q, MSQueueThread t);
+bool              msqueue_empty(MSQueue q);
+#endif
@@ -0,0 +1,265 @@
+/*
+ * ordereddict.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * An OrderedDict is a hash map that remembers the order its keys were put in,
+ * after Python's collections.OrderedDict.
+ *
+ * The items live in one array in order, so walking the dictionary reads
+ * memory front to back.  A HashMap from each key to its position makes
+ * lookups O(1).  Removing an item leaves a hole in the array, and moving an
+ * item to either end leaves a hole and writes it at that end; the array is
+ * compacted, and the positions in the map rewritten, when it runs out of room
+ * at the end being written or holds more holes than items.  Compaction costs
+ * O(n) after at least n/2 changes, so every operation is O(1) amortized.
+ */
+#include <stdlib.h>
+#include "ordereddict.h"
+
+/* The key of an entry that is a hole */
+static char hole_key;
+#define HOLE ((void*) &hole_key)
+
+/* Create an empty dictionary.  hash and comp work on keys; if either is
+ * NULL the keys are hashed and compared by address.
+ */
+OrderedDict
+ordereddict_create(hashmap_hash_func_t hash, hashmap_comparater_t comp) {
+	return ordereddict_create_size(0, hash, comp);
+}
+
+/* Create an empty dictionary with room for items keys before it has to
+ * grow.  NULL is returned if memory cannot be allocated.
+ */
+OrderedDict
+ordereddict_create_size(uint32_t items, hashmap_hash_func_t hash,
+                        hashmap_comparater_t comp) {
+	OrderedDict d = malloc(sizeof(struct ordereddict_t));
+	if (d == NULL) {
+		return NULL;
+	}
+	d->capacity = items > ORDEREDDICT_MIN_CAPACITY ? items : ORDEREDDICT_MIN_CAPACITY;
+	d->entries = malloc(d->capacity * sizeof(struct ordereddict_entry_t));
+	d->index = hashmap_create_size(items, hash, comp);
+	if (d->entries == NULL || d->index == NULL) {
+		free(d->entries);
+		if (d->index != NULL) {
+			hashmap_free(d->index);
+		}
+		free(d);
+		return NULL;
+	}
+	d->head = d->tail = 0;
+	d->number_items = 0;
+	return d;
+}
+
+/* Free the dictionary.  The keys and values are not freed. */
+void
+ordereddict_free(OrderedDict d) {
+	hashmap_free(d->index);
+	free(d->entries);
+	free(d);
+}
+
+/* Copy the items into a new array without holes, starting front entries
+ * in, with at least as much room again after them.  Returns false, leaving
+ * the dictionary unchanged, if memory cannot be allocated.
+ */
+static bool
+ordereddict_compact(OrderedDict d, uint32_t front) {
+	struct ordereddict_entry_t *entries;
+	uint32_t i, pos = front, capacity;
+
+	capacity = front + d->number_items
+	           + (d->number_items > ORDEREDDICT_MIN_CAPACITY
+	              ? d->number_items : ORDEREDDICT_MIN_CAPACITY);
+	entries = malloc(capacity * sizeof(struct ordereddict_entry_t));
+	if (entries == NULL) {
+		return false;
+	}
+	for (i = d->head; i < d->tail; i++) {
+		if (d->entries[i].key != HOLE) {
+			entries[pos] = d->entries[i];
+			*hashmap_lookup(d->index, entries[pos].key) = (void*) (uintptr_t) (pos + 1);
+			pos++;
+		}
+	}
+	free(d->entries);
+	d->entries = entries;
+	d->head = front;
+	d->tail = pos;
+	d->capacity = capacity;
+	return true;
+}
+
+/* Punch a hole at pos, then drop any holes at either end */
+static void
+ordereddict_unlink(OrderedDict d, uint32_t pos) {
+	d->entries[pos].key = HOLE;
+	while (d->head < d->tail && d->entries[d->head].key == HOLE) {
+		d->head++;
+	}
+	while (d->tail > d->head && d->entries[d->tail - 1].key == HOLE) {
+		d->tail--;
+	}
+}
+
+/* Map key to value.  A new key goes at the end; a key already present gets
+ * the new value and keeps its place.  O(1) amortized.
+ */
+ordereddict_result_t
+ordereddict_put(OrderedDict d, void* key, void* value) {
+	void **slot = hashmap_setdefault(d->index, key, NULL);
+	if (slot == NULL) {
+		return ORDEREDDICT_ALLOC_ERROR;
+	}
+	if (*slot != NULL) {
+		d->entries[(uintptr_t) *slot - 1].value = value;
+		return ORDEREDDICT_SUCCESS;
+	}
+	if (d->tail == d->capacity && !ordereddict_compact(d, 0)) {
+		hashmap_remove(d->index, key);
+		return ORDEREDDICT_ALLOC_ERROR;
+	}
+	d->entries[d->tail].key = key;
+	d->entries[d->tail].value = value;
+	*slot = (void*) (uintptr_t) ++d->tail;
+	d->number_items++;
+	return ORDEREDDICT_SUCCESS;
+}
+
+/* Return the value for key, or NULL if key is not in the dictionary.
+ * O(1) on average.
+ */
+void*
+ordereddict_get(OrderedDict d, const void* key) {
+	void **slot = hashmap_lookup(d->index, key);
+	return slot != NULL ? d->entries[(uintptr_t) *slot - 1].value : NULL;
+}
+
+/* Return true if key is in the dictionary */
+bool
+ordereddict_contains(OrderedDict d, const void* key) {
+	return hashmap_contains(d->index, key);
+}
+
+/* Remove key and return its value, or NULL if key is not in the
+ * dictionary.  O(1) amortized.
+ */
+void*
+ordereddict_remove(OrderedDict d, const void* key) {
+	uintptr_t pos = (uintptr_t) hashmap_remove(d->index, key);
+	void* value;
+	if (pos == 0) {
+		return NULL;
+	}
+	value = d->entries[pos - 1].value;
+	ordereddict_unlink(d, pos - 1);
+	d->number_items--;
+
+	/* keep iteration proportional to the items; if this fails the holes
+	 * just stay until the next compaction
+	 */
+	if (d->tail - d->head > 2 * d->number_items + ORDEREDDICT_MIN_CAPACITY) {
+		ordereddict_compact(d, 0);
+	}
+	return value;
+}
+
+/* Move key to the end of the order if last is true, otherwise to the
+ * start.  ORDEREDDICT_FAILURE is returned if key is not in the dictionary.
+ * O(1) amortized.
+ */
+ordereddict_result_t
+ordereddict_move_to_end(OrderedDict d, const void* key, bool last) {
+	struct ordereddict_entry_t entry;
+	void **slot = hashmap_lookup(d->index, key);
+	uint32_t pos;
+
+	if (slot == NULL) {
+		return ORDEREDDICT_FAILURE;
+	}
+	pos = (uintptr_t) *slot - 1;
+	if (pos == (last ? d->tail - 1 : d->head)) {
+		return ORDEREDDICT_SUCCESS;
+	}
+	if (last ? d->tail == d->capacity : d->head == 0) {
+		/* compacting moves every item, but leaves the map alone */
+		if (!ordereddict_compact(d, last ? 0 : d->number_items)) {
+			return ORDEREDDICT_ALLOC_ERROR;
+		}
+		pos = (uintptr_t) *slot - 1;
+	}
+	entry = d->entries[pos];
+	if (last) {
+		d->entries[d->tail] = entry;
+		*slot = (void*) (uintptr_t) ++d->tail;
+	} else {
+		d->entries[--d->head] = entry;
+		*slot = (void*) (uintptr_t) (d->head + 1);
+	}
+	ordereddict_unlink(d, pos);
+	return ORDEREDDICT_SUCCESS;
+}
+
+/* Remove the last item if last is true, otherwise the first, storing its
+ * key and value.  ORDEREDDICT_FAILURE is returned if the dictionary is
+ * empty.  O(1) amortized.
+ */
+ordereddict_result_t
+ordereddict_popitem(OrderedDict d, bool last, void** key, void** value) {
+	uint32_t pos;
+	if (d->number_items == 0) {
+		return ORDEREDDICT_FAILURE;
+	}
+	pos = last ? d->tail - 1 : d->head;
+	*key = d->entries[pos].key;
+	*value = d->entries[pos].value;
+	hashmap_remove(d->index, *key);
+	ordereddict_unlink(d, pos);
+	d->number_items--;
+	return ORDEREDDICT_SUCCESS;
+}
+
+/* Return the number of items in the dictionary */
+uint32_t
+ordereddict_count(OrderedDict d) {
+	return d->number_items;
+}
+
+/* Iterate over the items in order.  Set *iter to 0 and call until false is
+ * returned; each call stores the next key and value.  The dictionary must
+ * not be modified during the iteration.
+ */
+bool
+ordereddict_next(OrderedDict d, uint32_t *iter, void** key, void** value) {
+	for (; d->head + *iter < d->tail; (*iter)++) {
+		if (d->entries[d->head + *iter].key != HOLE) {
+			*key = d->entries[d->head + *iter].key;
+			*value = d->entries[d->head + *iter].value;
+			(*iter)++;
+			return true;
+		}
+	}
+	return false;
+}
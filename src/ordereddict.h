@@ -0,0 +1,72 @@
+/*
+ * ordereddict.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ORDEREDDICT_H
+#define ORDEREDDICT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hashmap.h"
+
+#define ORDEREDDICT_MIN_CAPACITY (16)
+
+typedef enum {
+	ORDEREDDICT_SUCCESS = 0,
+	ORDEREDDICT_FAILURE = 1,
+	ORDEREDDICT_ALLOC_ERROR = 2
+} ordereddict_result_t;
+
+struct ordereddict_entry_t {
+	void* key;
+	void* value;
+};
+
+/* The items are kept in order in entries[head] to entries[tail - 1], which
+ * may have holes left by removed or moved items but never starts or ends
+ * with one.  The index maps each key to its position in entries plus one.
+ */
+struct ordereddict_t {
+	struct ordereddict_entry_t *entries;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t capacity;
+	uint32_t number_items;
+	HashMap index;
+};
+
+typedef struct ordereddict_t *OrderedDict;
+
+OrderedDict           ordereddict_create(hashmap_hash_func_t hash, hashmap_comparater_t comp);
+OrderedDict           ordereddict_create_size(uint32_t items, hashmap_hash_func_t hash,
+                                              hashmap_comparater_t comp);
+void                  ordereddict_free(OrderedDict d);
+ordereddict_result_t  ordereddict_put(OrderedDict d, void* key, void* value);
+void*                 ordereddict_get(OrderedDict d, const void* key);
+bool                  ordereddict_contains(OrderedDict d, const void* key);
+void*                 ordereddict_remove(OrderedDict d, const void* key);
+ordereddict_result_t  ordereddict_move_to_end(OrderedDict d, const void* key, bool last);
+ordereddict_result_t  ordereddict_popitem(OrderedDict d, bool last, void** key, void** value);
+uint32_t              ordereddict_count(OrderedDict d);
+bool                  ordereddict_next(OrderedDict d, uint32_t *iter, void** key, void** value);
+#endif
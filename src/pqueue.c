@@ -0,0 +1,223 @@
+/*
+ * pqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A priority queue kept as a d-ary heap in an ArrayList's pointer table,
+ * ordered by the list's compare_func with the smallest item at the front.
+ *
+ * A 4-ary heap is half as deep as a binary heap, and the four children of an
+ * item are next to each other in memory (usually in one cache line), so a
+ * pop touches fewer cache lines for the price of a few more comparisons per
+ * level.  Sifting moves a hole down (or up) the heap and writes the item
+ * once at the end rather than swapping at every level.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "pqueue.h"
+#ifdef ARRAYLIST_FILTER
+#include "bloomfilter.h"
+#endif /* ARRAYLIST_FILTER */
+
+/* Create an empty priority queue with its own expanding list */
+PQueue
+pqueue_create(int8_t(*compare_func)(void*, void*)) {
+	ArrayList list = arraylist_create(compare_func);
+	PQueue q;
+	if (list == NULL) {
+		return NULL;
+	}
+	if ((q = pqueue_create_from(list)) == NULL) {
+		arraylist_free(list);
+	}
+	return q;
+}
+
+/* Create a priority queue over the items already in list, which the queue
+ * takes over (it is freed by pqueue_free()).  The items are put in heap
+ * order in O(n), see pqueue_heapify().
+ */
+PQueue
+pqueue_create_from(ArrayList list) {
+	PQueue q = malloc(sizeof(struct pqueue_t));
+	if (q != NULL) {
+		pqueue_init(q, list, PQUEUE_DEFAULT_ARITY);
+	}
+	return q;
+}
+
+/* Initialize a priority queue using list for storage, with arity children
+ * per item (2 gives a classic binary heap).  The items already in list are
+ * heapified.  The list may be fixed size, in which case pushing fails once
+ * it is full.
+ */
+void
+pqueue_init(PQueue q, ArrayList list, uint32_t arity) {
+	assert(arity >= 2 && list->compare_func != NULL);
+	q->list = list;
+	q->arity = arity;
+	pqueue_heapify(q);
+}
+
+/* Free the queue and its list, but not the items */
+void
+pqueue_free(PQueue q) {
+	arraylist_free(q->list);
+	free(q);
+}
+
+/* Move the item at pos down until no child compares less than it */
+static void
+pqueue_sift_down(PQueue q, uint32_t pos) {
+	void **heap = q->list->ptr_table;
+	uint32_t n = q->list->number_items;
+	void *item = heap[pos];
+	uint32_t child, last, best, i;
+
+	for (;;) {
+		child = q->arity * pos + 1;
+		if (child >= n) {
+			break;
+		}
+		last = child + q->arity < n ? child + q->arity : n;
+		best = child;
+		for (i = child + 1; i < last; i++) {
+			if ((*q->list->compare_func)(heap[i], heap[best]) < 0) {
+				best = i;
+			}
+		}
+		if ((*q->list->compare_func)(heap[best], item) >= 0) {
+			break;
+		}
+		heap[pos] = heap[best];
+		pos = best;
+	}
+	heap[pos] = item;
+}
+
+/* Move the item at pos up until its parent does not compare greater */
+static void
+pqueue_sift_up(PQueue q, uint32_t pos) {
+	void **heap = q->list->ptr_table;
+	void *item = heap[pos];
+	uint32_t parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / q->arity;
+		if ((*q->list->compare_func)(item, heap[parent]) >= 0) {
+			break;
+		}
+		heap[pos] = heap[parent];
+		pos = parent;
+	}
+	heap[pos] = item;
+}
+
+/* Put the items of the underlying list in heap order, sifting down from
+ * the last item with children back to the root.  This is O(n), cheaper
+ * than pushing the items one at a time.
+ */
+void
+pqueue_heapify(PQueue q) {
+	uint32_t n = q->list->number_items, i;
+	if (n < 2) {
+		return;
+	}
+	for (i = (n - 2) / q->arity + 1; i > 0; i--) {
+		pqueue_sift_down(q, i - 1);
+	}
+}
+
+/* Add an item.  O(log n).  Returns PQUEUE_FAILURE if a fixed size list is
+ * full.
+ */
+pqueue_result_t
+pqueue_push(PQueue q, void* item) {
+	if (arraylist_append(q->list, item) != ARRAYLIST_SUCCESS) {
+		return PQUEUE_FAILURE;
+	}
+	pqueue_sift_up(q, q->list->number_items - 1);
+	return PQUEUE_SUCCESS;
+}
+
+/* Add n items at once.  Small batches are sifted up one by one; once the
+ * batch is at least as large as the queue it is cheaper to append them all
+ * and heapify everything in O(n + k).
+ *
+ * If a fixed size list fills up, PQUEUE_FAILURE is returned and only the
+ * items that fit have been added.
+ */
+pqueue_result_t
+pqueue_push_batch(PQueue q, void** items, uint32_t n) {
+	uint32_t start = q->list->number_items, i;
+	pqueue_result_t result = PQUEUE_SUCCESS;
+
+	for (i = 0; i < n; i++) {
+		if (arraylist_append(q->list, items[i]) != ARRAYLIST_SUCCESS) {
+			result = PQUEUE_FAILURE;
+			break;
+		}
+	}
+	if (i >= start) {
+		pqueue_heapify(q);
+	} else {
+		for (n = start + i; start < n; start++) {
+			pqueue_sift_up(q, start);
+		}
+	}
+	return result;
+}
+
+/* Return the smallest item without removing it, or NULL if empty.  O(1). */
+void*
+pqueue_peek(PQueue q) {
+	return q->list->number_items > 0 ? q->list->ptr_table[0] : NULL;
+}
+
+/* Remove and return the smallest item, or NULL if empty.  O(log n).  The
+ * item is also taken out of the list's filter, if it has one.
+ */
+void*
+pqueue_pop(PQueue q) {
+	void **heap = q->list->ptr_table;
+	void *top;
+	if (q->list->number_items == 0) {
+		return NULL;
+	}
+	top = heap[0];
+#ifdef ARRAYLIST_FILTER
+	if (q->list->filter != NULL) {
+		bloomfilter_remove(q->list->filter, top);
+	}
+#endif /* ARRAYLIST_FILTER */
+	q->list->number_items--;
+	if (q->list->number_items > 0) {
+		heap[0] = heap[q->list->number_items];
+		pqueue_sift_down(q, 0);
+	}
+	return top;
+}
+
+/* Return the number of items in the queue */
+uint32_t
+pqueue_count(PQueue q) {
+	return q->list->number_items;
+}
@@ -0,0 +1,60 @@
+/*
+ * pqueue.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#include <stdint.h>
+#include "arraylist.h"
+
+#define PQUEUE_DEFAULT_ARITY (4)
+
+typedef enum {
+	PQUEUE_SUCCESS = 0,
+	PQUEUE_FAILURE = 1,
+	PQUEUE_ALLOC_ERROR = 2
+} pqueue_result_t;
+
+/* The heap lives in the list's ptr_table: the children of the item at i
+ * are at arity * i + 1 ... arity * i + arity, and no item compares less
+ * than its parent.
+ */
+struct pqueue_t {
+	ArrayList list;
+	uint32_t arity;
+};
+
+typedef struct pqueue_t *PQueue;
+
+PQueue           pqueue_create(int8_t(*compare_func)(void*, void*));
+PQueue           pqueue_create_from(ArrayList list);
+void             pqueue_init(PQueue q, ArrayList list, uint32_t arity);
+void             pqueue_free(PQueue q);
+void             pqueue_heapify(PQueue q);
+pqueue_result_t  pqueue_push(PQueue q, void* item);
+pqueue_result_t  pqueue_push_batch(PQueue q, void** items, uint32_t n);
+void*            pqueue_peek(PQueue q);
+void*            pqueue_pop(PQueue q);
+uint32_t         pqueue_count(PQueue q);
+#endif
@@ -0,0 +1,369 @@
+/*
+ * ringdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A deque stored in a circular array of item pointers.
+ *
+ * It offers the same append/pop operations as the linked deque, but because
+ * the items are contiguous (in at most two runs) they can be handed to the
+ * caller in place: ringdeque_peek_spans() exposes the contents as two arrays
+ * and ringdeque_consume() drops items from the left once they are processed.
+ * Like the ArrayList, a ring deque either grows on demand (heap storage) or
+ * works in a caller supplied fixed size buffer.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "ringdeque.h"
+
+/* Same default as the deque module, compare by address */
+static int8_t
+default_comparator(const void * a, const void * b) {
+	if (a == b) {
+		return 0;
+	} else {
+		return a > b ? 1 : -1;
+	}
+}
+
+/* Map a position relative to the leftmost item onto a buffer index */
+static uint32_t
+ringdeque_index(RingDeque d, uint32_t pos) {
+	uint32_t idx = d->first + pos;
+	return idx >= d->capacity ? idx - d->capacity : idx;
+}
+
+/* Make sure there is room for one more item, doubling the buffer of an
+ * expanding ring deque if needed.  The items are unwrapped into the start
+ * of the new buffer.
+ */
+static ringdeque_result_t
+ringdeque_memcheck(RingDeque d) {
+	void **newBuffer;
+	uint32_t newCapacity, firstRun;
+
+	if (d->number_items < d->capacity) {
+		return RINGDEQUE_SUCCESS;
+	}
+	if (d->ring_type == RINGDEQUE_TYPE_FIXED) {
+		return RINGDEQUE_FAILURE;
+	}
+	newCapacity = d->capacity > 0 ? 2 * d->capacity : RINGDEQUE_DEFAULT_SIZE;
+	if ((newBuffer = malloc(newCapacity * sizeof(void*))) == NULL) {
+		return RINGDEQUE_ALLOC_ERROR;
+	}
+	firstRun = d->capacity - d->first;
+	if (firstRun > d->number_items) {
+		firstRun = d->number_items;
+	}
+	memcpy(newBuffer, d->buffer + d->first, firstRun * sizeof(void*));
+	memcpy(newBuffer + firstRun, d->buffer, (d->number_items - firstRun) * sizeof(void*));
+	free(d->buffer);
+	d->buffer = newBuffer;
+	d->capacity = newCapacity;
+	d->first = 0;
+	return RINGDEQUE_SUCCESS;
+}
+
+/* Create a ring deque with memory allocated on the heap.  It starts out with
+ * room for RINGDEQUE_DEFAULT_SIZE items and doubles when full.
+ */
+RingDeque
+ringdeque_create(ringdeque_comparater_t compare_func) {
+	return ringdeque_create_size(RINGDEQUE_DEFAULT_SIZE, compare_func);
+}
+
+/* Create a ring deque with room for capacity items before it has to grow.
+ * Returns NULL if memory cannot be allocated.
+ */
+RingDeque
+ringdeque_create_size(uint32_t capacity, ringdeque_comparater_t compare_func) {
+	RingDeque d = malloc(sizeof(struct ringdeque_t));
+	if (d == NULL) {
+		return NULL;
+	}
+	if (capacity == 0) {
+		capacity = RINGDEQUE_DEFAULT_SIZE;
+	}
+	if ((d->buffer = malloc(capacity * sizeof(void*))) == NULL) {
+		free(d);
+		return NULL;
+	}
+	d->capacity = capacity;
+	d->first = 0;
+	d->number_items = 0;
+	d->ring_type = RINGDEQUE_TYPE_EXPANDING;
+	d->compare_func = compare_func != NULL ? compare_func : default_comparator;
+	return d;
+}
+
+/* Initialize a ring deque over a caller supplied buffer of capacity item
+ * pointers.  Like a static ArrayList, it never grows: appending to a full
+ * ring deque returns RINGDEQUE_FAILURE.  Such a ring deque must not be
+ * passed to ringdeque_free().
+ */
+void
+ringdeque_init_static(RingDeque d, void **buffer, uint32_t capacity,
+                      ringdeque_comparater_t compare_func) {
+	assert(d != NULL && buffer != NULL);
+	d->buffer = buffer;
+	d->capacity = capacity;
+	d->first = 0;
+	d->number_items = 0;
+	d->ring_type = RINGDEQUE_TYPE_FIXED;
+	d->compare_func = compare_func != NULL ? compare_func : default_comparator;
+}
+
+/* Free a ring deque created with ringdeque_create() and its buffer.  The
+ * items referenced are not freed.
+ */
+void
+ringdeque_free(RingDeque d) {
+	free(d->buffer);
+	free(d);
+}
+
+/* Append an item to the right end.  O(1) amortized. */
+ringdeque_result_t
+ringdeque_append(RingDeque d, void* item) {
+	ringdeque_result_t result;
+	if ((result = ringdeque_memcheck(d)) != RINGDEQUE_SUCCESS) {
+		return result;
+	}
+	d->buffer[ringdeque_index(d, d->number_items)] = item;
+	d->number_items++;
+	return RINGDEQUE_SUCCESS;
+}
+
+/* Append an item to the left end.  O(1) amortized. */
+ringdeque_result_t
+ringdeque_appendleft(RingDeque d, void* item) {
+	ringdeque_result_t result;
+	if ((result = ringdeque_memcheck(d)) != RINGDEQUE_SUCCESS) {
+		return result;
+	}
+	d->first = d->first == 0 ? d->capacity - 1 : d->first - 1;
+	d->buffer[d->first] = item;
+	d->number_items++;
+	return RINGDEQUE_SUCCESS;
+}
+
+/* Remove all items.  The buffer is kept. */
+void
+ringdeque_clear(RingDeque d) {
+	d->first = 0;
+	d->number_items = 0;
+}
+
+/* Get the rightmost item or NULL if the ring deque is empty */
+void*
+ringdeque_peek(RingDeque d) {
+	if (d->number_items == 0) {
+		return NULL;
+	}
+	return d->buffer[ringdeque_index(d, d->number_items - 1)];
+}
+
+/* Remove and return the rightmost item or NULL if the ring deque is empty */
+void*
+ringdeque_pop(RingDeque d) {
+	void* value = ringdeque_peek(d);
+	if (d->number_items > 0) {
+		d->number_items--;
+	}
+	return value;
+}
+
+/* Get the leftmost item or NULL if the ring deque is empty */
+void*
+ringdeque_peekleft(RingDeque d) {
+	if (d->number_items == 0) {
+		return NULL;
+	}
+	return d->buffer[d->first];
+}
+
+/* Remove and return the leftmost item or NULL if the ring deque is empty */
+void*
+ringdeque_popleft(RingDeque d) {
+	void* value = ringdeque_peekleft(d);
+	ringdeque_consume(d, 1);
+	return value;
+}
+
+/* Return the number of items in the ring deque */
+uint32_t
+ringdeque_count(RingDeque d) {
+	return d->number_items;
+}
+
+/* Return TRUE if the ring deque contains the specified item */
+bool
+ringdeque_contains(RingDeque d, void* item) {
+	uint32_t i;
+	for (i = 0; i < d->number_items; i++) {
+		if ((d->compare_func)(d->buffer[ringdeque_index(d, i)], item) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Expose the contents of the ring deque in place, as at most two contiguous
+ * arrays: *a holds the first *alen items from the left and *b the remaining
+ * *blen items (*blen is 0 and *b NULL unless the contents wrap around the end
+ * of the buffer).  Returns the total number of items, *alen + *blen.
+ *
+ * The spans stay valid until the ring deque is next modified, so they can be
+ * written out with writev() or processed in a loop, and then dropped with
+ * ringdeque_consume().
+ */
+uint32_t
+ringdeque_peek_spans(RingDeque d, void ***a, uint32_t *alen,
+                     void ***b, uint32_t *blen) {
+	uint32_t firstRun = d->capacity - d->first;
+	if (firstRun >= d->number_items) {
+		*a = d->number_items > 0 ? d->buffer + d->first : NULL;
+		*alen = d->number_items;
+		*b = NULL;
+		*blen = 0;
+	} else {
+		*a = d->buffer + d->first;
+		*alen = firstRun;
+		*b = d->buffer;
+		*blen = d->number_items - firstRun;
+	}
+	return d->number_items;
+}
+
+/* Drop up to n items from the left end without looking at them, returning
+ * the number of items dropped.  This operation is O(1).
+ */
+uint32_t
+ringdeque_consume(RingDeque d, uint32_t n) {
+	if (n > d->number_items) {
+		n = d->number_items;
+	}
+	d->first = d->number_items == n ? 0 : ringdeque_index(d, n);
+	d->number_items -= n;
+	return n;
+}
+
+/* Turn a python style index (negative counts from the right) into a position
+ * from the left.  Returns false if the result is not below limit.
+ */
+static bool
+ringdeque_normalize_index(RingDeque d, int32_t index, uint32_t limit, uint32_t *pos) {
+	int64_t i = index < 0 ? (int64_t) d->number_items + index : index;
+	if (i < 0 || i >= limit) {
+		return false;
+	}
+	*pos = (uint32_t) i;
+	return true;
+}
+
+/* Get the item at index, counting from 0 at the left end.  Negative indices
+ * count from the right, -1 being the rightmost item.  NULL is returned if
+ * the index is out of range.  O(1).
+ */
+void*
+ringdeque_getitem(RingDeque d, int32_t index) {
+	uint32_t pos;
+	if (!ringdeque_normalize_index(d, index, d->number_items, &pos)) {
+		return NULL;
+	}
+	return d->buffer[ringdeque_index(d, pos)];
+}
+
+/* Replace the item at index (see ringdeque_getitem()).  Returns
+ * RINGDEQUE_INDEX_ERROR if the index is out of range.  O(1).
+ */
+ringdeque_result_t
+ringdeque_setitem(RingDeque d, int32_t index, void* item) {
+	uint32_t pos;
+	if (!ringdeque_normalize_index(d, index, d->number_items, &pos)) {
+		return RINGDEQUE_INDEX_ERROR;
+	}
+	d->buffer[ringdeque_index(d, pos)] = item;
+	return RINGDEQUE_SUCCESS;
+}
+
+/* Insert item so that it ends up at index, an index equal to the number of
+ * items appending.  Negative indices count from the right.  Returns
+ * RINGDEQUE_INDEX_ERROR if the index is out of range.
+ *
+ * Only the items on the shorter side of index are shifted, into the free
+ * slot at that end, so at most n/2 items move.
+ */
+ringdeque_result_t
+ringdeque_insert(RingDeque d, int32_t index, void* item) {
+	ringdeque_result_t result;
+	uint32_t pos, i;
+
+	if (!ringdeque_normalize_index(d, index, d->number_items + 1, &pos)) {
+		return RINGDEQUE_INDEX_ERROR;
+	}
+	if ((result = ringdeque_memcheck(d)) != RINGDEQUE_SUCCESS) {
+		return result;
+	}
+	if (pos < d->number_items - pos) {
+		/* open a slot at the left and shift the left part into it */
+		d->first = d->first == 0 ? d->capacity - 1 : d->first - 1;
+		for (i = 0; i < pos; i++) {
+			d->buffer[ringdeque_index(d, i)] = d->buffer[ringdeque_index(d, i + 1)];
+		}
+	} else {
+		for (i = d->number_items; i > pos; i--) {
+			d->buffer[ringdeque_index(d, i)] = d->buffer[ringdeque_index(d, i - 1)];
+		}
+	}
+	d->buffer[ringdeque_index(d, pos)] = item;
+	d->number_items++;
+	return RINGDEQUE_SUCCESS;
+}
+
+/* Remove the item at index (see ringdeque_getitem()) and return it, or NULL
+ * if the index is out of range.  As with ringdeque_insert() the gap is closed
+ * from the nearer end, moving at most n/2 items.
+ */
+void*
+ringdeque_del(RingDeque d, int32_t index) {
+	void* value;
+	uint32_t pos, i;
+
+	if (!ringdeque_normalize_index(d, index, d->number_items, &pos)) {
+		return NULL;
+	}
+	value = d->buffer[ringdeque_index(d, pos)];
+	if (pos < d->number_items - 1 - pos) {
+		for (i = pos; i > 0; i--) {
+			d->buffer[ringdeque_index(d, i)] = d->buffer[ringdeque_index(d, i - 1)];
+		}
+		d->first = ringdeque_index(d, 1);
+	} else {
+		for (i = pos; i + 1 < d->number_items; i++) {
+			d->buffer[ringdeque_index(d, i)] = d->buffer[ringdeque_index(d, i + 1)];
+		}
+	}
+	d->number_items--;
+	return value;
+}
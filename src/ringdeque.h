@@ -0,0 +1,78 @@
+/*
+ * ringdeque.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RINGDEQUE_H
+#define RINGDEQUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RINGDEQUE_TYPE_FIXED 0x00
+#define RINGDEQUE_TYPE_EXPANDING 0x01
+#define RINGDEQUE_DEFAULT_SIZE (16)
+
+typedef enum {
+	RINGDEQUE_SUCCESS = 0,
+	RINGDEQUE_FAILURE = 1,
+	RINGDEQUE_ALLOC_ERROR = 2,
+	RINGDEQUE_INDEX_ERROR = 3
+} ringdeque_result_t;
+
+/* The items live in buffer[first], buffer[first + 1], ... wrapping around
+ * at capacity, leftmost first.
+ */
+struct ringdeque_t {
+	void **buffer;
+	uint32_t capacity;
+	uint32_t first;
+	uint32_t number_items;
+	uint8_t ring_type;
+	int8_t(*compare_func)(const void *, const void *);
+};
+
+typedef struct ringdeque_t *RingDeque;
+typedef int8_t(*ringdeque_comparater_t)(const void*, const void*);
+
+RingDeque           ringdeque_create(ringdeque_comparater_t comp);
+RingDeque           ringdeque_create_size(uint32_t capacity, ringdeque_comparater_t comp);
+void                ringdeque_init_static(RingDeque d, void **buffer, uint32_t capacity,
+                                          ringdeque_comparater_t comp);
+void                ringdeque_free(RingDeque d);
+ringdeque_result_t  ringdeque_append(RingDeque d, void* item);
+ringdeque_result_t  ringdeque_appendleft(RingDeque d, void* item);
+void                ringdeque_clear(RingDeque d);
+void*               ringdeque_peek(RingDeque d);
+void*               ringdeque_pop(RingDeque d);
+void*               ringdeque_peekleft(RingDeque d);
+void*               ringdeque_popleft(RingDeque d);
+uint32_t            ringdeque_count(RingDeque d);
+bool                ringdeque_contains(RingDeque d, void* item);
+uint32_t            ringdeque_peek_spans(RingDeque d, void ***a, uint32_t *alen,
+                                         void ***b, uint32_t *blen);
+uint32_t            ringdeque_consume(RingDeque d, uint32_t n);
+void*               ringdeque_getitem(RingDeque d, int32_t index);
+ringdeque_result_t  ringdeque_setitem(RingDeque d, int32_t index, void* item);
+ringdeque_result_t  ringdeque_insert(RingDeque d, int32_t index, void* item);
+void*               ringdeque_del(RingDeque d, int32_t index);
+#endif
@@ -0,0 +1,208 @@
+/*
+ * spscqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A wait-free single-producer/single-consumer ring buffer.
+ *
+ * Exactly one thread may enqueue and exactly one thread may dequeue.  Indices
+ * run freely and are wrapped with a mask, so the capacity is always a power of
+ * two and a full ring holds capacity items.  As with the deque module, items
+ * are pointers and NULL is reserved to mean "empty".
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "spscqueue.h"
+
+/* Initialize a queue that has already been allocated.  The capacity is
+ * rounded up to the next power of two; SPSCQUEUE_ALLOC_ERROR is returned
+ * if that would not fit in a uint32_t.
+ *
+ * A queue that lives in static or stack storage must still be aligned to
+ * SPSCQUEUE_CACHE_LINE, which the compiler takes care of for struct
+ * spscqueue_t variables.
+ */
+spscqueue_result_t
+spscqueue_init(SPSCQueue q, uint32_t capacity) {
+	uint32_t size = 2;
+	assert(q != NULL);
+	if (capacity > UINT32_MAX / 2 + 1) {
+		return SPSCQUEUE_ALLOC_ERROR; /* no power of two that large fits */
+	}
+	while (size < capacity) {
+		size <<= 1;
+	}
+	if ((q->buffer = malloc(size * sizeof(void*))) == NULL) {
+		return SPSCQUEUE_ALLOC_ERROR;
+	}
+	q->mask = size - 1;
+	atomic_init(&q->head, 0);
+	atomic_init(&q->tail, 0);
+	q->cached_head = 0;
+	q->cached_tail = 0;
+	return SPSCQUEUE_SUCCESS;
+}
+
+/* Create a queue able to hold at least capacity items, or NULL if memory
+ * could not be allocated.
+ */
+SPSCQueue
+spscqueue_create(uint32_t capacity) {
+	SPSCQueue q = aligned_alloc(SPSCQUEUE_CACHE_LINE, sizeof(struct spscqueue_t));
+	if (q != NULL && spscqueue_init(q, capacity) != SPSCQUEUE_SUCCESS) {
+		free(q);
+		q = NULL;
+	}
+	return q;
+}
+
+/* Release the ring owned by a queue initialized with spscqueue_init() */
+void
+spscqueue_destroy(SPSCQueue q) {
+	free(q->buffer);
+	q->buffer = NULL;
+}
+
+/* Free a queue allocated with spscqueue_create() */
+void
+spscqueue_free(SPSCQueue q) {
+	spscqueue_destroy(q);
+	free(q);
+}
+
+/* Number of free slots as seen by the producer, refreshing the cached head
+ * only when the cached value does not leave enough room.
+ */
+static uint32_t
+spscqueue_free_slots(SPSCQueue q, uint32_t tail, uint32_t wanted) {
+	uint32_t room = q->mask + 1 - (tail - q->cached_head);
+	if (room < wanted) {
+		q->cached_head = atomic_load_explicit(&q->head, memory_order_acquire);
+		room = q->mask + 1 - (tail - q->cached_head);
+	}
+	return room;
+}
+
+/* Number of used slots as seen by the consumer, refreshing the cached tail
+ * only when the cached value does not show enough items.
+ */
+static uint32_t
+spscqueue_used_slots(SPSCQueue q, uint32_t head, uint32_t wanted) {
+	uint32_t used = q->cached_tail - head;
+	if (used < wanted) {
+		q->cached_tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+		used = q->cached_tail - head;
+	}
+	return used;
+}
+
+/* Enqueue an item.  Producer thread only.
+ *
+ * Returns SPSCQUEUE_FULL if there is no room.  This operation is O(1) and
+ * wait-free.
+ */
+spscqueue_result_t
+spscqueue_enqueue(SPSCQueue q, void* item) {
+	uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	if (spscqueue_free_slots(q, tail, 1) == 0) {
+		return SPSCQUEUE_FULL;
+	}
+	q->buffer[tail & q->mask] = item;
+	atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+	return SPSCQUEUE_SUCCESS;
+}
+
+/* Dequeue the oldest item.  Consumer thread only.
+ *
+ * Returns NULL if the queue is empty.  This operation is O(1) and
+ * wait-free.
+ */
+void*
+spscqueue_dequeue(SPSCQueue q) {
+	void* item;
+	uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+	if (spscqueue_used_slots(q, head, 1) == 0) {
+		return NULL;
+	}
+	item = q->buffer[head & q->mask];
+	atomic_store_explicit(&q->head, head + 1, memory_order_release);
+	return item;
+}
+
+/* Enqueue up to n items from an array with a single index publication.
+ * Producer thread only.
+ *
+ * Returns the number of items enqueued, which is less than n only if the
+ * queue filled up.
+ */
+uint32_t
+spscqueue_enqueue_batch(SPSCQueue q, void** items, uint32_t n) {
+	uint32_t i, room;
+	uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	room = spscqueue_free_slots(q, tail, n);
+	if (n > room) {
+		n = room;
+	}
+	for (i = 0; i < n; i++) {
+		q->buffer[(tail + i) & q->mask] = items[i];
+	}
+	atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+	return n;
+}
+
+/* Dequeue up to n items into an array with a single index publication.
+ * Consumer thread only.
+ *
+ * Returns the number of items dequeued, 0 if the queue was empty.
+ */
+uint32_t
+spscqueue_dequeue_batch(SPSCQueue q, void** items, uint32_t n) {
+	uint32_t i, used;
+	uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+	used = spscqueue_used_slots(q, head, n);
+	if (n > used) {
+		n = used;
+	}
+	for (i = 0; i < n; i++) {
+		items[i] = q->buffer[(head + i) & q->mask];
+	}
+	atomic_store_explicit(&q->head, head + n, memory_order_release);
+	return n;
+}
+
+/* Return the number of items in the queue.  When the other thread is active
+ * this is only a snapshot.
+ */
+uint32_t
+spscqueue_count(SPSCQueue q) {
+	/* head first: the tail loaded after it can only be further along,
+	 * though by then the ring may have been emptied and refilled
+	 */
+	uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+	uint32_t n = atomic_load_explicit(&q->tail, memory_order_acquire) - head;
+	return n <= q->mask ? n : q->mask + 1;
+}
+
+/* Return the number of items the queue can hold */
+uint32_t
+spscqueue_capacity(SPSCQueue q) {
+	return q->mask + 1;
+}
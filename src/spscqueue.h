@@ -0,0 +1,70 @@
+/*
+ * spscqueue.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef SPSCQUEUE_CACHE_LINE
+#define SPSCQUEUE_CACHE_LINE (64)
+#endif
+
+typedef enum {
+	SPSCQUEUE_SUCCESS = 0,
+	SPSCQUEUE_FULL = 1,
+	SPSCQUEUE_ALLOC_ERROR = 2
+} spscqueue_result_t;
+
+/* The consumer and producer each get their own cache line so that the
+ * two threads only share a line when one actually has to look at the other
+ * side's index.  Each side keeps a cached copy of the other side's index
+ * and only reloads it when the cached value says the ring is full/empty.
+ */
+struct spscqueue_t {
+	/* consumer side */
+	_Alignas(SPSCQUEUE_CACHE_LINE) _Atomic uint32_t head;
+	uint32_t cached_tail;
+	/* producer side */
+	_Alignas(SPSCQUEUE_CACHE_LINE) _Atomic uint32_t tail;
+	uint32_t cached_head;
+	/* read only after init */
+	_Alignas(SPSCQUEUE_CACHE_LINE) void **buffer;
+	uint32_t mask;
+};
+
+typedef struct spscqueue_t *SPSCQueue;
+
+SPSCQueue           spscqueue_create(uint32_t capacity);
+spscqueue_result_t  spscqueue_init(SPSCQueue q, uint32_t capacity);
+void                spscqueue_destroy(SPSCQueue q);
+void                spscqueue_free(SPSCQueue q);
+spscqueue_result_t  spscqueue_enqueue(SPSCQueue q, void* item);
+void*               spscqueue_dequeue(SPSCQueue q);
+uint32_t            spscqueue_enqueue_batch(SPSCQueue q, void** items, uint32_t n);
+uint32_t            spscqueue_dequeue_batch(SPSCQueue q, void** items, uint32_t n);
+uint32_t            spscqueue_count(SPSCQueue q);
+uint32_t            spscqueue_capacity(SPSCQueue q);
+#endif
@@ -0,0 +1,223 @@
+/*
+ * timerwheel.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A hierarchical timing wheel.
+ *
+ * Every slot is an intrusive deque of timers, so scheduling a timer is a hash
+ * of its expiry tick into a slot plus an append, and cancelling it is an O(1)
+ * unlink; neither depends on the number of outstanding timers and neither
+ * allocates.  Timers too far out for level 0 wait in a coarser level and are
+ * redistributed (cascaded) into the level below when their slot comes up, so
+ * each timer moves at most TIMERWHEEL_LEVELS - 1 times before it expires.
+ *
+ * Expired timers are handed over in batches: timerwheel_advance() splices
+ * each due level 0 slot onto the caller's deque.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "timerwheel.h"
+
+/* The farthest a timer can be placed from the next tick; timers beyond it
+ * are parked in the top level and placed again when that slot cascades.
+ */
+#define TIMERWHEEL_MAX_DELTA \
+	((UINT64_C(1) << (TIMERWHEEL_LEVELS * TIMERWHEEL_SLOT_BITS)) - 1)
+#define TIMERWHEEL_SLOT_MASK (TIMERWHEEL_SLOTS - 1)
+
+/* Create a timing wheel whose clock starts at tick now, see
+ * timerwheel_init().  NULL is returned if memory cannot be allocated.
+ */
+TimerWheel
+timerwheel_create(uint64_t now) {
+	TimerWheel w = malloc(sizeof(struct timerwheel_t));
+	if (w != NULL) {
+		timerwheel_init(w, now);
+	}
+	return w;
+}
+
+/* Initialize an empty timing wheel.  Ticks up to and including now count as
+ * processed, so the first call to timerwheel_advance() starts at now + 1.
+ */
+void
+timerwheel_init(TimerWheel w, uint64_t now) {
+	int level, slot;
+	w->now = now;
+	w->number_timers = 0;
+	for (level = 0; level < TIMERWHEEL_LEVELS; level++) {
+		for (slot = 0; slot < TIMERWHEEL_SLOTS; slot++) {
+			ideque_init(&w->slots[level][slot]);
+		}
+	}
+}
+
+/* Free the timing wheel.  The timers are not touched. */
+void
+timerwheel_free(TimerWheel w) {
+	free(w);
+}
+
+/* Prepare a timer for its first use */
+void
+timerwheel_timer_init(TimerWheelTimer t) {
+	ideque_link_init(&t->link);
+	t->expires = 0;
+	t->bucket = NULL;
+}
+
+static bool
+timerwheel_owns(TimerWheel w, IDeque bucket) {
+	uintptr_t start = (uintptr_t) &w->slots[0][0];
+	uintptr_t end = (uintptr_t) &w->slots[TIMERWHEEL_LEVELS - 1][TIMERWHEEL_SLOTS];
+	return (uintptr_t) bucket >= start && (uintptr_t) bucket < end;
+}
+
+/* Put a timer in the slot for its expiry tick, relative to the next tick
+ * to be processed.
+ */
+static void
+timerwheel_place(TimerWheel w, TimerWheelTimer t) {
+	uint64_t base = w->now + 1;
+	uint64_t expires = t->expires > base ? t->expires : base;
+	uint64_t delta = expires - base;
+	int level = 0;
+
+	if (delta > TIMERWHEEL_MAX_DELTA) {
+		expires = base + TIMERWHEEL_MAX_DELTA;
+		delta = TIMERWHEEL_MAX_DELTA;
+	}
+	while (delta >> ((level + 1) * TIMERWHEEL_SLOT_BITS) != 0) {
+		level++;
+	}
+	t->bucket = &w->slots[level][(expires >> (level * TIMERWHEEL_SLOT_BITS))
+	                             & TIMERWHEEL_SLOT_MASK];
+	ideque_append(t->bucket, &t->link);
+}
+
+/* Schedule t to expire at tick expires, or on the next tick processed if
+ * expires has already passed.  A timer that is already pending in this
+ * wheel is moved, and one still linked into the deque it expired into is
+ * taken out of that deque first.  O(1).
+ */
+void
+timerwheel_schedule(TimerWheel w, TimerWheelTimer t, uint64_t expires) {
+	if (ideque_is_linked(&t->link)) {
+		ideque_remove(t->bucket, &t->link);
+		if (!timerwheel_owns(w, t->bucket)) {
+			w->number_timers++;
+		}
+	} else {
+		w->number_timers++;
+	}
+	t->expires = expires;
+	timerwheel_place(w, t);
+}
+
+/* Return true if t is waiting to expire in this wheel */
+bool
+timerwheel_pending(TimerWheel w, TimerWheelTimer t) {
+	return ideque_is_linked(&t->link) && timerwheel_owns(w, t->bucket);
+}
+
+/* Stop a timer.  Returns true if it was pending.  A timer that has already
+ * been handed out by timerwheel_advance() but is still linked into the
+ * expired deque is taken out of that deque and false is returned.  O(1).
+ */
+bool
+timerwheel_cancel(TimerWheel w, TimerWheelTimer t) {
+	bool pending;
+	if (!ideque_is_linked(&t->link)) {
+		return false;
+	}
+	pending = timerwheel_owns(w, t->bucket);
+	ideque_remove(t->bucket, &t->link);
+	t->bucket = NULL;
+	if (pending) {
+		w->number_timers--;
+	}
+	return pending;
+}
+
+/* Move every timer of a higher level slot down to where it now belongs */
+static void
+timerwheel_cascade(TimerWheel w, IDeque slot) {
+	struct ideque_t timers;
+	IDequeLink link;
+	ideque_init(&timers);
+	ideque_splice(&timers, slot);
+	while ((link = ideque_popleft(&timers)) != NULL) {
+		timerwheel_place(w, TIMERWHEEL_TIMER(link));
+	}
+}
+
+/* Process every tick up to and including now.  The timers that expire are
+ * appended to expired, in order of expiry tick, and the number of them is
+ * returned.  Each due slot is spliced over whole; only the expired timers'
+ * bucket pointers are touched, so the cost is O(ticks + expired timers)
+ * plus the amortized cascading.
+ */
+uint32_t
+timerwheel_advance(TimerWheel w, uint64_t now, IDeque expired) {
+	IDeque slot;
+	IDequeLink link;
+	uint64_t tick;
+	uint32_t number_expired = 0;
+	int level;
+
+	while (w->now < now) {
+		if (w->number_timers == 0) {
+			w->now = now;
+			break;
+		}
+		tick = w->now + 1;
+		/* when a level wraps around, bring down the next slot above it */
+		for (level = 1; level < TIMERWHEEL_LEVELS; level++) {
+			if ((tick & ((UINT64_C(1) << (level * TIMERWHEEL_SLOT_BITS)) - 1)) != 0) {
+				break;
+			}
+			timerwheel_cascade(w, &w->slots[level][(tick >> (level * TIMERWHEEL_SLOT_BITS))
+			                                       & TIMERWHEEL_SLOT_MASK]);
+		}
+		slot = &w->slots[0][tick & TIMERWHEEL_SLOT_MASK];
+		for (link = ideque_peekleft(slot); link != NULL; link = ideque_next(slot, link)) {
+			TIMERWHEEL_TIMER(link)->bucket = expired;
+		}
+		number_expired += ideque_count(slot);
+		w->number_timers -= ideque_count(slot);
+		ideque_splice(expired, slot);
+		w->now = tick;
+	}
+	return number_expired;
+}
+
+/* Return the number of pending timers */
+uint32_t
+timerwheel_count(TimerWheel w) {
+	return w->number_timers;
+}
+
+/* Return the last tick processed */
+uint64_t
+timerwheel_now(TimerWheel w) {
+	return w->now;
+}
@@ -0,0 +1,72 @@
+/*
+ * timerwheel.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ideque.h"
+
+#define TIMERWHEEL_LEVELS (4)
+#define TIMERWHEEL_SLOT_BITS (8)
+#define TIMERWHEEL_SLOTS (1 << TIMERWHEEL_SLOT_BITS)
+
+/* Embed one of these in each object that needs a timeout.  The link is
+ * also what ends up in the expired deque handed to timerwheel_advance(),
+ * so the timer is recovered with TIMERWHEEL_TIMER() and the object around
+ * it with IDEQUE_ENTRY() or the caller's own container macro.
+ */
+struct timerwheel_timer_t {
+	struct ideque_link_t link;
+	uint64_t expires;
+	IDeque bucket;
+};
+
+/* Level 0 has a slot per tick for the next TIMERWHEEL_SLOTS ticks, and
+ * each level above covers TIMERWHEEL_SLOTS times the span of the one below
+ * with the same number of slots.  now is the last tick processed.
+ */
+struct timerwheel_t {
+	uint64_t now;
+	uint32_t number_timers;
+	struct ideque_t slots[TIMERWHEEL_LEVELS][TIMERWHEEL_SLOTS];
+};
+
+typedef struct timerwheel_t *TimerWheel;
+typedef struct timerwheel_timer_t *TimerWheelTimer;
+
+#define TIMERWHEEL_TIMER(l) IDEQUE_ENTRY(l, struct timerwheel_timer_t, link)
+
+TimerWheel  timerwheel_create(uint64_t now);
+void        timerwheel_init(TimerWheel w, uint64_t now);
+void        timerwheel_free(TimerWheel w);
+void        timerwheel_timer_init(TimerWheelTimer t);
+void        timerwheel_schedule(TimerWheel w, TimerWheelTimer t, uint64_t expires);
+bool        timerwheel_cancel(TimerWheel w, TimerWheelTimer t);
+bool        timerwheel_pending(TimerWheel w, TimerWheelTimer t);
+uint32_t    timerwheel_advance(TimerWheel w, uint64_t now, IDeque expired);
+uint32_t    timerwheel_count(TimerWheel w);
+uint64_t    timerwheel_now(TimerWheel w);
+#endif
@@ -0,0 +1,246 @@
+/*
+ * workpool.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A small fork/join thread pool built on the work-stealing deque.
+ *
+ * Each worker owns a WSDeque.  Spawned tasks are pushed onto the spawning
+ * worker's deque; idle workers steal from a randomly chosen victim.  A worker
+ * waiting in workpool_sync() keeps executing tasks (its own first, then stolen
+ * ones) until the group it is waiting on has drained, so no thread ever blocks
+ * while there is work to do.
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include <sched.h>
+#include "workpool.h"
+
+/* The worker the current thread is acting as, or NULL outside of a pool */
+static _Thread_local struct workpool_worker_t *current_worker = NULL;
+
+/* xorshift32, good enough for picking steal victims */
+static uint32_t
+workpool_random(struct workpool_worker_t *w) {
+	uint32_t x = w->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	w->seed = x;
+	return x;
+}
+
+static void
+workpool_execute(struct workpool_task_t *t) {
+	struct workpool_group_t *g = t->group;
+	t->func(t->arg);
+	/* t may live on a stack that is unwound as soon as pending hits zero */
+	atomic_fetch_sub_explicit(&g->pending, 1, memory_order_release);
+}
+
+/* Find a task for worker w to run: its own deque first, then steal */
+static struct workpool_task_t *
+workpool_find_task(struct workpool_worker_t *w) {
+	struct workpool_t *p = w->pool;
+	struct workpool_task_t *t;
+	uint32_t i, victim;
+
+	if ((t = wsdeque_pop(&w->deque)) != NULL) {
+		return t;
+	}
+	if (p->number_workers < 2) {
+		return NULL;
+	}
+	for (i = 0; i < p->number_workers; i++) {
+		victim = workpool_random(w) % p->number_workers;
+		if (victim == w->index) {
+			continue;
+		}
+		if ((t = wsdeque_steal(&p->workers[victim].deque)) != NULL) {
+			return t;
+		}
+	}
+	return NULL;
+}
+
+static void *
+workpool_thread(void *arg) {
+	struct workpool_worker_t *w = arg;
+	struct workpool_t *p = w->pool;
+	struct workpool_task_t *t;
+
+	current_worker = w;
+	while (!atomic_load_explicit(&p->shutdown, memory_order_acquire)) {
+		if (!atomic_load_explicit(&p->running, memory_order_acquire)) {
+			pthread_mutex_lock(&p->lock);
+			while (!atomic_load(&p->running) && !atomic_load(&p->shutdown)) {
+				pthread_cond_wait(&p->wake, &p->lock);
+			}
+			pthread_mutex_unlock(&p->lock);
+			continue;
+		}
+		if ((t = workpool_find_task(w)) != NULL) {
+			workpool_execute(t);
+		} else {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+/* Stop and join workers 1 to started - 1, destroy the deques of workers 0
+ * to initialised - 1 and free the pool
+ */
+static void
+workpool_teardown(WorkPool p, uint32_t initialised, uint32_t started) {
+	uint32_t i;
+	pthread_mutex_lock(&p->lock);
+	atomic_store(&p->shutdown, true);
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+	for (i = 1; i < started; i++) {
+		pthread_join(p->workers[i].thread, NULL);
+	}
+	for (i = 0; i < initialised; i++) {
+		wsdeque_destroy(&p->workers[i].deque);
+	}
+	pthread_cond_destroy(&p->wake);
+	pthread_mutex_destroy(&p->lock);
+	free(p->workers);
+	free(p);
+}
+
+/* Create a pool with number_workers workers.  The thread calling
+ * workpool_run() acts as one of the workers, so number_workers - 1 threads
+ * are started.  Returns NULL if resources could not be allocated.
+ */
+WorkPool
+workpool_create(uint32_t number_workers) {
+	WorkPool p;
+	uint32_t i, started;
+
+	if (number_workers == 0) {
+		number_workers = 1;
+	}
+	if ((p = malloc(sizeof(struct workpool_t))) == NULL) {
+		return NULL;
+	}
+	if ((p->workers = calloc(number_workers, sizeof(struct workpool_worker_t))) == NULL) {
+		free(p);
+		return NULL;
+	}
+	p->number_workers = number_workers;
+	atomic_init(&p->running, false);
+	atomic_init(&p->shutdown, false);
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->wake, NULL);
+
+	for (i = 0; i < number_workers; i++) {
+		p->workers[i].pool = p;
+		p->workers[i].index = i;
+		p->workers[i].seed = 2463534242u + i * 7919u;
+		if (wsdeque_init(&p->workers[i].deque, 0) != WSDEQUE_SUCCESS) {
+			workpool_teardown(p, i, 1);
+			return NULL;
+		}
+	}
+
+	/* worker 0 is the thread calling workpool_run() */
+	for (started = 1; started < number_workers; started++) {
+		if (pthread_create(&p->workers[started].thread, NULL,
+				workpool_thread, &p->workers[started]) != 0) {
+			break;
+		}
+	}
+	if (started < number_workers) {
+		workpool_teardown(p, number_workers, started);
+		return NULL;
+	}
+	return p;
+}
+
+/* Stop all worker threads and free the pool */
+void
+workpool_free(WorkPool p) {
+	workpool_teardown(p, p->number_workers, p->number_workers);
+}
+
+/* Run func(arg) on the calling thread with the pool's workers available to
+ * steal anything it spawns.  func must sync every group it spawns into
+ * before returning.  Only one thread may call workpool_run() on a given
+ * pool at a time.
+ */
+void
+workpool_run(WorkPool p, workpool_func_t func, void *arg) {
+	struct workpool_worker_t *prev = current_worker;
+
+	pthread_mutex_lock(&p->lock);
+	atomic_store(&p->running, true);
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+
+	current_worker = &p->workers[0];
+	func(arg);
+	current_worker = prev;
+
+	atomic_store(&p->running, false);
+}
+
+/* Initialize a task group before spawning into it */
+void
+workpool_group_init(struct workpool_group_t *g) {
+	atomic_init(&g->pending, 0);
+}
+
+/* Spawn func(arg) as part of group g, using t as the task storage.  t must
+ * stay valid until workpool_sync() on g returns.
+ *
+ * Outside of workpool_run(), or if the deque cannot grow, the task is simply
+ * run inline.
+ */
+void
+workpool_spawn(struct workpool_group_t *g, struct workpool_task_t *t,
+               workpool_func_t func, void *arg) {
+	struct workpool_worker_t *w = current_worker;
+	t->func = func;
+	t->arg = arg;
+	t->group = g;
+	atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+	if (w == NULL || wsdeque_push(&w->deque, t) != WSDEQUE_SUCCESS) {
+		workpool_execute(t);
+	}
+}
+
+/* Wait for every task spawned into g to finish, running other tasks while
+ * waiting.
+ */
+void
+workpool_sync(struct workpool_group_t *g) {
+	struct workpool_worker_t *w = current_worker;
+	struct workpool_task_t *t;
+	while (atomic_load_explicit(&g->pending, memory_order_acquire) > 0) {
+		if (w != NULL && (t = workpool_find_task(w)) != NULL) {
+			workpool_execute(t);
+		} else {
+			sched_yield();
+		}
+	}
+}
@@ -0,0 +1,76 @@
+/*
+ * workpool.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "wsdeque.h"
+
+typedef void (*workpool_func_t)(void *arg);
+
+/* A set of spawned tasks that can be waited on with workpool_sync() */
+struct workpool_group_t {
+	atomic_uint_fast32_t pending;
+};
+
+/* Task storage is provided by the caller (usually on the stack of the
+ * function that spawns and then syncs), so spawning never allocates.
+ */
+struct workpool_task_t {
+	workpool_func_t func;
+	void *arg;
+	struct workpool_group_t *group;
+};
+
+struct workpool_worker_t {
+	struct wsdeque_t deque;
+	struct workpool_t *pool;
+	pthread_t thread;
+	uint32_t index;
+	uint32_t seed;
+};
+
+struct workpool_t {
+	struct workpool_worker_t *workers;
+	uint32_t number_workers;
+	atomic_bool running;
+	atomic_bool shutdown;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+};
+
+typedef struct workpool_t *WorkPool;
+
+WorkPool  workpool_create(uint32_t number_workers);
+void      workpool_free(WorkPool p);
+void      workpool_run(WorkPool p, workpool_func_t func, void *arg);
+void      workpool_group_init(struct workpool_group_t *g);
+void      workpool_spawn(struct workpool_group_t *g, struct workpool_task_t *t,
+                         workpool_func_t func, void *arg);
+void      workpool_sync(struct workpool_group_t *g);
+#endif
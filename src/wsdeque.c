@@ -0,0 +1,246 @@
+/*
+ * wsdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * A lock-free work-stealing deque (Chase and Lev, "Dynamic Circular
+ * Work-Stealing Deque", SPAA 2005) using the C11 memory model mapping from
+ * Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+ * Weak Memory Models", PPoPP 2013.
+ *
+ * A single owner thread pushes and pops at the bottom of the deque (LIFO) while
+ * any number of thief threads steal from the top (FIFO).  Like the deque module,
+ * only pointers are stored and NULL is reserved to mean "nothing there".
+ */
+#include <stdlib.h>
+#include <assert.h>
+#include "wsdeque.h"
+
+/* Allocate a circular array able to hold capacity items.  capacity must be
+ * a power of two so that indices can be wrapped with a mask.
+ */
+static struct wsdeque_array_t *
+wsdeque_array_alloc(int64_t capacity) {
+	struct wsdeque_array_t *a;
+	int64_t i;
+	a = malloc(sizeof(struct wsdeque_array_t) + capacity * sizeof(_Atomic(void*)));
+	if (a != NULL) {
+		a->mask = capacity - 1;
+		a->retired = NULL;
+		for (i = 0; i < capacity; i++) {
+			atomic_init(&a->buffer[i], NULL);
+		}
+	}
+	return a;
+}
+
+/* Grow the array to twice its size, copying over the live range [t, b).
+ *
+ * Thieves may still be reading from the old array, so it cannot be freed
+ * here.  Instead it is chained onto the new array and released when the
+ * deque itself is destroyed.  Because the array doubles each time, the
+ * retired arrays never take up more memory than the live one.
+ */
+static struct wsdeque_array_t *
+wsdeque_grow(WSDeque d, struct wsdeque_array_t *a, int64_t t, int64_t b) {
+	struct wsdeque_array_t *newArray;
+	int64_t i;
+	newArray = wsdeque_array_alloc(2 * (a->mask + 1));
+	if (newArray == NULL) {
+		return NULL;
+	}
+	for (i = t; i < b; i++) {
+		atomic_store_explicit(&newArray->buffer[i & newArray->mask],
+			atomic_load_explicit(&a->buffer[i & a->mask], memory_order_relaxed),
+			memory_order_relaxed);
+	}
+	newArray->retired = a;
+	atomic_store_explicit(&d->array, newArray, memory_order_release);
+	return newArray;
+}
+
+/* Round capacity up to the next power of two (minimum of 2) */
+static int64_t
+wsdeque_capacity(uint32_t capacity) {
+	int64_t size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	return size;
+}
+
+/* Initialize a work-stealing deque that has already been allocated.
+ *
+ * The capacity is only a starting point, the deque grows as needed.  A
+ * capacity of 0 selects WSDEQUE_DEFAULT_CAPACITY.
+ */
+wsdeque_result_t
+wsdeque_init(WSDeque d, uint32_t capacity) {
+	struct wsdeque_array_t *a;
+	assert(d != NULL);
+	if (capacity == 0) {
+		capacity = WSDEQUE_DEFAULT_CAPACITY;
+	}
+	a = wsdeque_array_alloc(wsdeque_capacity(capacity));
+	if (a == NULL) {
+		return WSDEQUE_ALLOC_ERROR;
+	}
+	atomic_init(&d->top, 0);
+	atomic_init(&d->bottom, 0);
+	atomic_init(&d->array, a);
+	return WSDEQUE_SUCCESS;
+}
+
+/* Create a work-stealing deque and return a reference, or NULL if memory
+ * could not be allocated.
+ */
+WSDeque
+wsdeque_create(uint32_t capacity) {
+	WSDeque d = malloc(sizeof(struct wsdeque_t));
+	if (d != NULL && wsdeque_init(d, capacity) != WSDEQUE_SUCCESS) {
+		free(d);
+		d = NULL;
+	}
+	return d;
+}
+
+/* Release the arrays owned by a deque initialized with wsdeque_init().
+ *
+ * No other thread may be using the deque when this is called.
+ */
+void
+wsdeque_destroy(WSDeque d) {
+	struct wsdeque_array_t *a;
+	struct wsdeque_array_t *next;
+	a = atomic_load_explicit(&d->array, memory_order_relaxed);
+	while (a != NULL) {
+		next = a->retired;
+		free(a);
+		a = next;
+	}
+	atomic_store_explicit(&d->array, NULL, memory_order_relaxed);
+}
+
+/* Free a deque allocated with wsdeque_create() */
+void
+wsdeque_free(WSDeque d) {
+	wsdeque_destroy(d);
+	free(d);
+}
+
+/* Push an item onto the bottom of the deque.  Owner thread only.
+ *
+ * This operation is O(1) amortized, the array doubles when full.
+ */
+wsdeque_result_t
+wsdeque_push(WSDeque d, void* item) {
+	int64_t b, t;
+	struct wsdeque_array_t *a;
+	assert(item != NULL);
+
+	b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+	t = atomic_load_explicit(&d->top, memory_order_acquire);
+	a = atomic_load_explicit(&d->array, memory_order_relaxed);
+	if (b - t > a->mask) {
+		if ((a = wsdeque_grow(d, a, t, b)) == NULL) {
+			return WSDEQUE_ALLOC_ERROR;
+		}
+	}
+	atomic_store_explicit(&a->buffer[b & a->mask], item, memory_order_relaxed);
+	atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+	return WSDEQUE_SUCCESS;
+}
+
+/* Pop the most recently pushed item from the bottom of the deque.  Owner
+ * thread only.  Returns NULL if the deque is empty or a thief took the last
+ * item first.
+ *
+ * This operation is O(1), constant time.
+ */
+void*
+wsdeque_pop(WSDeque d) {
+	int64_t b, t;
+	struct wsdeque_array_t *a;
+	void* item;
+
+	b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+	a = atomic_load_explicit(&d->array, memory_order_relaxed);
+	atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+	if (t > b) {
+		/* empty, restore bottom */
+		atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	item = atomic_load_explicit(&a->buffer[b & a->mask], memory_order_relaxed);
+	if (t == b) {
+		/* last item, race the thieves for it */
+		if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+				memory_order_seq_cst, memory_order_relaxed)) {
+			item = NULL;
+		}
+		atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+	}
+	return item;
+}
+
+/* Steal the oldest item from the top of the deque.  May be called from any
+ * thread.  Returns NULL if the deque is empty or another thread won the race
+ * for the top item, in which case the caller should simply try again or move
+ * on to another victim.
+ *
+ * This operation is O(1), constant time.
+ */
+void*
+wsdeque_steal(WSDeque d) {
+	int64_t b, t;
+	struct wsdeque_array_t *a;
+	void* item;
+
+	t = atomic_load_explicit(&d->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+	if (t >= b) {
+		return NULL;
+	}
+
+	a = atomic_load_explicit(&d->array, memory_order_acquire);
+	item = atomic_load_explicit(&a->buffer[t & a->mask], memory_order_relaxed);
+	if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+			memory_order_seq_cst, memory_order_relaxed)) {
+		return NULL;
+	}
+	return item;
+}
+
+/* Return the number of items in the deque.  When other threads are active
+ * this is only a snapshot.
+ */
+uint32_t
+wsdeque_count(WSDeque d) {
+	int64_t b, t;
+	b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+	t = atomic_load_explicit(&d->top, memory_order_relaxed);
+	return b > t ? (uint32_t)(b - t) : 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * wsdeque.h
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WSDEQUE_H
+#define WSDEQUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define WSDEQUE_DEFAULT_CAPACITY (64)
+
+typedef enum {
+	WSDEQUE_SUCCESS = 0,
+	WSDEQUE_FAILURE = 1,
+	WSDEQUE_ALLOC_ERROR = 2
+} wsdeque_result_t;
+
+struct wsdeque_array_t {
+	int64_t mask;
+	struct wsdeque_array_t *retired;
+	_Atomic(void*) buffer[];
+};
+
+struct wsdeque_t {
+	atomic_int_fast64_t top;
+	atomic_int_fast64_t bottom;
+	_Atomic(struct wsdeque_array_t*) array;
+};
+
+typedef struct wsdeque_t *WSDeque;
+
+WSDeque           wsdeque_create(uint32_t capacity);
+wsdeque_result_t  wsdeque_init(WSDeque d, uint32_t capacity);
+void              wsdeque_destroy(WSDeque d);
+void              wsdeque_free(WSDeque d);
+wsdeque_result_t  wsdeque_push(WSDeque d, void* item);
+void*             wsdeque_pop(WSDeque d);
+void*             wsdeque_steal(WSDeque d);
+uint32_t          wsdeque_count(WSDeque d);
+#endif
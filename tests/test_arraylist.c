@@ -28,6 +28,7 @@
 #include <string.h>
 #include "tests.h"
 #include "../src/arraylist.h"
+#include "../src/bloomfilter.h"
 
 /** TEST UTILITY FUNCTIONS **/
 char*
@@ -321,6 +322,294 @@ START_TEST (test_arraylist_quicksort) {
 }
 END_TEST
 
+static int8_t
+int_comparator(void* a, void* b) {
+	intptr_t x = (intptr_t) a, y = (intptr_t) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* items compare by their value divided by 10000, so the low digits record
+ * which list and position each came from
+ */
+static int8_t
+coarse_comparator(void* a, void* b) {
+	return int_comparator((void*) ((intptr_t) a / 10000), (void*) ((intptr_t) b / 10000));
+}
+
+/* arraylist_merge_k */
+START_TEST (test_arraylist_merge_k) {
+	ArrayList lists[13], out;
+	intptr_t item, prev;
+	unsigned int seed = 3;
+	uint32_t i, j, n, total = 0;
+	
+	/* sorted lists of assorted lengths, some empty, with many ties */
+	for (i = 0; i < 13; i++) {
+		lists[i] = arraylist_create(coarse_comparator);
+		n = (i % 4 == 0) ? 0 : i * 7;
+		item = 0;
+		for (j = 0; j < n; j++) {
+			seed = seed * 1103515245 + 12345;
+			item += ((seed >> 16) % 3) * 10000;
+			arraylist_append(lists[i], (void*) (item + i * 100 + j));
+		}
+		total += n;
+	}
+	out = arraylist_create(coarse_comparator);
+	fail_unless(arraylist_merge_k(lists, 13, out) == ARRAYLIST_SUCCESS);
+	fail_unless(arraylist_count(out) == total);
+	
+	/* sorted, and equal keys keep list order then position order */
+	for (i = 1; i < total; i++) {
+		prev = (intptr_t) arraylist_getitem(out, i - 1);
+		item = (intptr_t) arraylist_getitem(out, i);
+		fail_unless(prev / 10000 < item / 10000
+		            || (prev / 10000 == item / 10000 && prev % 10000 < item % 10000));
+	}
+	
+	/* merging again appends after what is already there */
+	fail_unless(arraylist_merge_k(lists, 1, out) == ARRAYLIST_SUCCESS);
+	fail_unless(arraylist_merge_k(lists, 0, out) == ARRAYLIST_SUCCESS);
+	fail_unless(arraylist_count(out) == total);
+	arraylist_free(out);
+	for (i = 0; i < 13; i++) {
+		arraylist_free(lists[i]);
+	}
+}
+END_TEST
+
+/* arraylist_merge_create, arraylist_merge_next */
+START_TEST (test_arraylist_merge_batches) {
+	ArrayList lists[5], out;
+	ArrayListMerge merge;
+	void *batch[7];
+	intptr_t i;
+	uint32_t n, merged = 0;
+	
+	/* list i holds the multiples of i + 2 below 200 */
+	for (i = 0; i < 5; i++) {
+		intptr_t x;
+		lists[i] = arraylist_create(int_comparator);
+		for (x = 0; x < 200; x += i + 2) {
+			arraylist_append(lists[i], (void*) x);
+		}
+	}
+	out = arraylist_create(int_comparator);
+	arraylist_merge_k(lists, 5, out);
+	
+	merge = arraylist_merge_create(lists, 5, int_comparator);
+	fail_if(merge == NULL);
+	while ((n = arraylist_merge_next(merge, batch, 7)) > 0) {
+		fail_unless(n == 7 || merged + n == arraylist_count(out));
+		for (i = 0; i < n; i++) {
+			fail_unless(batch[i] == arraylist_getitem(out, merged++));
+		}
+	}
+	fail_unless(merged == arraylist_count(out));
+	fail_unless(arraylist_merge_next(merge, batch, 7) == 0);
+	arraylist_merge_free(merge);
+	arraylist_free(out);
+	for (i = 0; i < 5; i++) {
+		arraylist_free(lists[i]);
+	}
+}
+END_TEST
+
+static uint32_t comparisons;
+
+static int8_t
+counting_comparator(void* a, void* b) {
+	comparisons++;
+	return coarse_comparator(a, b);
+}
+
+/* A sorted list of n items with keys below range, each tagged with the
+ * given low digit
+ */
+static ArrayList
+create_sorted_list(uint32_t n, uint32_t range, intptr_t tag, unsigned int *seed) {
+	ArrayList l = arraylist_create(counting_comparator);
+	static uint32_t counts[1000];
+	uint32_t i, j;
+	memset(counts, 0, sizeof(counts));
+	for (i = 0; i < n; i++) {
+		*seed = *seed * 1103515245 + 12345;
+		counts[(*seed >> 8) % range]++;
+	}
+	for (i = 0; i < range; i++) {
+		for (j = 0; j < counts[i]; j++) {
+			arraylist_append(l, (void*) (i * (intptr_t) 10000 + tag));
+		}
+	}
+	return l;
+}
+
+/* Check that out is sorted and holds each key as often as op says */
+static void
+check_set_result(ArrayList a, ArrayList b, ArrayList out, int op) {
+	static uint32_t ca[1000], cb[1000], co[1000];
+	uint32_t i, expected;
+	memset(ca, 0, sizeof(ca));
+	memset(cb, 0, sizeof(cb));
+	memset(co, 0, sizeof(co));
+	for (i = 0; i < arraylist_count(a); i++) {
+		ca[(intptr_t) arraylist_getitem(a, i) / 10000]++;
+	}
+	for (i = 0; i < arraylist_count(b); i++) {
+		cb[(intptr_t) arraylist_getitem(b, i) / 10000]++;
+	}
+	for (i = 0; i < arraylist_count(out); i++) {
+		co[(intptr_t) arraylist_getitem(out, i) / 10000]++;
+		fail_unless(i == 0 || coarse_comparator(arraylist_getitem(out, i - 1),
+		                                        arraylist_getitem(out, i)) <= 0);
+	}
+	for (i = 0; i < 1000; i++) {
+		if (op == 0) {
+			expected = ca[i] > cb[i] ? ca[i] : cb[i];
+		} else if (op == 1) {
+			expected = ca[i] < cb[i] ? ca[i] : cb[i];
+		} else {
+			expected = ca[i] > cb[i] ? ca[i] - cb[i] : 0;
+		}
+		fail_unless(co[i] == expected);
+	}
+}
+
+/* arraylist_union, arraylist_intersection, arraylist_difference */
+START_TEST (test_arraylist_set_algebra) {
+	uint32_t sizes[][2] = {{0, 0}, {0, 50}, {50, 0}, {200, 200}, {5, 900}, {900, 5}, {300, 40}};
+	unsigned int seed = 11;
+	ArrayList a, b, out;
+	uint32_t i, t;
+	int op;
+	
+	for (t = 0; t < sizeof(sizes) / sizeof(sizes[0]); t++) {
+		a = create_sorted_list(sizes[t][0], 300, 1, &seed);
+		b = create_sorted_list(sizes[t][1], 300, 2, &seed);
+		for (op = 0; op < 3; op++) {
+			out = arraylist_create(coarse_comparator);
+			if (op == 0) {
+				fail_unless(arraylist_union(a, b, out) == ARRAYLIST_SUCCESS);
+			} else if (op == 1) {
+				fail_unless(arraylist_intersection(a, b, out) == ARRAYLIST_SUCCESS);
+				
+				/* the items written are a's */
+				for (i = 0; i < arraylist_count(out); i++) {
+					fail_unless((intptr_t) arraylist_getitem(out, i) % 10000 == 1);
+				}
+			} else {
+				fail_unless(arraylist_difference(a, b, out) == ARRAYLIST_SUCCESS);
+			}
+			check_set_result(a, b, out, op);
+			arraylist_free(out);
+		}
+		arraylist_free(a);
+		arraylist_free(b);
+	}
+}
+END_TEST
+
+/* galloping keeps skewed intersections close to k log n comparisons */
+START_TEST (test_arraylist_intersection_skewed) {
+	ArrayList a = arraylist_create(counting_comparator);
+	ArrayList b = arraylist_create(counting_comparator);
+	ArrayList out = arraylist_create(coarse_comparator);
+	intptr_t i;
+	
+	for (i = 0; i < 100; i++) {
+		arraylist_append(a, (void*) (i * 1000 * 10000 + 1));
+	}
+	for (i = 0; i < 100000; i++) {
+		arraylist_append(b, (void*) (i * 10000 + 2));
+	}
+	comparisons = 0;
+	fail_unless(arraylist_intersection(a, b, out) == ARRAYLIST_SUCCESS);
+	fail_unless(arraylist_count(out) == 100);
+	fail_unless(comparisons < 100 * 40);
+	arraylist_free(out);
+	
+	out = arraylist_create(coarse_comparator);
+	comparisons = 0;
+	fail_unless(arraylist_difference(b, a, out) == ARRAYLIST_SUCCESS);
+	fail_unless(arraylist_count(out) == 100000 - 100);
+	fail_unless(comparisons < 100 * 40);
+	arraylist_free(out);
+	arraylist_free(a);
+	arraylist_free(b);
+}
+END_TEST
+
+/* arraylist_unique */
+START_TEST (test_arraylist_unique) {
+	ArrayList l = arraylist_create(int_comparator);
+	intptr_t items[] = {1, 1, 2, 3, 3, 3, 7, 9, 9};
+	intptr_t expected[] = {1, 2, 3, 7, 9};
+	uint32_t i;
+	
+	fail_unless(arraylist_unique(l) == 0);
+	for (i = 0; i < 9; i++) {
+		arraylist_append(l, (void*) items[i]);
+	}
+	fail_unless(arraylist_unique(l) == 5);
+	for (i = 0; i < 5; i++) {
+		fail_unless(arraylist_getitem(l, i) == (void*) expected[i]);
+	}
+	arraylist_free(l);
+}
+END_TEST
+
+#ifdef ARRAYLIST_FILTER
+/* arraylist_set_filter */
+START_TEST (test_arraylist_filter) {
+	ArrayList l = arraylist_create(int_comparator);
+	ArrayList other = arraylist_create(int_comparator);
+	ArrayList merged = arraylist_create(int_comparator);
+	ArrayList lists[2];
+	BloomFilter f = bloomfilter_create(1000, NULL);
+	intptr_t i;
+	
+	for (i = 1; i <= 10; i++) {
+		arraylist_append(l, (void*) (i * 8));
+	}
+	arraylist_set_filter(l, f);
+	fail_unless(bloomfilter_count(f) == 10);
+	arraylist_append(l, (void*) 88);
+	arraylist_insert(l, 0, (void*) 4);
+	fail_unless(arraylist_remove(l, (void*) 16) == (void*) 16);
+	fail_unless(arraylist_pop(l) == (void*) 88);
+	fail_unless(arraylist_pop_item(l, 0) == (void*) 4);
+	fail_unless(bloomfilter_count(f) == arraylist_count(l));
+	fail_unless(arraylist_contains(l, (void*) 80));
+	fail_if(arraylist_contains(l, (void*) 16));
+	fail_if(arraylist_contains(l, (void*) 88));
+	fail_unless(arraylist_remove(l, (void*) 4) == NULL);
+	
+	/* lists filled by the sorted list operations keep their filter too */
+	arraylist_set_filter(l, NULL);
+	arraylist_set_filter(merged, f);
+	for (i = 1; i <= 5; i++) {
+		arraylist_append(other, (void*) (i * 8));
+	}
+	lists[0] = l;
+	lists[1] = other;
+	arraylist_merge_k(lists, 2, merged);
+	arraylist_unique(merged);
+	arraylist_difference(l, other, merged);
+	arraylist_intersection(l, other, merged);
+	arraylist_union(l, other, merged);
+	fail_unless(bloomfilter_count(f) == arraylist_count(merged));
+	for (i = 0; i < arraylist_count(merged); i++) {
+		fail_unless(arraylist_contains(merged, arraylist_getitem(merged, i)));
+	}
+	fail_if(arraylist_contains(merged, (void*) 1000));
+	bloomfilter_free(f);
+	arraylist_free(l);
+	arraylist_free(other);
+	arraylist_free(merged);
+}
+END_TEST
+#endif /* ARRAYLIST_FILTER */
+
 Suite*
 arraylist_suite(void) {
 	Suite *s = suite_create("List");
@@ -340,6 +629,14 @@ arraylist_suite(void) {
 	tcase_add_test(tc_core, test_arraylist_index);
 	tcase_add_test(tc_core, test_arraylist_reverse);
 	tcase_add_test(tc_core, test_arraylist_quicksort);
+	tcase_add_test(tc_core, test_arraylist_merge_k);
+	tcase_add_test(tc_core, test_arraylist_merge_batches);
+	tcase_add_test(tc_core, test_arraylist_set_algebra);
+	tcase_add_test(tc_core, test_arraylist_intersection_skewed);
+	tcase_add_test(tc_core, test_arraylist_unique);
+#ifdef ARRAYLIST_FILTER
+	tcase_add_test(tc_core, test_arraylist_filter);
+#endif
 	
 	suite_add_tcase(s, tc_core);
 	return s;
@@ -0,0 +1,142 @@
+/* 
+ * test_blockingdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <time.h>
+#include "tests.h"
+#include "../src/blockingdeque.h"
+
+#define BD_ITEMS (100000)
+
+START_TEST (test_blockingdeque_create) {
+	BlockingDeque d = blockingdeque_create();
+	fail_if(d == NULL);
+	fail_unless(blockingdeque_count(d) == 0);
+	fail_unless(blockingdeque_popleft(d) == NULL);
+	blockingdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_blockingdeque_append_popleft) {
+	BlockingDeque d = blockingdeque_create();
+	char* ts[] = {"t1", "t2", "t3"};
+	blockingdeque_append(d, ts[0]);
+	blockingdeque_append(d, ts[1]);
+	blockingdeque_append(d, ts[2]);
+	fail_unless(blockingdeque_count(d) == 3);
+	fail_unless(blockingdeque_popleft(d) == ts[0]);
+	fail_unless(blockingdeque_popleft_wait(d, 10) == ts[1]);
+	fail_unless(blockingdeque_popleft_wait(d, BLOCKINGDEQUE_WAIT_FOREVER) == ts[2]);
+	fail_unless(blockingdeque_popleft(d) == NULL);
+	fail_unless(blockingdeque_count(d) == 0);
+	blockingdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_blockingdeque_timeout) {
+	BlockingDeque d = blockingdeque_create();
+	struct timespec start, end;
+	long elapsed_ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	fail_unless(blockingdeque_popleft_wait(d, 50) == NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	elapsed_ms = (end.tv_sec - start.tv_sec) * 1000
+		+ (end.tv_nsec - start.tv_nsec) / 1000000;
+	fail_unless(elapsed_ms >= 49);
+	blockingdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_blockingdeque_drain) {
+	BlockingDeque d = blockingdeque_create();
+	char* ts[] = {"t1", "t2", "t3", "t4", "t5"};
+	void* out[4];
+	uint32_t i;
+
+	fail_unless(blockingdeque_drain(d, out, 4) == 0);
+	for (i = 0; i < 5; i++) {
+		blockingdeque_append(d, ts[i]);
+	}
+	fail_unless(blockingdeque_drain(d, out, 4) == 4);
+	for (i = 0; i < 4; i++) {
+		fail_unless(out[i] == ts[i]);
+	}
+	fail_unless(blockingdeque_count(d) == 1);
+	fail_unless(blockingdeque_drain(d, out, 4) == 1);
+	fail_unless(out[0] == ts[4]);
+	fail_unless(blockingdeque_count(d) == 0);
+	blockingdeque_free(d);
+}
+END_TEST
+
+static void *
+bd_producer(void *arg) {
+	BlockingDeque d = arg;
+	uintptr_t i;
+	for (i = 1; i <= BD_ITEMS; i++) {
+		blockingdeque_append(d, (void*) i);
+	}
+	return NULL;
+}
+
+START_TEST (test_blockingdeque_threads) {
+	BlockingDeque d = blockingdeque_create();
+	pthread_t producer;
+	uintptr_t expected = 1;
+	void* out[32];
+	uint32_t i, n;
+
+	pthread_create(&producer, NULL, bd_producer, d);
+	while (expected <= BD_ITEMS) {
+		out[0] = blockingdeque_popleft_wait(d, BLOCKINGDEQUE_WAIT_FOREVER);
+		fail_unless(out[0] == (void*) expected++);
+		/* an item is counted before a consumer can take it */
+		fail_unless(blockingdeque_count(d) <= BD_ITEMS);
+		n = blockingdeque_drain(d, out, 32);
+		for (i = 0; i < n; i++) {
+			fail_unless(out[i] == (void*) expected++);
+		}
+	}
+	pthread_join(producer, NULL);
+	fail_unless(blockingdeque_count(d) == 0);
+	blockingdeque_free(d);
+}
+END_TEST
+
+Suite*
+blockingdeque_suite(void) {
+	Suite *s = suite_create("BlockingDeque");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("BlockingDeque");
+	tcase_add_test(tc_core, test_blockingdeque_create);
+	tcase_add_test(tc_core, test_blockingdeque_append_popleft);
+	tcase_add_test(tc_core, test_blockingdeque_timeout);
+	tcase_add_test(tc_core, test_blockingdeque_drain);
+	tcase_add_test(tc_core, test_blockingdeque_threads);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,114 @@
+/* 
+ * test_bloomfilter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/bloomfilter.h"
+
+START_TEST (test_bloomfilter_membership) {
+	BloomFilter f = bloomfilter_create(10000, NULL);
+	uintptr_t i;
+	uint32_t passed = 0;
+	
+	fail_if(f == NULL);
+	for (i = 1; i <= 10000; i++) {
+		bloomfilter_add(f, (void*) (i * 16));
+	}
+	fail_unless(bloomfilter_count(f) == 10000);
+	
+	/* no false negatives, and few false positives at the sized load */
+	for (i = 1; i <= 10000; i++) {
+		fail_unless(bloomfilter_contains(f, (void*) (i * 16)));
+	}
+	for (i = 1; i <= 100000; i++) {
+		passed += bloomfilter_contains(f, (void*) (i * 16 + 8));
+	}
+	fail_unless(passed < 1000);
+	fail_unless(bloomfilter_estimated_fp_rate(f) < 0.01);
+	fail_unless(bloomfilter_estimated_fp_rate(f) > 0.0001);
+	
+	/* removed items are turned away again */
+	for (i = 1; i <= 10000; i += 2) {
+		bloomfilter_remove(f, (void*) (i * 16));
+	}
+	passed = 0;
+	for (i = 1; i <= 10000; i++) {
+		if (i % 2 == 0) {
+			fail_unless(bloomfilter_contains(f, (void*) (i * 16)));
+		} else {
+			passed += bloomfilter_contains(f, (void*) (i * 16));
+		}
+	}
+	fail_unless(passed < 50);
+	bloomfilter_clear(f);
+	fail_unless(bloomfilter_count(f) == 0);
+	fail_unless(bloomfilter_estimated_fp_rate(f) == 0);
+	fail_if(bloomfilter_contains(f, (void*) 32));
+	bloomfilter_free(f);
+}
+END_TEST
+
+START_TEST (test_bloomfilter_saturation) {
+	BloomFilter f = bloomfilter_create(1, NULL);
+	uint32_t i;
+	
+	/* counters stick at their limit, so removals never hide an item */
+	for (i = 0; i < 40; i++) {
+		bloomfilter_add(f, (void*) 100);
+	}
+	bloomfilter_add(f, (void*) 200);
+	for (i = 0; i < 40; i++) {
+		bloomfilter_remove(f, (void*) 100);
+	}
+	fail_unless(bloomfilter_contains(f, (void*) 200));
+	fail_unless(bloomfilter_count(f) == 1);
+	bloomfilter_free(f);
+}
+END_TEST
+
+START_TEST (test_bloomfilter_observed_rate) {
+	BloomFilter f = bloomfilter_create(100, NULL);
+	fail_unless(bloomfilter_observed_fp_rate(f) == 0);
+	fail_if(bloomfilter_contains(f, (void*) 8));
+	fail_if(bloomfilter_contains(f, (void*) 16));
+	fail_if(bloomfilter_contains(f, (void*) 24));
+	bloomfilter_note_false_positive(f);
+	fail_unless(f->lookups == 3 && f->rejected == 3);
+	fail_unless(bloomfilter_observed_fp_rate(f) == 0.25);
+	bloomfilter_free(f);
+}
+END_TEST
+
+Suite*
+bloomfilter_suite(void) {
+	Suite *s = suite_create("BloomFilter");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("BloomFilter");
+	tcase_add_test(tc_core, test_bloomfilter_membership);
+	tcase_add_test(tc_core, test_bloomfilter_saturation);
+	tcase_add_test(tc_core, test_bloomfilter_observed_rate);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,174 @@
+/* 
+ * test_bytering.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "tests.h"
+#include "../src/bytering.h"
+
+START_TEST (test_bytering_create) {
+	ByteRing r = bytering_create(8);
+	fail_if(r == NULL);
+	fail_unless(bytering_count(r) == 0);
+	fail_unless(bytering_space(r) == 8);
+	bytering_free(r);
+}
+END_TEST
+
+START_TEST (test_bytering_write_read) {
+	ByteRing r = bytering_create(8);
+	char out[32];
+
+	fail_unless(bytering_write(r, "hello", 5) == 5);
+	fail_unless(bytering_read(r, out, 3) == 3);
+	fail_unless(memcmp(out, "hel", 3) == 0);
+
+	/* wraps around the end of the buffer, then grows */
+	fail_unless(bytering_write(r, "world", 5) == 5);
+	fail_unless(bytering_write(r, "!!!", 3) == 3);
+	fail_unless(bytering_count(r) == 10);
+	fail_unless(bytering_peek(r, out, 32) == 10);
+	fail_unless(memcmp(out, "loworld!!!", 10) == 0);
+	fail_unless(bytering_consume(r, 2) == 2);
+	fail_unless(bytering_read(r, out, 32) == 8);
+	fail_unless(memcmp(out, "world!!!", 8) == 0);
+	bytering_free(r);
+}
+END_TEST
+
+START_TEST (test_bytering_static) {
+	struct bytering_t r;
+	uint8_t buffer[4];
+	bytering_init_static(&r, buffer, 4);
+	fail_unless(bytering_write(&r, "abcdef", 6) == 4);
+	fail_unless(bytering_reserve(&r, 1) == BYTERING_FAILURE);
+	fail_unless(bytering_space(&r) == 0);
+}
+END_TEST
+
+START_TEST (test_bytering_reserve_limit) {
+	ByteRing r = bytering_create(8);
+	fail_unless(bytering_write(r, "abc", 3) == 3);
+	fail_unless(bytering_reserve(r, BYTERING_MAX_SIZE - 2) == BYTERING_ALLOC_ERROR);
+	fail_unless(bytering_reserve(r, UINT32_MAX) == BYTERING_ALLOC_ERROR);
+	fail_unless(bytering_count(r) == 3);
+	fail_unless(bytering_space(r) == 5);
+	bytering_free(r);
+}
+END_TEST
+
+START_TEST (test_bytering_find) {
+	struct bytering_t r;
+	uint8_t buffer[8];
+	const uint8_t *a, *b;
+	uint32_t alen, blen;
+
+	bytering_init_static(&r, buffer, 8);
+	bytering_write(&r, "xxxxxGET", 8);
+	bytering_consume(&r, 5);
+	bytering_write(&r, "\r\n\r\n", 4);
+
+	/* the delimiter straddles the end of the buffer */
+	fail_unless(bytering_peek_spans(&r, &a, &alen, &b, &blen) == 7);
+	fail_unless(alen == 3 && blen == 4);
+	fail_unless(memcmp(a, "GET", 3) == 0);
+	fail_unless(bytering_find(&r, "\r\n\r\n", 4) == 3);
+	fail_unless(bytering_find(&r, "T\r", 2) == 2);
+	fail_unless(bytering_find(&r, "\n\n", 2) == BYTERING_NOT_FOUND);
+	fail_unless(bytering_find(&r, "\r\n\r\n\r", 5) == BYTERING_NOT_FOUND);
+}
+END_TEST
+
+START_TEST (test_bytering_pipe) {
+	ByteRing r = bytering_create(4);
+	int fds[2];
+	char out[16];
+
+	fail_unless(pipe(fds) == 0);
+	fail_unless(write(fds[1], "abcdefghij", 10) == 10);
+	close(fds[1]);
+
+	/* the ring grows as data comes in, until end of file */
+	while (bytering_read_fd(r, fds[0]) > 0);
+	fail_unless(bytering_count(r) == 10);
+	fail_unless(bytering_read(r, out, 16) == 10);
+	fail_unless(memcmp(out, "abcdefghij", 10) == 0);
+	close(fds[0]);
+	bytering_free(r);
+}
+END_TEST
+
+START_TEST (test_bytering_socketpair) {
+	struct bytering_t out, in;
+	uint8_t outBuffer[8], inBuffer[8];
+	int fds[2];
+	char line[8];
+
+	fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	bytering_init_static(&out, outBuffer, 8);
+	bytering_init_static(&in, inBuffer, 8);
+
+	/* send wrapped data with writev, receive it wrapped with readv */
+	bytering_write(&out, "123456", 6);
+	bytering_consume(&out, 5);
+	bytering_write(&out, "ab\ncd\n", 6);
+	bytering_write(&in, "zzzzz", 5);
+	bytering_consume(&in, 4);
+	fail_unless(bytering_write_fd(&out, fds[0]) == 7);
+	fail_unless(bytering_count(&out) == 0);
+	fail_unless(bytering_read_fd(&in, fds[1]) == 7);
+	fail_unless(bytering_count(&in) == 8);
+
+	fail_unless(bytering_find(&in, "\n", 1) == 4);
+	fail_unless(bytering_read(&in, line, 5) == 5);
+	fail_unless(memcmp(line, "z6ab\n", 5) == 0);
+	fail_unless(bytering_find(&in, "\n", 1) == 2);
+
+	/* a full fixed ring reports ENOBUFS */
+	bytering_write(&in, "12345", 5);
+	fail_unless(bytering_space(&in) == 0);
+	fail_unless(bytering_read_fd(&in, fds[1]) == -1);
+	close(fds[0]);
+	close(fds[1]);
+}
+END_TEST
+
+Suite*
+bytering_suite(void) {
+	Suite *s = suite_create("ByteRing");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("ByteRing");
+	tcase_add_test(tc_core, test_bytering_create);
+	tcase_add_test(tc_core, test_bytering_write_read);
+	tcase_add_test(tc_core, test_bytering_static);
+	tcase_add_test(tc_core, test_bytering_reserve_limit);
+	tcase_add_test(tc_core, test_bytering_find);
+	tcase_add_test(tc_core, test_bytering_pipe);
+	tcase_add_test(tc_core, test_bytering_socketpair);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,130 @@
+/* 
+ * test_counter.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/counter.h"
+
+static int8_t
+counter_string_comparator(const void *a, const void *b) {
+	return strcmp((char*) a, (char*) b);
+}
+
+START_TEST (test_counter_strings) {
+	Counter c = counter_create(hashmap_hash_string, counter_string_comparator);
+	char word[] = "the";
+	fail_if(c == NULL);
+	fail_unless(counter_get(c, "the") == 0);
+	fail_unless(counter_increment(c, word) == COUNTER_SUCCESS);
+	fail_unless(counter_increment(c, "the") == COUNTER_SUCCESS);
+	fail_unless(counter_add(c, "cat", 5) == COUNTER_SUCCESS);
+	fail_unless(counter_get(c, word) == 2);
+	fail_unless(counter_get(c, "cat") == 5);
+	fail_unless(counter_count(c) == 2);
+	fail_unless(counter_total(c) == 7);
+	fail_unless(counter_remove(c, "cat") == 5);
+	fail_unless(counter_remove(c, "cat") == 0);
+	fail_unless(counter_count(c) == 1);
+	fail_unless(counter_total(c) == 2);
+	counter_free(c);
+}
+END_TEST
+
+START_TEST (test_counter_most_common) {
+	Counter c = counter_create(NULL, NULL);
+	ArrayList keys = arraylist_create_heap(NULL);
+	static uintptr_t model[500];
+	struct counter_entry_t top[40];
+	unsigned int seed = 5;
+	uintptr_t key, count, sum = 0;
+	uint32_t i, j, n, k, iter = 0;
+	void *item;
+	
+	/* skewed keys: low numbers come up much more often */
+	memset(model, 0, sizeof(model));
+	for (i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		key = 1 + ((seed >> 8) % 500) * ((seed >> 20) % 500) / 500;
+		arraylist_append(keys, (void*) key);
+		model[key]++;
+	}
+	fail_unless(counter_update(c, keys) == COUNTER_SUCCESS);
+	fail_unless(counter_total(c) == 20000);
+	for (key = 0; key < 500; key++) {
+		fail_unless(counter_get(c, (void*) key) == model[key]);
+	}
+	while (counter_next(c, &iter, &item, &count)) {
+		fail_unless(model[(uintptr_t) item] == count);
+		sum += count;
+	}
+	fail_unless(sum == 20000);
+	
+	for (k = 0; k <= 40; k += 8) {
+		n = counter_most_common(c, k, top);
+		fail_unless(n == k);
+		for (i = 0; i < n; i++) {
+			fail_unless(top[i].count == model[(uintptr_t) top[i].key]);
+			fail_unless(i == 0 || top[i - 1].count >= top[i].count);
+		}
+		/* nothing left out counts more than the last one kept */
+		for (key = 0; n > 0 && key < 500; key++) {
+			for (j = 0; j < n && top[j].key != (void*) key; j++);
+			fail_unless(j < n || model[key] <= top[n - 1].count);
+		}
+	}
+	arraylist_free(keys);
+	counter_free(c);
+}
+END_TEST
+
+START_TEST (test_counter_few_keys) {
+	Counter c = counter_create(NULL, NULL);
+	struct counter_entry_t top[10];
+	fail_unless(counter_most_common(c, 10, top) == 0);
+	counter_add(c, (void*) 1, 3);
+	counter_add(c, (void*) 2, 9);
+	counter_add(c, (void*) 3, 1);
+	fail_unless(counter_most_common(c, 10, top) == 3);
+	fail_unless(top[0].key == (void*) 2 && top[0].count == 9);
+	fail_unless(top[1].key == (void*) 1 && top[1].count == 3);
+	fail_unless(top[2].key == (void*) 3 && top[2].count == 1);
+	fail_unless(counter_most_common(c, 1, top) == 1);
+	fail_unless(top[0].key == (void*) 2);
+	counter_free(c);
+}
+END_TEST
+
+Suite*
+counter_suite(void) {
+	Suite *s = suite_create("Counter");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("Counter");
+	tcase_add_test(tc_core, test_counter_strings);
+	tcase_add_test(tc_core, test_counter_most_common);
+	tcase_add_test(tc_core, test_counter_few_keys);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
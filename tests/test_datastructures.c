@@ -33,6 +33,26 @@ main(void) {
 	int number_failed;
 	SRunner *sr = srunner_create(arraylist_suite());
 	srunner_add_suite(sr, deque_suite());
+	srunner_add_suite(sr, wsdeque_suite());
+	srunner_add_suite(sr, workpool_suite());
+	srunner_add_suite(sr, spscqueue_suite());
+	srunner_add_suite(sr, mpmcqueue_suite());
+	srunner_add_suite(sr, msqueue_suite());
+	srunner_add_suite(sr, blockingdeque_suite());
+	srunner_add_suite(sr, ringdeque_suite());
+	srunner_add_suite(sr, bytering_suite());
+	srunner_add_suite(sr, lrucache_suite());
+	srunner_add_suite(sr, ideque_suite());
+	srunner_add_suite(sr, monodeque_suite());
+	srunner_add_suite(sr, timerwheel_suite());
+	srunner_add_suite(sr, pqueue_suite());
+	srunner_add_suite(sr, indexheap_suite());
+	srunner_add_suite(sr, minmaxheap_suite());
+	srunner_add_suite(sr, hashmap_suite());
+	srunner_add_suite(sr, counter_suite());
+	srunner_add_suite(sr, ordereddict_suite());
+	srunner_add_suite(sr, bloomfilter_suite());
+	srunner_add_suite(sr, listappender_suite());
 	
 	srunner_run_all(sr, CK_NORMAL);
 	number_failed = srunner_ntests_failed(sr);
@@ -24,12 +24,17 @@
 #include <check.h>
 #include <string.h>
 #include "../src/deque.h"
+#include "../src/bloomfilter.h"
 
 int8_t
 string_comparator(const void *a, const void *b) {
 	return strcmp((char*) a, (char*) b);
 }
 
+/* Most tests create their deques with deque_create() and friends, which
+ * only exist when nodes come from the heap.
+ */
+#ifndef DEQUE_STATIC
 START_TEST (test_deque_create) {
 	Deque d = deque_create(string_comparator);
 	fail_if(d == NULL);
@@ -188,6 +193,17 @@ START_TEST (test_deque_copy) {
 
 	dcopy = deque_copy(d);
 	fail_unless(deque_count(d) == 3);
+	fail_unless(deque_count(dcopy) == 3);
+	fail_unless(deque_peekleft(dcopy) == test_strings[0]);
+	fail_unless(deque_peek(dcopy) == test_strings[2]);
+	
+	/* the copy is independent of the original */
+	fail_unless(deque_popleft(dcopy) == test_strings[0]);
+	deque_append(dcopy, test_strings[0]);
+	fail_unless(deque_pop(dcopy) == test_strings[0]);
+	fail_unless(deque_pop(dcopy) == test_strings[2]);
+	fail_unless(deque_pop(dcopy) == test_strings[1]);
+	fail_unless(deque_count(d) == 3);
 	
 	deque_free(dcopy);
 	deque_free(d);
@@ -240,6 +256,455 @@ START_TEST (test_deque_contains) {
 	deque_free(d);
 }
 END_TEST
+#endif /* DEQUE_STATIC */
+
+static void
+sum_evicted(void *item, void *arg) {
+	*(intptr_t*) arg += (intptr_t) item;
+}
+
+#ifndef DEQUE_STATIC
+START_TEST (test_deque_bounded) {
+	Deque d = deque_create_bounded(3, string_comparator);
+	char* ts[] = {"t1", "t2", "t3", "t4", "t5"};
+	fail_unless(deque_maxlen(d) == 3);
+	deque_append(d, ts[0]);
+	deque_append(d, ts[1]);
+	deque_append(d, ts[2]);
+	deque_append(d, ts[3]);
+	
+	/* appending to a full deque drops the leftmost item */
+	fail_unless(deque_count(d) == 3);
+	fail_unless(deque_peekleft(d) == ts[1]);
+	fail_unless(deque_peek(d) == ts[3]);
+	
+	/* and appendleft drops the rightmost */
+	deque_appendleft(d, ts[4]);
+	fail_unless(deque_count(d) == 3);
+	fail_unless(deque_pop(d) == ts[2]);
+	fail_unless(deque_pop(d) == ts[1]);
+	fail_unless(deque_pop(d) == ts[4]);
+	fail_unless(deque_pop(d) == NULL);
+	deque_free(d);
+}
+END_TEST
+
+START_TEST (test_deque_evict_func) {
+	Deque d = deque_create_bounded(2, NULL);
+	intptr_t evicted = 0;
+	intptr_t i;
+	deque_set_evict_func(d, sum_evicted, &evicted);
+	for (i = 1; i <= 10; i++) {
+		deque_append(d, (void*) i);
+	}
+	fail_unless(evicted == 36); /* 1 + 2 + ... + 8 */
+	fail_unless(deque_popleft(d) == (void*) 9);
+	fail_unless(deque_popleft(d) == (void*) 10);
+	deque_free(d);
+}
+END_TEST
+#endif /* DEQUE_STATIC */
+
+START_TEST (test_deque_preallocated) {
+	struct deque_t window;
+	struct deque_node_t nodes[4];
+	intptr_t evicted = 0;
+	intptr_t i;
+	
+	deque_init_preallocated(&window, 4, NULL, nodes);
+	deque_set_evict_func(&window, sum_evicted, &evicted);
+	for (i = 1; i <= 100; i++) {
+		fail_unless(deque_append(&window, (void*) i) == DEQUE_SUCCESS);
+		fail_unless(window.head >= nodes && window.head < nodes + 4);
+	}
+	fail_unless(deque_count(&window) == 4);
+	fail_unless(evicted == 96 * 97 / 2);
+	
+	/* nodes go back to the preallocated pool and are handed out again */
+	fail_unless(deque_pop(&window) == (void*) 100);
+	fail_unless(window.free_nodes != NULL);
+	fail_unless(deque_appendleft(&window, (void*) 1) == DEQUE_SUCCESS);
+	fail_unless(window.free_nodes == NULL);
+	fail_unless(deque_peekleft(&window) == (void*) 1);
+	deque_clear(&window);
+	fail_unless(deque_count(&window) == 0);
+}
+END_TEST
+
+#ifndef DEQUE_STATIC
+START_TEST (test_deque_extend) {
+	Deque d = deque_create(string_comparator);
+	char* ts[] = {"t1", "t2", "t3", "t4"};
+	void* out[4];
+	
+	fail_unless(deque_extend(d, (void**) ts, 2) == DEQUE_SUCCESS);
+	fail_unless(deque_extendleft(d, (void**) ts + 2, 2) == DEQUE_SUCCESS);
+	fail_unless(deque_count(d) == 4);
+	
+	/* extendleft reverses, like python */
+	fail_unless(deque_popleft_n(d, out, 3) == 3);
+	fail_unless(out[0] == ts[3]);
+	fail_unless(out[1] == ts[2]);
+	fail_unless(out[2] == ts[0]);
+	fail_unless(deque_pop_n(d, out, 4) == 1);
+	fail_unless(out[0] == ts[1]);
+	fail_unless(deque_count(d) == 0);
+	fail_unless(d->head == NULL && d->tail == NULL);
+	
+	fail_unless(deque_extend(d, (void**) ts, 4) == DEQUE_SUCCESS);
+	fail_unless(deque_pop_n(d, out, 2) == 2);
+	fail_unless(out[0] == ts[3]);
+	fail_unless(out[1] == ts[2]);
+	fail_unless(deque_peek(d) == ts[1]);
+	deque_free(d);
+}
+END_TEST
+
+START_TEST (test_deque_extend_bounded) {
+	Deque d = deque_create_bounded(3, NULL);
+	intptr_t items[] = {1, 2, 3, 4, 5};
+	intptr_t evicted = 0;
+	deque_set_evict_func(d, sum_evicted, &evicted);
+	deque_extend(d, (void**) items, 5);
+	fail_unless(deque_count(d) == 3);
+	fail_unless(evicted == 3);
+	fail_unless(deque_peekleft(d) == (void*) 3);
+	deque_free(d);
+}
+END_TEST
+
+START_TEST (test_deque_splice) {
+	Deque d = deque_create(string_comparator);
+	Deque other = deque_create(string_comparator);
+	Deque bounded = deque_create_bounded(2, string_comparator);
+	char* ts[] = {"t1", "t2", "t3", "t4"};
+	
+	deque_extend(d, (void**) ts, 2);
+	deque_extend(other, (void**) ts + 2, 2);
+	fail_unless(deque_splice(d, other) == DEQUE_SUCCESS);
+	fail_unless(deque_count(d) == 4);
+	fail_unless(deque_count(other) == 0);
+	fail_unless(other->head == NULL && other->tail == NULL);
+	fail_unless(deque_pop(d) == ts[3]);
+	fail_unless(deque_pop(d) == ts[2]);
+	fail_unless(deque_pop(d) == ts[1]);
+	
+	/* splicing into a bounded deque evicts */
+	deque_append(d, ts[1]);
+	fail_unless(deque_splice(bounded, d) == DEQUE_SUCCESS);
+	fail_unless(deque_count(bounded) == 2);
+	fail_unless(deque_count(d) == 0);
+	fail_unless(deque_splice(d, other) == DEQUE_SUCCESS);
+	fail_unless(deque_count(d) == 0);
+	
+	deque_free(bounded);
+	deque_free(other);
+	deque_free(d);
+}
+END_TEST
+
+START_TEST (test_deque_indexing) {
+	Deque d = deque_create(NULL);
+	Deque bounded = deque_create_bounded(2, NULL);
+	intptr_t i;
+	
+	for (i = 0; i < 10; i++) {
+		deque_append(d, (void*) i);
+	}
+	for (i = 0; i < 10; i++) {
+		fail_unless(deque_getitem(d, i) == (void*) i);
+		fail_unless(deque_getitem(d, i - 10) == (void*) i);
+	}
+	fail_unless(deque_getitem(d, 10) == NULL);
+	fail_unless(deque_getitem(d, -11) == NULL);
+	fail_unless(deque_setitem(d, -2, (void*) 80) == DEQUE_SUCCESS);
+	fail_unless(deque_getitem(d, 8) == (void*) 80);
+	fail_unless(deque_setitem(d, 10, (void*) 80) == DEQUE_INDEX_ERROR);
+	
+	/* insert near either end and at both ends */
+	fail_unless(deque_insert(d, 1, (void*) 100) == DEQUE_SUCCESS);
+	fail_unless(deque_insert(d, -1, (void*) 101) == DEQUE_SUCCESS);
+	fail_unless(deque_insert(d, 0, (void*) 102) == DEQUE_SUCCESS);
+	fail_unless(deque_insert(d, 13, (void*) 103) == DEQUE_SUCCESS);
+	fail_unless(deque_insert(d, 15, (void*) 104) == DEQUE_INDEX_ERROR);
+	fail_unless(deque_count(d) == 14);
+	fail_unless(deque_peekleft(d) == (void*) 102);
+	fail_unless(deque_getitem(d, 2) == (void*) 100);
+	fail_unless(deque_getitem(d, 11) == (void*) 101);
+	fail_unless(deque_getitem(d, 12) == (void*) 9);
+	fail_unless(deque_peek(d) == (void*) 103);
+	
+	fail_unless(deque_del(d, 2) == (void*) 100);
+	fail_unless(deque_del(d, -3) == (void*) 101);
+	fail_unless(deque_del(d, 0) == (void*) 102);
+	fail_unless(deque_del(d, -1) == (void*) 103);
+	fail_unless(deque_del(d, 10) == NULL);
+	fail_unless(deque_count(d) == 10);
+	for (i = 0; i < 8; i++) {
+		fail_unless(deque_getitem(d, i) == (void*) i);
+	}
+	while (deque_count(d) > 0) {
+		deque_del(d, deque_count(d) / 2);
+	}
+	fail_unless(d->head == NULL && d->tail == NULL);
+	
+	/* a full bounded deque refuses inserts rather than evicting */
+	deque_append(bounded, (void*) 1);
+	fail_unless(deque_insert(bounded, 0, (void*) 2) == DEQUE_SUCCESS);
+	fail_unless(deque_insert(bounded, 1, (void*) 3) == DEQUE_FAILURE);
+	fail_unless(deque_getitem(bounded, 0) == (void*) 2);
+	
+	deque_free(bounded);
+	deque_free(d);
+}
+END_TEST
+
+START_TEST (test_deque_node_handles) {
+	Deque d = deque_create(NULL);
+	DequeNode n1, n2, n3;
+	
+	fail_unless(deque_append_node(d, (void*) 1, &n1) == DEQUE_SUCCESS);
+	fail_unless(deque_append_node(d, (void*) 2, &n2) == DEQUE_SUCCESS);
+	fail_unless(deque_appendleft_node(d, (void*) 3, &n3) == DEQUE_SUCCESS);
+	fail_unless(n1->value == (void*) 1 && n3->value == (void*) 3);
+	
+	/* 3 1 2 -> 3 2 1 -> 1 3 2 */
+	deque_move_to_back(d, n1);
+	fail_unless(deque_peek(d) == (void*) 1);
+	fail_unless(deque_getitem(d, 1) == (void*) 2);
+	deque_move_to_front(d, n1);
+	fail_unless(deque_peekleft(d) == (void*) 1);
+	fail_unless(deque_peek(d) == (void*) 2);
+	deque_move_to_front(d, n1);
+	fail_unless(deque_count(d) == 3);
+	
+	fail_unless(deque_remove_node(d, n3) == (void*) 3);
+	fail_unless(deque_remove_node(d, n2) == (void*) 2);
+	fail_unless(d->head == n1 && d->tail == n1);
+	deque_move_to_back(d, n1);
+	fail_unless(deque_remove_node(d, n1) == (void*) 1);
+	fail_unless(deque_count(d) == 0);
+	fail_unless(d->head == NULL && d->tail == NULL);
+	deque_free(d);
+}
+END_TEST
+
+struct keyed {
+	int key;
+	int seq;
+};
+
+static int8_t
+keyed_comparator(const void *a, const void *b) {
+	const struct keyed *x = a, *y = b;
+	return x->key < y->key ? -1 : (x->key > y->key ? 1 : 0);
+}
+
+START_TEST (test_deque_sort) {
+	Deque d = deque_create(keyed_comparator);
+	struct keyed items[200], *prev, *item;
+	DequeNode node;
+	unsigned int seed = 7;
+	int i;
+	
+	fail_unless(deque_sort(d) == 0);
+	deque_append(d, &items[0]);
+	fail_unless(deque_sort(d) == 0);
+	deque_clear(d);
+	
+	for (i = 0; i < 200; i++) {
+		seed = seed * 1103515245 + 12345;
+		items[i].key = (seed >> 16) % 10;
+		items[i].seq = i;
+		deque_append(d, &items[i]);
+	}
+	fail_unless(deque_sort(d) <= 200 * 8);
+	fail_unless(deque_count(d) == 200);
+	
+	/* ascending by key, ties still in insertion order */
+	prev = NULL;
+	for (node = d->tail; node != NULL; node = node->next) {
+		item = node->value;
+		if (prev != NULL) {
+			fail_unless(prev->key < item->key
+			            || (prev->key == item->key && prev->seq < item->seq));
+		}
+		fail_unless(node->prev == NULL || node->prev->value == prev);
+		prev = item;
+	}
+	fail_unless(deque_peek(d) == prev);
+	fail_unless(deque_popleft(d) != NULL && deque_pop(d) == prev);
+	deque_free(d);
+}
+END_TEST
+
+#ifdef DEQUE_FILTER
+START_TEST (test_deque_filter) {
+	Deque d = deque_create_bounded(302, NULL);
+	BloomFilter f = bloomfilter_create(302, NULL);
+	void* items[200];
+	uintptr_t i;
+	uint32_t passed = 0;
+	
+	for (i = 0; i < 100; i++) {
+		deque_append(d, (void*) (i * 8));
+	}
+	deque_set_filter(d, f);
+	fail_unless(bloomfilter_count(f) == 100);
+	for (i = 0; i < 200; i++) {
+		items[i] = (void*) ((100 + i) * 8);
+	}
+	deque_extend(d, items, 200);
+	deque_appendleft(d, (void*) 4000);
+	deque_insert(d, 5, (void*) 4008);
+	deque_setitem(d, 0, (void*) 4016);   /* replaces 4000 */
+	deque_append(d, (void*) 4024);       /* evicts 4016 */
+	fail_unless(deque_remove(d, (void*) (50 * 8)) == (void*) (50 * 8));
+	fail_unless(deque_pop(d) == (void*) 4024);
+	fail_unless(deque_popleft(d) == (void*) 0);
+	fail_unless(bloomfilter_count(f) == deque_count(d));
+	
+	/* the filter agrees with the deque for what is in it */
+	fail_unless(deque_contains(d, (void*) 4008));
+	fail_unless(deque_contains(d, (void*) (299 * 8)));
+	fail_if(deque_contains(d, (void*) 4000));
+	fail_if(deque_contains(d, (void*) 4016));
+	fail_if(deque_contains(d, (void*) (50 * 8)));
+	fail_if(deque_contains(d, (void*) 4024));
+	for (i = 0; i < 10000; i++) {
+		passed += bloomfilter_contains(f, (void*) (100000 + i * 8));
+	}
+	fail_unless(passed < 200);
+	fail_unless(f->lookups > f->rejected);
+	
+	deque_clear(d);
+	fail_unless(bloomfilter_count(f) == 0);
+	deque_set_filter(d, NULL);
+	deque_append(d, (void*) 8);
+	fail_unless(bloomfilter_count(f) == 0);
+	fail_unless(deque_contains(d, (void*) 8));
+	bloomfilter_free(f);
+	deque_free(d);
+}
+END_TEST
+#endif /* DEQUE_FILTER */
+#endif /* DEQUE_STATIC */
+
+START_TEST (test_deque_append_result) {
+	struct deque_t d;
+	deque_init(&d, NULL);
+	fail_unless(deque_append(&d, (void*) 1) == DEQUE_SUCCESS);
+	fail_unless(deque_append(&d, (void*) 2) == DEQUE_SUCCESS);
+	deque_clear(&d);
+}
+END_TEST
+
+START_TEST (test_deque_pop_to_empty) {
+	struct deque_t d;
+	deque_init(&d, NULL);
+	
+	/* emptying from either end leaves neither end pointing at a freed node */
+	deque_append(&d, (void*) 1);
+	fail_unless(deque_pop(&d) == (void*) 1);
+	fail_unless(d.head == NULL && d.tail == NULL);
+	deque_append(&d, (void*) 2);
+	fail_unless(deque_popleft(&d) == (void*) 2);
+	fail_unless(d.head == NULL && d.tail == NULL);
+	fail_unless(deque_appendleft(&d, (void*) 3) == DEQUE_SUCCESS);
+	fail_unless(deque_peek(&d) == (void*) 3);
+	fail_unless(deque_peekleft(&d) == (void*) 3);
+	deque_clear(&d);
+}
+END_TEST
+
+START_TEST (test_deque_pop_unlinks_head) {
+	struct deque_t d;
+	deque_init(&d, NULL);
+	deque_append(&d, (void*) 1);
+	deque_append(&d, (void*) 2);
+	fail_unless(deque_pop(&d) == (void*) 2);
+	fail_unless(d.head->next == NULL);
+	deque_append(&d, (void*) 3);
+	fail_unless(deque_popleft(&d) == (void*) 1);
+	fail_unless(deque_popleft(&d) == (void*) 3);
+	fail_unless(deque_popleft(&d) == NULL);
+}
+END_TEST
+
+START_TEST (test_deque_appendleft_empty) {
+	struct deque_t d;
+	deque_init(&d, NULL);
+	fail_unless(deque_appendleft(&d, (void*) 1) == DEQUE_SUCCESS);
+	fail_unless(d.head != NULL && d.head == d.tail);
+	fail_unless(deque_peek(&d) == (void*) 1);
+	fail_unless(deque_pop(&d) == (void*) 1);
+	fail_unless(deque_count(&d) == 0);
+}
+END_TEST
+
+START_TEST (test_deque_clear_releases) {
+	struct deque_t d;
+	intptr_t i;
+	deque_init(&d, NULL);
+	
+	/* every node goes back, so the deque can be filled again */
+	for (i = 1; i <= DEQUE_MAX_NODES; i++) {
+		fail_unless(deque_append(&d, (void*) i) == DEQUE_SUCCESS);
+	}
+	fail_unless(deque_clear(&d) == DEQUE_SUCCESS);
+	fail_unless(deque_count(&d) == 0);
+	for (i = 1; i <= DEQUE_MAX_NODES; i++) {
+		fail_unless(deque_appendleft(&d, (void*) i) == DEQUE_SUCCESS);
+	}
+	fail_unless(deque_peekleft(&d) == (void*) DEQUE_MAX_NODES);
+	deque_clear(&d);
+}
+END_TEST
+
+START_TEST (test_deque_node_pool) {
+	struct deque_t d;
+	intptr_t i;
+	
+	/* deque_init must not trust whatever was in the node pool before */
+	memset(&d, 0xff, sizeof(d));
+	deque_init(&d, NULL);
+	for (i = 1; i <= DEQUE_MAX_NODES; i++) {
+		fail_unless(deque_append(&d, (void*) i) == DEQUE_SUCCESS);
+	}
+#ifdef DEQUE_STATIC
+	fail_unless(deque_append(&d, (void*) i) == DEQUE_ALLOC_ERROR);
+	fail_unless(deque_count(&d) == DEQUE_MAX_NODES);
+#endif
+	deque_clear(&d);
+}
+END_TEST
+
+START_TEST (test_deque_splice_all_or_nothing) {
+	struct deque_t d, other;
+	intptr_t i;
+	deque_init(&d, NULL);
+	deque_init(&other, NULL);
+	for (i = 1; i <= 6; i++) {
+		deque_append(&d, (void*) i);
+		deque_append(&other, (void*) (i + 6));
+	}
+#ifdef DEQUE_STATIC
+	/* six more items do not fit in the node pool: nothing moves */
+	fail_unless(deque_splice(&d, &other) == DEQUE_ALLOC_ERROR);
+	fail_unless(deque_count(&d) == 6 && deque_count(&other) == 6);
+	fail_unless(deque_peek(&d) == (void*) 6);
+	fail_unless(deque_peekleft(&other) == (void*) 7);
+#endif
+	deque_pop(&other);
+	deque_pop(&other);
+	fail_unless(deque_splice(&d, &other) == DEQUE_SUCCESS);
+	fail_unless(deque_count(&d) == 10 && deque_count(&other) == 0);
+	for (i = 1; i <= 10; i++) {
+		fail_unless(deque_popleft(&d) == (void*) i);
+	}
+	deque_clear(&other);
+}
+END_TEST
 
 Suite*
 deque_suite(void) {
@@ -247,6 +712,7 @@ deque_suite(void) {
 	
 	/* Core test case */
 	TCase *tc_core = tcase_create("Deque");
+#ifndef DEQUE_STATIC
 	tcase_add_test(tc_core, test_deque_create);
 	tcase_add_test(tc_core, test_deque_append);
 	tcase_add_test(tc_core, test_deque_appendleft);
@@ -259,6 +725,28 @@ deque_suite(void) {
 	tcase_add_test(tc_core, test_deque_copy);
 	tcase_add_test(tc_core, test_deque_reverse);
 	tcase_add_test(tc_core, test_deque_contains);
+	tcase_add_test(tc_core, test_deque_bounded);
+	tcase_add_test(tc_core, test_deque_evict_func);
+#endif
+	tcase_add_test(tc_core, test_deque_preallocated);
+#ifndef DEQUE_STATIC
+	tcase_add_test(tc_core, test_deque_extend);
+	tcase_add_test(tc_core, test_deque_extend_bounded);
+	tcase_add_test(tc_core, test_deque_splice);
+	tcase_add_test(tc_core, test_deque_indexing);
+	tcase_add_test(tc_core, test_deque_node_handles);
+	tcase_add_test(tc_core, test_deque_sort);
+#ifdef DEQUE_FILTER
+	tcase_add_test(tc_core, test_deque_filter);
+#endif
+#endif
+	tcase_add_test(tc_core, test_deque_append_result);
+	tcase_add_test(tc_core, test_deque_pop_to_empty);
+	tcase_add_test(tc_core, test_deque_pop_unlinks_head);
+	tcase_add_test(tc_core, test_deque_appendleft_empty);
+	tcase_add_test(tc_core, test_deque_clear_releases);
+	tcase_add_test(tc_core, test_deque_node_pool);
+	tcase_add_test(tc_core, test_deque_splice_all_or_nothing);
 	
 	suite_add_tcase(s, tc_core);
 	return s;
@@ -0,0 +1,176 @@
+/* 
+ * test_hashmap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/hashmap.h"
+
+static int8_t
+map_string_comparator(const void *a, const void *b) {
+	return strcmp((char*) a, (char*) b);
+}
+
+static uint32_t
+constant_hash(const void *key) {
+	return 42;
+}
+
+START_TEST (test_hashmap_strings) {
+	HashMap m = hashmap_create(hashmap_hash_string, map_string_comparator);
+	char key[] = "apple";
+	fail_if(m == NULL);
+	fail_unless(hashmap_get(m, "apple") == NULL);
+	fail_unless(hashmap_put(m, key, (void*) 1) == HASHMAP_SUCCESS);
+	fail_unless(hashmap_put(m, "pear", (void*) 2) == HASHMAP_SUCCESS);
+	fail_unless(hashmap_get(m, "apple") == (void*) 1);
+	fail_unless(hashmap_contains(m, "pear"));
+	fail_if(hashmap_contains(m, "plum"));
+	
+	/* putting an equal key replaces the value */
+	fail_unless(hashmap_put(m, "apple", (void*) 3) == HASHMAP_SUCCESS);
+	fail_unless(hashmap_count(m) == 2);
+	fail_unless(hashmap_get(m, key) == (void*) 3);
+	fail_unless(hashmap_remove(m, "apple") == (void*) 3);
+	fail_unless(hashmap_remove(m, "apple") == NULL);
+	fail_unless(hashmap_count(m) == 1);
+	hashmap_free(m);
+}
+END_TEST
+
+START_TEST (test_hashmap_random) {
+	HashMap m = hashmap_create(NULL, NULL);
+	static uint8_t present[4096];
+	unsigned int seed = 13;
+	uintptr_t key;
+	uint32_t n = 0, iter = 0, seen = 0;
+	void *k, *v;
+	int round;
+	
+	memset(present, 0, sizeof(present));
+	for (round = 0; round < 50000; round++) {
+		seed = seed * 1103515245 + 12345;
+		key = (seed >> 8) % 4096;
+		if ((seed >> 24) % 3 != 0) {
+			fail_unless(hashmap_put(m, (void*) key, (void*) (key + 1)) == HASHMAP_SUCCESS);
+			n += !present[key];
+			present[key] = 1;
+		} else {
+			fail_unless(hashmap_remove(m, (void*) key) == (present[key] ? (void*) (key + 1) : NULL));
+			n -= present[key];
+			present[key] = 0;
+		}
+		fail_unless(hashmap_count(m) == n);
+	}
+	for (key = 0; key < 4096; key++) {
+		fail_unless(hashmap_contains(m, (void*) key) == present[key]);
+		fail_unless(hashmap_get(m, (void*) key) == (present[key] ? (void*) (key + 1) : NULL));
+	}
+	while (hashmap_next(m, &iter, &k, &v)) {
+		fail_unless(present[(uintptr_t) k] && v == (void*) ((uintptr_t) k + 1));
+		seen++;
+	}
+	fail_unless(seen == n);
+	hashmap_clear(m);
+	fail_unless(hashmap_count(m) == 0);
+	fail_if(hashmap_contains(m, (void*) 1));
+	hashmap_free(m);
+}
+END_TEST
+
+START_TEST (test_hashmap_batch) {
+	HashMap m = hashmap_create_size(10, NULL, NULL);
+	void* keys[1000];
+	uintptr_t i;
+	
+	for (i = 0; i < 1000; i++) {
+		keys[i] = (void*) (i * 4096);
+	}
+	fail_unless(hashmap_put_batch(m, keys, keys, 1000) == HASHMAP_SUCCESS);
+	fail_unless(hashmap_count(m) == 1000);
+	fail_unless(hashmap_reserve(m, 100) == HASHMAP_SUCCESS);
+	for (i = 0; i < 1000; i++) {
+		fail_unless(hashmap_get(m, keys[i]) == keys[i]);
+	}
+	fail_unless(hashmap_reserve(m, 100000) == HASHMAP_SUCCESS);
+	fail_unless(hashmap_count(m) == 1000);
+	fail_unless(hashmap_get(m, keys[999]) == keys[999]);
+	hashmap_free(m);
+}
+END_TEST
+
+START_TEST (test_hashmap_setdefault) {
+	HashMap m = hashmap_create(NULL, NULL);
+	void **value;
+	uintptr_t i;
+	
+	/* the returned slot is the key's even when placing it moved others */
+	for (i = 1; i <= 5000; i++) {
+		value = hashmap_setdefault(m, (void*) (i % 2000), (void*) 0);
+		fail_if(value == NULL);
+		*value = (void*) ((uintptr_t) *value + 1);
+	}
+	fail_unless(hashmap_count(m) == 2000);
+	for (i = 0; i < 2000; i++) {
+		fail_unless(hashmap_get(m, (void*) i) == (void*) (uintptr_t) (i >= 1 && i <= 1000 ? 3 : 2));
+	}
+	hashmap_free(m);
+}
+END_TEST
+
+START_TEST (test_hashmap_collisions) {
+	HashMap m = hashmap_create(constant_hash, NULL);
+	uintptr_t i, stored;
+	
+	/* every key in one run: lookups and deletes still work, and the map
+	 * refuses keys once the run cannot get longer instead of growing forever
+	 */
+	for (i = 1; hashmap_put(m, (void*) i, (void*) i) == HASHMAP_SUCCESS; i++);
+	stored = i - 1;
+	fail_unless(stored > 100 && stored < 200);
+	fail_unless(hashmap_count(m) == stored);
+	for (i = 1; i <= stored; i += 2) {
+		fail_unless(hashmap_remove(m, (void*) i) == (void*) i);
+	}
+	for (i = 1; i <= stored; i++) {
+		fail_unless(hashmap_get(m, (void*) i) == (i % 2 ? NULL : (void*) i));
+	}
+	hashmap_free(m);
+}
+END_TEST
+
+Suite*
+hashmap_suite(void) {
+	Suite *s = suite_create("HashMap");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("HashMap");
+	tcase_add_test(tc_core, test_hashmap_strings);
+	tcase_add_test(tc_core, test_hashmap_random);
+	tcase_add_test(tc_core, test_hashmap_batch);
+	tcase_add_test(tc_core, test_hashmap_setdefault);
+	tcase_add_test(tc_core, test_hashmap_collisions);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,145 @@
+/* 
+ * test_ideque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/ideque.h"
+
+struct item {
+	int value;
+	struct ideque_link_t link;
+	struct ideque_link_t other_link;
+};
+
+static int
+link_value(IDequeLink link) {
+	return IDEQUE_ENTRY(link, struct item, link)->value;
+}
+
+START_TEST (test_ideque_append_pop) {
+	struct ideque_t d;
+	struct item items[4];
+	int i;
+	ideque_init(&d);
+	fail_unless(ideque_pop(&d) == NULL);
+	fail_unless(ideque_popleft(&d) == NULL);
+	for (i = 0; i < 4; i++) {
+		items[i].value = i;
+		ideque_link_init(&items[i].link);
+	}
+	fail_if(ideque_is_linked(&items[0].link));
+	ideque_append(&d, &items[1].link);
+	ideque_append(&d, &items[2].link);
+	ideque_appendleft(&d, &items[0].link);
+	ideque_append(&d, &items[3].link);
+	fail_unless(ideque_is_linked(&items[0].link));
+	fail_unless(ideque_count(&d) == 4);
+	fail_unless(link_value(ideque_peekleft(&d)) == 0);
+	fail_unless(link_value(ideque_peek(&d)) == 3);
+	fail_unless(link_value(ideque_popleft(&d)) == 0);
+	fail_unless(link_value(ideque_pop(&d)) == 3);
+	fail_unless(link_value(ideque_pop(&d)) == 2);
+	fail_unless(link_value(ideque_pop(&d)) == 1);
+	fail_unless(ideque_count(&d) == 0);
+	fail_if(ideque_is_linked(&items[1].link));
+}
+END_TEST
+
+START_TEST (test_ideque_remove) {
+	struct ideque_t d, evens;
+	struct item items[6];
+	int expected[] = {1, 3, 4, 0};
+	IDequeLink link;
+	int i;
+	ideque_init(&d);
+	ideque_init(&evens);
+	for (i = 0; i < 6; i++) {
+		items[i].value = i;
+		ideque_append(&d, &items[i].link);
+		if (i % 2 == 0) {
+			ideque_append(&evens, &items[i].other_link);
+		}
+	}
+	
+	/* removal from one deque leaves the object in the other */
+	ideque_remove(&d, &items[2].link);
+	ideque_remove(&d, &items[5].link);
+	fail_unless(ideque_count(&d) == 4);
+	fail_unless(ideque_count(&evens) == 3);
+	fail_unless(IDEQUE_ENTRY(ideque_next(&evens, ideque_peekleft(&evens)),
+	                         struct item, other_link) == &items[2]);
+	
+	ideque_move_to_back(&d, &items[0].link);
+	i = 0;
+	for (link = ideque_peekleft(&d); link != NULL; link = ideque_next(&d, link)) {
+		fail_unless(link_value(link) == expected[i++]);
+	}
+	fail_unless(i == 4);
+	for (link = ideque_peek(&d); link != NULL; link = ideque_prev(&d, link)) {
+		fail_unless(link_value(link) == expected[--i]);
+	}
+	fail_unless(i == 0);
+}
+END_TEST
+
+START_TEST (test_ideque_splice) {
+	struct ideque_t a, b;
+	struct item items[4];
+	int i;
+	ideque_init(&a);
+	ideque_init(&b);
+	ideque_splice(&a, &b);
+	fail_unless(ideque_count(&a) == 0);
+	for (i = 0; i < 4; i++) {
+		items[i].value = i;
+		ideque_append(i < 1 ? &a : &b, &items[i].link);
+	}
+	ideque_splice(&a, &b);
+	fail_unless(ideque_count(&a) == 4);
+	fail_unless(ideque_count(&b) == 0);
+	fail_unless(ideque_peek(&b) == NULL);
+	for (i = 0; i < 4; i++) {
+		fail_unless(link_value(ideque_popleft(&a)) == i);
+	}
+	
+	/* splicing into an empty deque */
+	ideque_append(&b, &items[0].link);
+	ideque_splice(&a, &b);
+	fail_unless(link_value(ideque_peek(&a)) == 0);
+	fail_unless(link_value(ideque_peekleft(&a)) == 0);
+}
+END_TEST
+
+Suite*
+ideque_suite(void) {
+	Suite *s = suite_create("IDeque");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("IDeque");
+	tcase_add_test(tc_core, test_ideque_append_pop);
+	tcase_add_test(tc_core, test_ideque_remove);
+	tcase_add_test(tc_core, test_ideque_splice);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
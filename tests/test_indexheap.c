@@ -0,0 +1,123 @@
+/* 
+ * test_indexheap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/indexheap.h"
+
+struct task {
+	int priority;
+	struct indexheap_node_t node;
+};
+
+static int8_t
+task_comparator(const void *a, const void *b) {
+	const struct task *x = a, *y = b;
+	return x->priority < y->priority ? -1 : (x->priority > y->priority ? 1 : 0);
+}
+
+static void
+check_drain(IndexHeap h, uint32_t expected_count) {
+	struct task *t;
+	int prev = -1000000;
+	uint32_t n = 0;
+	while ((t = indexheap_pop(h)) != NULL) {
+		fail_unless(t->priority >= prev);
+		fail_if(indexheap_contains(h, &t->node));
+		prev = t->priority;
+		n++;
+	}
+	fail_unless(n == expected_count);
+}
+
+START_TEST (test_indexheap_push_pop) {
+	IndexHeap h = indexheap_create_size(2, task_comparator);
+	struct task tasks[100];
+	int i;
+	fail_unless(indexheap_pop(h) == NULL);
+	fail_unless(indexheap_peek(h) == NULL);
+	for (i = 0; i < 100; i++) {
+		tasks[i].priority = (i * 37) % 100;
+		indexheap_node_init(&tasks[i].node);
+		fail_if(indexheap_contains(h, &tasks[i].node));
+		fail_unless(indexheap_push(h, &tasks[i].node, &tasks[i]) == INDEXHEAP_SUCCESS);
+	}
+	fail_unless(indexheap_count(h) == 100);
+	fail_unless(((struct task*) indexheap_peek(h))->priority == 0);
+	check_drain(h, 100);
+	indexheap_free(h);
+}
+END_TEST
+
+START_TEST (test_indexheap_update_remove) {
+	IndexHeap h = indexheap_create(task_comparator);
+	struct task tasks[200];
+	unsigned int seed = 9;
+	uint32_t queued = 200;
+	int i, round;
+	
+	for (i = 0; i < 200; i++) {
+		tasks[i].priority = i;
+		indexheap_node_init(&tasks[i].node);
+		indexheap_push(h, &tasks[i].node, &tasks[i]);
+	}
+	/* move random items both ways and remove some from the middle */
+	for (round = 0; round < 1000; round++) {
+		seed = seed * 1103515245 + 12345;
+		i = (seed >> 16) % 200;
+		if (!indexheap_contains(h, &tasks[i].node)) {
+			continue;
+		}
+		if (round % 10 == 0) {
+			fail_unless(indexheap_remove(h, &tasks[i].node) == &tasks[i]);
+			queued--;
+		} else {
+			tasks[i].priority = (seed >> 4) % 1000 - 500;
+			indexheap_update_priority(h, &tasks[i].node);
+		}
+	}
+	fail_unless(indexheap_count(h) == queued);
+	
+	/* decrease-key to the front */
+	for (i = 0; i < 200 && !indexheap_contains(h, &tasks[i].node); i++);
+	tasks[i].priority = -1000;
+	indexheap_update_priority(h, &tasks[i].node);
+	fail_unless(indexheap_peek(h) == &tasks[i]);
+	fail_unless(indexheap_pop_node(h) == &tasks[i].node);
+	check_drain(h, queued - 1);
+	indexheap_free(h);
+}
+END_TEST
+
+Suite*
+indexheap_suite(void) {
+	Suite *s = suite_create("IndexHeap");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("IndexHeap");
+	tcase_add_test(tc_core, test_indexheap_push_pop);
+	tcase_add_test(tc_core, test_indexheap_update_remove);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,174 @@
+/* 
+ * test_listappender.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/listappender.h"
+
+#define LA_THREADS (4)
+#define LA_ITEMS_PER_THREAD (50000)
+
+START_TEST (test_listappender_append) {
+	ArrayList l = arraylist_create_heap_size(2, NULL);
+	struct listappender_t a;
+	void* items[] = {(void*) 3, (void*) 4, (void*) 5};
+	uintptr_t i;
+	
+	arraylist_append(l, (void*) 1);
+	listappender_init(&a, l);
+	fail_unless(listappender_published(&a) == 1);
+	fail_unless(listappender_append(&a, (void*) 2) == LISTAPPENDER_SUCCESS);
+	fail_unless(listappender_append_n(&a, items, 3) == LISTAPPENDER_SUCCESS);
+	fail_unless(listappender_append_n(&a, items, 0) == LISTAPPENDER_SUCCESS);
+	fail_unless(listappender_published(&a) == 5);
+	fail_unless(listappender_get(&a, 4) == (void*) 5);
+	listappender_finish(&a);
+	
+	/* the list carries on as an ordinary list */
+	fail_unless(arraylist_count(l) == 5);
+	fail_unless(arraylist_append(l, (void*) 6) == ARRAYLIST_SUCCESS);
+	for (i = 0; i < 6; i++) {
+		fail_unless(arraylist_getitem(l, i) == (void*) (i + 1));
+	}
+	arraylist_free(l);
+}
+END_TEST
+
+START_TEST (test_listappender_fixed) {
+	void* buffer[4] = {NULL};
+	void* items[] = {(void*) 1, (void*) 2, (void*) 3};
+	ArrayList l = arraylist_create_static(buffer, 4, NULL);
+	struct listappender_t a;
+	
+	listappender_init(&a, l);
+	fail_unless(listappender_append_n(&a, items, 3) == LISTAPPENDER_SUCCESS);
+	fail_unless(listappender_append_n(&a, items, 2) == LISTAPPENDER_FAILURE);
+	fail_unless(listappender_append(&a, (void*) 4) == LISTAPPENDER_FAILURE);
+	listappender_finish(&a);
+	fail_unless(arraylist_count(l) == 3);
+	fail_unless(l->ptr_table == buffer);
+	free(l);
+}
+END_TEST
+
+static struct listappender_t la_shared;
+static atomic_bool la_done;
+
+/* thread t appends t * LA_ITEMS_PER_THREAD + 1 onwards, in runs of 1 to 7 */
+static void *
+la_writer(void *arg) {
+	uintptr_t base = (uintptr_t) arg * LA_ITEMS_PER_THREAD + 1;
+	void* items[7];
+	uint32_t i = 0, j, n;
+	while (i < LA_ITEMS_PER_THREAD) {
+		n = 1 + (i / 3) % 7;
+		if (n > LA_ITEMS_PER_THREAD - i) {
+			n = LA_ITEMS_PER_THREAD - i;
+		}
+		for (j = 0; j < n; j++) {
+			items[j] = (void*) (base + i + j);
+		}
+		if (n == 1) {
+			listappender_append(&la_shared, items[0]);
+		} else {
+			listappender_append_n(&la_shared, items, n);
+		}
+		i += n;
+	}
+	return NULL;
+}
+
+/* every published item must already be there, and each thread's items
+ * must appear in the order it appended them
+ */
+static void *
+la_reader(void *arg) {
+	uintptr_t last[LA_THREADS], item;
+	uint32_t i = 0, published, *bad = arg;
+	memset(last, 0, sizeof(last));
+	while (!atomic_load(&la_done) || i < listappender_published(&la_shared)) {
+		published = listappender_published(&la_shared);
+		for (; i < published; i++) {
+			item = (uintptr_t) listappender_get(&la_shared, i) - 1;
+			if (item >= LA_THREADS * LA_ITEMS_PER_THREAD
+			    || (item % LA_ITEMS_PER_THREAD != 0
+			        && last[item / LA_ITEMS_PER_THREAD] != item - 1)) {
+				(*bad)++;
+			} else {
+				last[item / LA_ITEMS_PER_THREAD] = item;
+			}
+		}
+		sched_yield();
+	}
+	return NULL;
+}
+
+START_TEST (test_listappender_threads) {
+	static uint8_t seen[LA_THREADS * LA_ITEMS_PER_THREAD];
+	ArrayList l = arraylist_create_heap_size(1, NULL);
+	pthread_t writers[LA_THREADS], reader;
+	uint32_t bad = 0;
+	uintptr_t i, item;
+	
+	listappender_init(&la_shared, l);
+	atomic_store(&la_done, false);
+	pthread_create(&reader, NULL, la_reader, &bad);
+	for (i = 0; i < LA_THREADS; i++) {
+		pthread_create(&writers[i], NULL, la_writer, (void*) i);
+	}
+	for (i = 0; i < LA_THREADS; i++) {
+		pthread_join(writers[i], NULL);
+	}
+	atomic_store(&la_done, true);
+	pthread_join(reader, NULL);
+	fail_unless(bad == 0);
+	listappender_finish(&la_shared);
+	
+	/* every item exactly once */
+	fail_unless(arraylist_count(l) == LA_THREADS * LA_ITEMS_PER_THREAD);
+	memset(seen, 0, sizeof(seen));
+	for (i = 0; i < arraylist_count(l); i++) {
+		item = (uintptr_t) arraylist_getitem(l, i) - 1;
+		fail_unless(item < LA_THREADS * LA_ITEMS_PER_THREAD && !seen[item]);
+		seen[item] = 1;
+	}
+	arraylist_free(l);
+}
+END_TEST
+
+Suite*
+listappender_suite(void) {
+	Suite *s = suite_create("ListAppender");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("ListAppender");
+	tcase_add_test(tc_core, test_listappender_append);
+	tcase_add_test(tc_core, test_listappender_fixed);
+	tcase_add_test(tc_core, test_listappender_threads);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,103 @@
+/* 
+ * test_lrucache.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/lrucache.h"
+
+static int8_t
+lru_string_comparator(const void *a, const void *b) {
+	return strcmp((char*) a, (char*) b);
+}
+
+static void
+count_evicted(void *key, void *value, void *arg) {
+	(*(int*) arg)++;
+}
+
+START_TEST (test_lrucache_get_put) {
+	LRUCache c = lrucache_create(2, lrucache_hash_string, lru_string_comparator);
+	char k1[] = "one";
+	int evicted = 0;
+	fail_if(c == NULL);
+	lrucache_set_evict_func(c, count_evicted, &evicted);
+	fail_unless(lrucache_capacity(c) == 2);
+	fail_unless(lrucache_get(c, "one") == NULL);
+	
+	fail_unless(lrucache_put(c, k1, (void*) 1) == LRUCACHE_SUCCESS);
+	fail_unless(lrucache_put(c, "two", (void*) 2) == LRUCACHE_SUCCESS);
+	fail_unless(lrucache_get(c, "one") == (void*) 1); /* equal, not same key */
+	
+	/* "two" is now the least recently used */
+	fail_unless(lrucache_put(c, "three", (void*) 3) == LRUCACHE_SUCCESS);
+	fail_unless(evicted == 1);
+	fail_unless(lrucache_count(c) == 2);
+	fail_unless(lrucache_get(c, "two") == NULL);
+	fail_unless(lrucache_peek(c, "one") == (void*) 1);
+	
+	/* peek does not count as a use, so "one" goes next */
+	fail_unless(lrucache_put(c, "three", (void*) 33) == LRUCACHE_SUCCESS);
+	fail_unless(lrucache_put(c, "four", (void*) 4) == LRUCACHE_SUCCESS);
+	fail_unless(evicted == 2);
+	fail_unless(lrucache_get(c, "one") == NULL);
+	fail_unless(lrucache_get(c, "three") == (void*) 33);
+	
+	fail_unless(lrucache_remove(c, "four") == (void*) 4);
+	fail_unless(lrucache_remove(c, "four") == NULL);
+	fail_unless(lrucache_count(c) == 1);
+	fail_unless(evicted == 2);
+	lrucache_free(c);
+}
+END_TEST
+
+START_TEST (test_lrucache_many) {
+	LRUCache c = lrucache_create(100, NULL, NULL);
+	uintptr_t i;
+	for (i = 1; i <= 1000; i++) {
+		fail_unless(lrucache_put(c, (void*) i, (void*) (i * 2)) == LRUCACHE_SUCCESS);
+		/* keep key 1 hot */
+		fail_unless(lrucache_get(c, (void*) 1) == (void*) 2);
+	}
+	fail_unless(lrucache_count(c) == 100);
+	for (i = 902; i <= 1000; i++) {
+		fail_unless(lrucache_get(c, (void*) i) == (void*) (i * 2));
+	}
+	fail_unless(lrucache_get(c, (void*) 901) == NULL);
+	fail_unless(lrucache_get(c, (void*) 1) == (void*) 2);
+	lrucache_free(c);
+}
+END_TEST
+
+Suite*
+lrucache_suite(void) {
+	Suite *s = suite_create("LRUCache");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("LRUCache");
+	tcase_add_test(tc_core, test_lrucache_get_put);
+	tcase_add_test(tc_core, test_lrucache_many);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,107 @@
+/* 
+ * test_minmaxheap.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/minmaxheap.h"
+
+static int8_t
+mm_int_comparator(const void *a, const void *b) {
+	intptr_t x = (intptr_t) a, y = (intptr_t) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+START_TEST (test_minmaxheap_random) {
+	MinMaxHeap h = minmaxheap_create_size(1, mm_int_comparator);
+	intptr_t model[300], item;
+	uint32_t n = 0, i, lo, hi;
+	unsigned int seed = 21;
+	int round;
+	
+	fail_unless(minmaxheap_pop_min(h) == NULL);
+	fail_unless(minmaxheap_peek_max(h) == NULL);
+	
+	/* random pushes and pops at both ends, checked against an unsorted array */
+	for (round = 0; round < 3000; round++) {
+		seed = seed * 1103515245 + 12345;
+		if (n < 300 && (n == 0 || (seed >> 20) % 5 < 3)) {
+			item = (seed >> 8) % 1000;
+			fail_unless(minmaxheap_push(h, (void*) item) == MINMAXHEAP_SUCCESS);
+			model[n++] = item;
+		} else {
+			for (lo = hi = 0, i = 1; i < n; i++) {
+				lo = model[i] < model[lo] ? i : lo;
+				hi = model[i] > model[hi] ? i : hi;
+			}
+			fail_unless(minmaxheap_peek_min(h) == (void*) model[lo]);
+			fail_unless(minmaxheap_peek_max(h) == (void*) model[hi]);
+			if ((seed >> 12) % 2) {
+				fail_unless(minmaxheap_pop_min(h) == (void*) model[lo]);
+				model[lo] = model[--n];
+			} else {
+				fail_unless(minmaxheap_pop_max(h) == (void*) model[hi]);
+				model[hi] = model[--n];
+			}
+		}
+		fail_unless(minmaxheap_count(h) == n);
+	}
+	minmaxheap_free(h);
+}
+END_TEST
+
+START_TEST (test_minmaxheap_bounded) {
+	struct minmaxheap_t h;
+	void* buffer[5];
+	intptr_t i;
+	
+	minmaxheap_init_static(&h, buffer, 5, mm_int_comparator);
+	for (i = 0; i < 5; i++) {
+		fail_unless(minmaxheap_push_evict(&h, (void*) (i * 10)) == NULL);
+	}
+	fail_unless(minmaxheap_push(&h, (void*) 1) == MINMAXHEAP_FAILURE);
+	
+	/* a full pool throws out the worst, which may be the newcomer */
+	fail_unless(minmaxheap_push_evict(&h, (void*) 15) == (void*) 40);
+	fail_unless(minmaxheap_push_evict(&h, (void*) 99) == (void*) 99);
+	fail_unless(minmaxheap_peek_max(&h) == (void*) 30);
+	fail_unless(minmaxheap_pop_min(&h) == (void*) 0);
+	fail_unless(minmaxheap_pop_min(&h) == (void*) 10);
+	fail_unless(minmaxheap_pop_max(&h) == (void*) 30);
+	fail_unless(minmaxheap_pop_max(&h) == (void*) 20);
+	fail_unless(minmaxheap_pop_max(&h) == (void*) 15);
+	fail_unless(minmaxheap_count(&h) == 0);
+}
+END_TEST
+
+Suite*
+minmaxheap_suite(void) {
+	Suite *s = suite_create("MinMaxHeap");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("MinMaxHeap");
+	tcase_add_test(tc_core, test_minmaxheap_random);
+	tcase_add_test(tc_core, test_minmaxheap_bounded);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -0,0 +1,127 @@
+/* 
+ * test_monodeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/monodeque.h"
+
+static int8_t
+int_comparator(const void *a, const void *b) {
+	intptr_t x = (intptr_t) a, y = (intptr_t) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Check the sliding window extremes against a rescan of each window, with
+ * the window kept by monodeque_expire() or, if expire is false, by the
+ * capacity alone
+ */
+static void
+check_window(monodeque_kind_t kind, uint32_t width, bool expire) {
+	MonoDeque m = monodeque_create(width, kind, int_comparator);
+	intptr_t samples[300], expected;
+	unsigned int seed = 3;
+	uint32_t i, j;
+	for (i = 0; i < 300; i++) {
+		seed = seed * 1103515245 + 12345;
+		samples[i] = (seed >> 16) % 50 + 1;
+		fail_unless(monodeque_push(m, (void*) samples[i], i) == MONODEQUE_SUCCESS);
+		if (expire && i + 1 >= width) {
+			monodeque_expire(m, i + 1 - width);
+		}
+		expected = samples[i];
+		for (j = i + 1 >= width ? i + 1 - width : 0; j <= i; j++) {
+			if (kind == MONODEQUE_MIN ? samples[j] < expected : samples[j] > expected) {
+				expected = samples[j];
+			}
+		}
+		fail_unless(monodeque_front(m) == (void*) expected);
+		fail_unless(samples[monodeque_front_pos(m)] == expected);
+		fail_unless(monodeque_count(m) <= width);
+	}
+	monodeque_free(m);
+}
+
+START_TEST (test_monodeque_window) {
+	check_window(MONODEQUE_MIN, 1, true);
+	check_window(MONODEQUE_MIN, 7, true);
+	check_window(MONODEQUE_MAX, 7, true);
+	check_window(MONODEQUE_MAX, 64, true);
+}
+END_TEST
+
+START_TEST (test_monodeque_capacity_window) {
+	MonoDeque m = monodeque_create(2, MONODEQUE_MIN, int_comparator);
+	
+	/* 1 is older than the last two pushes even though 5 was dropped */
+	monodeque_push(m, (void*) 1, 0);
+	monodeque_push(m, (void*) 5, 1);
+	monodeque_push(m, (void*) 3, 2);
+	monodeque_push(m, (void*) 2, 3);
+	fail_unless(monodeque_front(m) == (void*) 2);
+	monodeque_free(m);
+	
+	check_window(MONODEQUE_MIN, 1, false);
+	check_window(MONODEQUE_MIN, 7, false);
+	check_window(MONODEQUE_MAX, 64, false);
+}
+END_TEST
+
+START_TEST (test_monodeque_expire) {
+	MonoDeque m = monodeque_create(4, MONODEQUE_MAX, int_comparator);
+	fail_unless(monodeque_front(m) == NULL);
+	monodeque_push(m, (void*) 5, 10);
+	monodeque_push(m, (void*) 3, 20);
+	monodeque_push(m, (void*) 4, 30); /* drops 3 */
+	fail_unless(monodeque_count(m) == 2);
+	fail_unless(monodeque_front(m) == (void*) 5);
+	fail_unless(monodeque_expire(m, 25) == 1);
+	fail_unless(monodeque_front(m) == (void*) 4);
+	fail_unless(monodeque_front_pos(m) == 30);
+	
+	/* without expiry only the last capacity pushes count */
+	monodeque_clear(m);
+	fail_unless(monodeque_count(m) == 0);
+	monodeque_push(m, (void*) 9, 1);
+	monodeque_push(m, (void*) 8, 2);
+	monodeque_push(m, (void*) 7, 3);
+	monodeque_push(m, (void*) 6, 4);
+	fail_unless(monodeque_front(m) == (void*) 9);
+	monodeque_push(m, (void*) 5, 5);
+	fail_unless(monodeque_front(m) == (void*) 8);
+	monodeque_free(m);
+}
+END_TEST
+
+Suite*
+monodeque_suite(void) {
+	Suite *s = suite_create("MonoDeque");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("MonoDeque");
+	tcase_add_test(tc_core, test_monodeque_window);
+	tcase_add_test(tc_core, test_monodeque_capacity_window);
+	tcase_add_test(tc_core, test_monodeque_expire);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
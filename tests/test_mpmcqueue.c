@@ -0,0 +1,154 @@
+/* 
+ * test_mpmcqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include "tests.h"
+#include "../src/mpmcqueue.h"
+
+#define MPMC_THREADS (3)
+#define MPMC_ITEMS_PER_THREAD (100000)
+
+START_TEST (test_mpmcqueue_create) {
+	MPMCQueue q = mpmcqueue_create(100);
+	fail_if(q == NULL);
+	fail_unless(mpmcqueue_capacity(q) == 128);
+	fail_unless(mpmcqueue_count(q) == 0);
+	fail_unless(mpmcqueue_try_dequeue(q) == NULL);
+	mpmcqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_mpmcqueue_enqueue_dequeue) {
+	MPMCQueue q = mpmcqueue_create(2);
+	char* ts[] = {"t1", "t2", "t3"};
+	fail_unless(mpmcqueue_try_enqueue(q, ts[0]) == MPMCQUEUE_SUCCESS);
+	fail_unless(mpmcqueue_try_enqueue(q, ts[1]) == MPMCQUEUE_SUCCESS);
+	fail_unless(mpmcqueue_try_enqueue(q, ts[2]) == MPMCQUEUE_FULL);
+	fail_unless(mpmcqueue_count(q) == 2);
+	fail_unless(mpmcqueue_try_dequeue(q) == ts[0]);
+	fail_unless(mpmcqueue_try_enqueue(q, ts[2]) == MPMCQUEUE_SUCCESS);
+	fail_unless(mpmcqueue_try_dequeue(q) == ts[1]);
+	fail_unless(mpmcqueue_try_dequeue(q) == ts[2]);
+	fail_unless(mpmcqueue_try_dequeue(q) == NULL);
+	mpmcqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_mpmcqueue_batch) {
+	MPMCQueue q = mpmcqueue_create(8);
+	char* ts[] = {"t1", "t2", "t3", "t4", "t5", "t6"};
+	void* out[8];
+	uint32_t i;
+
+	fail_unless(mpmcqueue_enqueue_batch(q, (void**) ts, 6) == 6);
+	fail_unless(mpmcqueue_dequeue_batch(q, out, 5) == 5);
+	for (i = 0; i < 5; i++) {
+		fail_unless(out[i] == ts[i]);
+	}
+	fail_unless(mpmcqueue_enqueue_batch(q, (void**) ts, 6) == 6);
+	fail_unless(mpmcqueue_enqueue_batch(q, (void**) ts, 6) == 1);
+	fail_unless(mpmcqueue_dequeue_batch(q, out, 8) == 8);
+	fail_unless(out[0] == ts[5]);
+	for (i = 0; i < 6; i++) {
+		fail_unless(out[i + 1] == ts[i]);
+	}
+	fail_unless(out[7] == ts[0]);
+	fail_unless(mpmcqueue_dequeue_batch(q, out, 8) == 0);
+	mpmcqueue_free(q);
+}
+END_TEST
+
+static atomic_uint mpmc_seen[MPMC_THREADS * MPMC_ITEMS_PER_THREAD];
+static atomic_uint mpmc_received;
+
+static void *
+mpmc_producer(void *arg) {
+	MPMCQueue q = arg;
+	static atomic_uint next_base;
+	uintptr_t base = atomic_fetch_add(&next_base, 1) * MPMC_ITEMS_PER_THREAD;
+	uintptr_t i;
+	for (i = 1; i <= MPMC_ITEMS_PER_THREAD; i++) {
+		while (mpmcqueue_try_enqueue(q, (void*) (base + i)) != MPMCQUEUE_SUCCESS) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *
+mpmc_consumer(void *arg) {
+	MPMCQueue q = arg;
+	void* items[8];
+	uint32_t i, n;
+	while (atomic_load(&mpmc_received) < MPMC_THREADS * MPMC_ITEMS_PER_THREAD) {
+		if ((n = mpmcqueue_dequeue_batch(q, items, 8)) == 0) {
+			sched_yield();
+		}
+		for (i = 0; i < n; i++) {
+			atomic_fetch_add(&mpmc_seen[(uintptr_t) items[i] - 1], 1);
+		}
+		atomic_fetch_add(&mpmc_received, n);
+	}
+	return NULL;
+}
+
+START_TEST (test_mpmcqueue_threads) {
+	MPMCQueue q = mpmcqueue_create(64);
+	pthread_t producers[MPMC_THREADS];
+	pthread_t consumers[MPMC_THREADS];
+	uint32_t i;
+
+	for (i = 0; i < MPMC_THREADS; i++) {
+		pthread_create(&producers[i], NULL, mpmc_producer, q);
+		pthread_create(&consumers[i], NULL, mpmc_consumer, q);
+	}
+	for (i = 0; i < MPMC_THREADS; i++) {
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+
+	/* every item is received exactly once */
+	for (i = 0; i < MPMC_THREADS * MPMC_ITEMS_PER_THREAD; i++) {
+		fail_unless(mpmc_seen[i] == 1);
+	}
+	fail_unless(mpmcqueue_count(q) == 0);
+	mpmcqueue_free(q);
+}
+END_TEST
+
+Suite*
+mpmcqueue_suite(void) {
+	Suite *s = suite_create("MPMCQueue");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("MPMCQueue");
+	tcase_add_test(tc_core, test_mpmcqueue_create);
+	tcase_add_test(tc_core, test_mpmcqueue_enqueue_dequeue);
+	tcase_add_test(tc_core, test_mpmcqueue_batch);
+	tcase_add_test(tc_core, test_mpmcqueue_threads);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
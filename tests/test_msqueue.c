@@ -0,0 +1,162 @@
+/* 
+ * test_msqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <sched.h>
+#include "tests.h"
+#include "../src/msqueue.h"
+
+#define MS_THREADS (3)
+#define MS_ITEMS_PER_THREAD (100000)
+
+START_TEST (test_msqueue_create) {
+	MSQueue q = msqueue_create();
+	MSQueueThread t;
+	fail_if(q == NULL);
+	fail_unless(msqueue_empty(q));
+	t = msqueue_attach(q);
+	fail_if(t == NULL);
+	fail_unless(msqueue_dequeue(q, t) == NULL);
+	msqueue_detach(q, t);
+	msqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_msqueue_enqueue_dequeue) {
+	MSQueue q = msqueue_create();
+	MSQueueThread t = msqueue_attach(q);
+	char* ts[] = {"t1", "t2", "t3"};
+	msqueue_enqueue(q, t, ts[0]);
+	msqueue_enqueue(q, t, ts[1]);
+	msqueue_enqueue(q, t, ts[2]);
+	fail_if(msqueue_empty(q));
+	fail_unless(msqueue_dequeue(q, t) == ts[0]);
+	fail_unless(msqueue_dequeue(q, t) == ts[1]);
+	fail_unless(msqueue_dequeue(q, t) == ts[2]);
+	fail_unless(msqueue_dequeue(q, t) == NULL);
+	fail_unless(msqueue_empty(q));
+	msqueue_detach(q, t);
+	msqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_msqueue_reuse) {
+	MSQueue q = msqueue_create();
+	MSQueueThread t = msqueue_attach(q);
+	MSQueueThread t2;
+	struct msqueue_node_t *first;
+	uintptr_t i;
+
+	/* once reclaimed, nodes come back out of the pool */
+	for (i = 1; i <= 4 * MSQUEUE_POOL_BATCH; i++) {
+		msqueue_enqueue(q, t, (void*) i);
+		fail_unless(msqueue_dequeue(q, t) == (void*) i);
+	}
+	fail_unless(t->number_pooled > 0);
+	first = t->pool;
+	msqueue_enqueue(q, t, (void*) i);
+	fail_unless(atomic_load(&q->tail) == first);
+
+	/* a detached record is handed to the next thread */
+	msqueue_detach(q, t);
+	t2 = msqueue_attach(q);
+	fail_unless(t2 == t);
+	fail_unless(msqueue_dequeue(q, t2) == (void*) i);
+	msqueue_detach(q, t2);
+	msqueue_free(q);
+}
+END_TEST
+
+static atomic_uint ms_seen[MS_THREADS * MS_ITEMS_PER_THREAD];
+static atomic_uint ms_received;
+static atomic_uint ms_next_base;
+
+static void *
+ms_producer(void *arg) {
+	MSQueue q = arg;
+	MSQueueThread t = msqueue_attach(q);
+	uintptr_t base = atomic_fetch_add(&ms_next_base, 1) * MS_ITEMS_PER_THREAD;
+	uintptr_t i;
+	for (i = 1; i <= MS_ITEMS_PER_THREAD; i++) {
+		msqueue_enqueue(q, t, (void*) (base + i));
+	}
+	msqueue_detach(q, t);
+	return NULL;
+}
+
+static void *
+ms_consumer(void *arg) {
+	MSQueue q = arg;
+	MSQueueThread t = msqueue_attach(q);
+	uintptr_t item;
+	while (atomic_load(&ms_received) < MS_THREADS * MS_ITEMS_PER_THREAD) {
+		if ((item = (uintptr_t) msqueue_dequeue(q, t)) == 0) {
+			sched_yield();
+			continue;
+		}
+		atomic_fetch_add(&ms_seen[item - 1], 1);
+		atomic_fetch_add(&ms_received, 1);
+	}
+	msqueue_detach(q, t);
+	return NULL;
+}
+
+START_TEST (test_msqueue_threads) {
+	MSQueue q = msqueue_create();
+	pthread_t producers[MS_THREADS];
+	pthread_t consumers[MS_THREADS];
+	uint32_t i;
+
+	for (i = 0; i < MS_THREADS; i++) {
+		pthread_create(&producers[i], NULL, ms_producer, q);
+		pthread_create(&consumers[i], NULL, ms_consumer, q);
+	}
+	for (i = 0; i < MS_THREADS; i++) {
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+
+	/* every item is received exactly once */
+	for (i = 0; i < MS_THREADS * MS_ITEMS_PER_THREAD; i++) {
+		fail_unless(ms_seen[i] == 1);
+	}
+	fail_unless(msqueue_empty(q));
+	msqueue_free(q);
+}
+END_TEST
+
+Suite*
+msqueue_suite(void) {
+	Suite *s = suite_create("MSQueue");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("MSQueue");
+	tcase_add_test(tc_core, test_msqueue_create);
+	tcase_add_test(tc_core, test_msqueue_enqueue_dequeue);
+	tcase_add_test(tc_core, test_msqueue_reuse);
+	tcase_add_test(tc_core, test_msqueue_threads);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
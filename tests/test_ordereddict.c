@@ -0,0 +1,164 @@
+/* 
+ * test_ordereddict.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/ordereddict.h"
+
+static int8_t
+od_string_comparator(const void *a, const void *b) {
+	return strcmp((char*) a, (char*) b);
+}
+
+START_TEST (test_ordereddict_strings) {
+	OrderedDict d = ordereddict_create(hashmap_hash_string, od_string_comparator);
+	const char *expected[] = {"b", "c", "a"};
+	void *key, *value;
+	uint32_t iter = 0, i = 0;
+	
+	fail_if(d == NULL);
+	fail_unless(ordereddict_put(d, "a", (void*) 1) == ORDEREDDICT_SUCCESS);
+	fail_unless(ordereddict_put(d, "b", (void*) 2) == ORDEREDDICT_SUCCESS);
+	fail_unless(ordereddict_put(d, "c", (void*) 3) == ORDEREDDICT_SUCCESS);
+	
+	/* replacing a value keeps the key's place */
+	fail_unless(ordereddict_put(d, "b", (void*) 4) == ORDEREDDICT_SUCCESS);
+	fail_unless(ordereddict_get(d, "b") == (void*) 4);
+	fail_unless(ordereddict_move_to_end(d, "a", true) == ORDEREDDICT_SUCCESS);
+	fail_unless(ordereddict_move_to_end(d, "z", true) == ORDEREDDICT_FAILURE);
+	fail_unless(ordereddict_count(d) == 3);
+	while (ordereddict_next(d, &iter, &key, &value)) {
+		fail_unless(strcmp(key, expected[i++]) == 0);
+	}
+	fail_unless(i == 3);
+	
+	fail_unless(ordereddict_popitem(d, false, &key, &value) == ORDEREDDICT_SUCCESS);
+	fail_unless(strcmp(key, "b") == 0 && value == (void*) 4);
+	fail_unless(ordereddict_popitem(d, true, &key, &value) == ORDEREDDICT_SUCCESS);
+	fail_unless(strcmp(key, "a") == 0 && value == (void*) 1);
+	fail_unless(ordereddict_remove(d, "c") == (void*) 3);
+	fail_unless(ordereddict_remove(d, "c") == NULL);
+	fail_unless(ordereddict_popitem(d, true, &key, &value) == ORDEREDDICT_FAILURE);
+	fail_unless(ordereddict_count(d) == 0);
+	ordereddict_free(d);
+}
+END_TEST
+
+START_TEST (test_ordereddict_random) {
+	OrderedDict d = ordereddict_create(NULL, NULL);
+	uintptr_t model[256], key;
+	uint32_t n = 0, i, j, iter;
+	unsigned int seed = 77;
+	void *k, *v;
+	int round, op;
+	
+	/* model holds the keys in order; each key's value is key * 3 */
+	for (round = 0; round < 40000; round++) {
+		seed = seed * 1103515245 + 12345;
+		key = 1 + (seed >> 8) % 200;
+		op = (seed >> 20) % 6;
+		for (i = 0; i < n && model[i] != key; i++);
+		if (op == 0 || op == 1) {
+			fail_unless(ordereddict_put(d, (void*) key, (void*) (key * 3)) == ORDEREDDICT_SUCCESS);
+			if (i == n) {
+				model[n++] = key;
+			}
+		} else if (op == 2) {
+			fail_unless(ordereddict_remove(d, (void*) key) == (i < n ? (void*) (key * 3) : NULL));
+			if (i < n) {
+				memmove(&model[i], &model[i + 1], (--n - i) * sizeof(uintptr_t));
+			}
+		} else if (op == 3) {
+			fail_unless(ordereddict_move_to_end(d, (void*) key, (seed >> 4) & 1)
+			            == (i < n ? ORDEREDDICT_SUCCESS : ORDEREDDICT_FAILURE));
+			if (i < n && (seed >> 4) & 1) {
+				memmove(&model[i], &model[i + 1], (n - i - 1) * sizeof(uintptr_t));
+				model[n - 1] = key;
+			} else if (i < n) {
+				memmove(&model[1], &model[0], i * sizeof(uintptr_t));
+				model[0] = key;
+			}
+		} else if (op == 4 && (seed >> 4) % 4 == 0) {
+			fail_unless(ordereddict_popitem(d, (seed >> 6) & 1, &k, &v)
+			            == (n > 0 ? ORDEREDDICT_SUCCESS : ORDEREDDICT_FAILURE));
+			if (n > 0 && (seed >> 6) & 1) {
+				fail_unless(k == (void*) model[--n]);
+			} else if (n > 0) {
+				fail_unless(k == (void*) model[0]);
+				memmove(&model[0], &model[1], --n * sizeof(uintptr_t));
+			}
+		} else {
+			fail_unless(ordereddict_get(d, (void*) key) == (i < n ? (void*) (key * 3) : NULL));
+		}
+		fail_unless(ordereddict_count(d) == n);
+		if (round % 97 == 0) {
+			iter = 0;
+			for (j = 0; ordereddict_next(d, &iter, &k, &v); j++) {
+				fail_unless(j < n && k == (void*) model[j] && v == (void*) (model[j] * 3));
+			}
+			fail_unless(j == n);
+		}
+	}
+	ordereddict_free(d);
+}
+END_TEST
+
+START_TEST (test_ordereddict_churn) {
+	OrderedDict d = ordereddict_create_size(100, NULL, NULL);
+	uintptr_t i;
+	void *k, *v;
+	
+	/* an LRU pattern: touch keys round robin, then evict the oldest */
+	for (i = 1; i <= 100; i++) {
+		fail_unless(ordereddict_put(d, (void*) i, (void*) i) == ORDEREDDICT_SUCCESS);
+	}
+	for (i = 0; i < 100000; i++) {
+		fail_unless(ordereddict_move_to_end(d, (void*) (1 + i % 100), true) == ORDEREDDICT_SUCCESS);
+	}
+	fail_unless(d->capacity < 1000);
+	fail_unless(ordereddict_popitem(d, false, &k, &v) == ORDEREDDICT_SUCCESS);
+	fail_unless(k == (void*) 1);
+	for (i = 0; i < 99000; i++) {
+		fail_unless(ordereddict_move_to_end(d, (void*) (2 + i % 99), false) == ORDEREDDICT_SUCCESS);
+	}
+	fail_unless(d->capacity < 1000);
+	fail_unless(ordereddict_popitem(d, true, &k, &v) == ORDEREDDICT_SUCCESS);
+	fail_unless(k == (void*) 2);
+	ordereddict_free(d);
+}
+END_TEST
+
+Suite*
+ordereddict_suite(void) {
+	Suite *s = suite_create("OrderedDict");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("OrderedDict");
+	tcase_add_test(tc_core, test_ordereddict_strings);
+	tcase_add_test(tc_core, test_ordereddict_random);
+	tcase_add_test(tc_core, test_ordereddict_churn);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
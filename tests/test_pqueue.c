@@ -0,0 +1,159 @@
+/* 
+ * test_pqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdlib.h>
+#include "tests.h"
+#include "../src/pqueue.h"
+#include "../src/bloomfilter.h"
+
+static int8_t
+pq_int_comparator(void *a, void *b) {
+	intptr_t x = (intptr_t) a, y = (intptr_t) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Pop everything and check it comes out in ascending order */
+static void
+check_drain(PQueue q, uint32_t expected_count) {
+	intptr_t prev = INTPTR_MIN, item;
+	uint32_t n = 0;
+	while (pqueue_count(q) > 0) {
+		item = (intptr_t) pqueue_peek(q);
+		fail_unless((intptr_t) pqueue_pop(q) == item);
+		fail_unless(item >= prev);
+		prev = item;
+		n++;
+	}
+	fail_unless(n == expected_count);
+	fail_unless(pqueue_pop(q) == NULL);
+	fail_unless(pqueue_peek(q) == NULL);
+}
+
+START_TEST (test_pqueue_push_pop) {
+	PQueue q = pqueue_create(pq_int_comparator);
+	struct pqueue_t binary;
+	unsigned int seed = 5;
+	intptr_t i;
+	
+	pqueue_init(&binary, arraylist_create(pq_int_comparator), 2);
+	for (i = 0; i < 500; i++) {
+		seed = seed * 1103515245 + 12345;
+		fail_unless(pqueue_push(q, (void*) (intptr_t) (seed >> 16)) == PQUEUE_SUCCESS);
+		fail_unless(pqueue_push(&binary, (void*) (intptr_t) (seed >> 16)) == PQUEUE_SUCCESS);
+	}
+	/* interleave some pops with pushes */
+	for (i = 0; i < 100; i++) {
+		pqueue_pop(q);
+		pqueue_push(q, (void*) i);
+	}
+	check_drain(q, 500);
+	check_drain(&binary, 500);
+	arraylist_free(binary.list);
+	pqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_pqueue_heapify) {
+	ArrayList list = arraylist_create(pq_int_comparator);
+	void* batch[300];
+	PQueue q;
+	intptr_t i;
+	
+	for (i = 0; i < 1000; i++) {
+		arraylist_append(list, (void*) ((i * 7919) % 1000));
+	}
+	q = pqueue_create_from(list);
+	fail_unless(pqueue_peek(q) == (void*) 0);
+	
+	/* a small batch is sifted in, a large one triggers a heapify */
+	for (i = 0; i < 300; i++) {
+		batch[i] = (void*) (300 - i);
+	}
+	fail_unless(pqueue_push_batch(q, batch, 10) == PQUEUE_SUCCESS);
+	check_drain(q, 1010);
+	fail_unless(pqueue_push_batch(q, batch, 300) == PQUEUE_SUCCESS);
+	fail_unless(pqueue_push_batch(q, batch, 300) == PQUEUE_SUCCESS);
+	fail_unless(pqueue_peek(q) == (void*) 1);
+	check_drain(q, 600);
+	pqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_pqueue_fixed) {
+	void* buffer[4] = {NULL};
+	void* batch[] = {(void*) 3, (void*) 1, (void*) 2};
+	struct pqueue_t q;
+	
+	pqueue_init(&q, arraylist_create_static(buffer, 4, pq_int_comparator), 4);
+	fail_unless(pqueue_push(&q, (void*) 9) == PQUEUE_SUCCESS);
+	fail_unless(pqueue_push_batch(&q, batch, 3) == PQUEUE_SUCCESS);
+	fail_unless(pqueue_push(&q, (void*) 0) == PQUEUE_FAILURE);
+	fail_unless(pqueue_push_batch(&q, batch, 3) == PQUEUE_FAILURE);
+	fail_unless(pqueue_pop(&q) == (void*) 1);
+	fail_unless(pqueue_push_batch(&q, batch, 3) == PQUEUE_FAILURE);
+	fail_unless(pqueue_count(&q) == 4);
+	check_drain(&q, 4);
+	free(q.list);
+}
+END_TEST
+
+#ifdef ARRAYLIST_FILTER
+START_TEST (test_pqueue_filter) {
+	PQueue q = pqueue_create(pq_int_comparator);
+	BloomFilter f = bloomfilter_create(100, NULL);
+	intptr_t i;
+	
+	arraylist_set_filter(q->list, f);
+	for (i = 1; i <= 50; i++) {
+		pqueue_push(q, (void*) (i * 8));
+	}
+	for (i = 1; i <= 20; i++) {
+		fail_unless(pqueue_pop(q) == (void*) (i * 8));
+	}
+	fail_unless(bloomfilter_count(f) == pqueue_count(q));
+	fail_if(arraylist_contains(q->list, (void*) 8));
+	fail_unless(arraylist_contains(q->list, (void*) 400));
+	arraylist_set_filter(q->list, NULL);
+	bloomfilter_free(f);
+	pqueue_free(q);
+}
+END_TEST
+#endif /* ARRAYLIST_FILTER */
+
+Suite*
+pqueue_suite(void) {
+	Suite *s = suite_create("PQueue");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("PQueue");
+	tcase_add_test(tc_core, test_pqueue_push_pop);
+	tcase_add_test(tc_core, test_pqueue_heapify);
+	tcase_add_test(tc_core, test_pqueue_fixed);
+#ifdef ARRAYLIST_FILTER
+	tcase_add_test(tc_core, test_pqueue_filter);
+#endif
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
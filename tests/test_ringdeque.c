@@ -0,0 +1,170 @@
+/* 
+ * test_ringdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <string.h>
+#include "tests.h"
+#include "../src/ringdeque.h"
+
+static int8_t
+ring_string_comparator(const void *a, const void *b) {
+	return strcmp((char*) a, (char*) b);
+}
+
+START_TEST (test_ringdeque_create) {
+	RingDeque d = ringdeque_create(ring_string_comparator);
+	fail_if(d == NULL);
+	fail_unless(ringdeque_count(d) == 0);
+	fail_unless(ringdeque_pop(d) == NULL);
+	fail_unless(ringdeque_popleft(d) == NULL);
+	ringdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_ringdeque_append_pop) {
+	RingDeque d = ringdeque_create_size(2, ring_string_comparator);
+	char* ts[] = {"t1", "t2", "t3", "t4"};
+	ringdeque_append(d, ts[1]);
+	ringdeque_appendleft(d, ts[0]);
+	ringdeque_append(d, ts[2]); /* grows */
+	ringdeque_append(d, ts[3]);
+
+	fail_unless(ringdeque_count(d) == 4);
+	fail_unless(ringdeque_contains(d, "t3"));
+	fail_if(ringdeque_contains(d, "foo"));
+	fail_unless(ringdeque_peekleft(d) == ts[0]);
+	fail_unless(ringdeque_peek(d) == ts[3]);
+	fail_unless(ringdeque_popleft(d) == ts[0]);
+	fail_unless(ringdeque_pop(d) == ts[3]);
+	fail_unless(ringdeque_popleft(d) == ts[1]);
+	fail_unless(ringdeque_pop(d) == ts[2]);
+	fail_unless(ringdeque_count(d) == 0);
+	ringdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_ringdeque_static) {
+	struct ringdeque_t d;
+	void* buffer[3];
+	char* ts[] = {"t1", "t2", "t3", "t4"};
+	ringdeque_init_static(&d, buffer, 3, NULL);
+	fail_unless(ringdeque_append(&d, ts[0]) == RINGDEQUE_SUCCESS);
+	fail_unless(ringdeque_append(&d, ts[1]) == RINGDEQUE_SUCCESS);
+	fail_unless(ringdeque_appendleft(&d, ts[2]) == RINGDEQUE_SUCCESS);
+	fail_unless(ringdeque_append(&d, ts[3]) == RINGDEQUE_FAILURE);
+	fail_unless(ringdeque_popleft(&d) == ts[2]);
+	fail_unless(ringdeque_append(&d, ts[3]) == RINGDEQUE_SUCCESS);
+	fail_unless(ringdeque_count(&d) == 3);
+}
+END_TEST
+
+START_TEST (test_ringdeque_spans) {
+	struct ringdeque_t d;
+	void* buffer[4];
+	void** a;
+	void** b;
+	uint32_t alen, blen;
+	intptr_t i;
+
+	ringdeque_init_static(&d, buffer, 4, NULL);
+	fail_unless(ringdeque_peek_spans(&d, &a, &alen, &b, &blen) == 0);
+	fail_unless(alen == 0 && blen == 0);
+
+	/* contiguous */
+	for (i = 1; i <= 3; i++) {
+		ringdeque_append(&d, (void*) i);
+	}
+	fail_unless(ringdeque_peek_spans(&d, &a, &alen, &b, &blen) == 3);
+	fail_unless(alen == 3 && blen == 0 && b == NULL);
+	fail_unless(a[0] == (void*) 1 && a[2] == (void*) 3);
+
+	/* wrapped: 3 4 | 5 */
+	fail_unless(ringdeque_consume(&d, 2) == 2);
+	ringdeque_append(&d, (void*) 4);
+	ringdeque_append(&d, (void*) 5);
+	fail_unless(ringdeque_peek_spans(&d, &a, &alen, &b, &blen) == 3);
+	fail_unless(alen == 2 && blen == 1);
+	fail_unless(a[0] == (void*) 3 && a[1] == (void*) 4 && b[0] == (void*) 5);
+
+	/* consuming more than there is empties the ring deque */
+	fail_unless(ringdeque_consume(&d, 10) == 3);
+	fail_unless(ringdeque_count(&d) == 0);
+	fail_unless(ringdeque_popleft(&d) == NULL);
+}
+END_TEST
+
+START_TEST (test_ringdeque_indexing) {
+	RingDeque d = ringdeque_create_size(8, NULL);
+	intptr_t model[64];
+	uint32_t n = 0, i, pos;
+	unsigned int seed = 1;
+	intptr_t next = 0;
+	int round;
+	
+	fail_unless(ringdeque_getitem(d, 0) == NULL);
+	fail_unless(ringdeque_setitem(d, 0, NULL) == RINGDEQUE_INDEX_ERROR);
+	fail_unless(ringdeque_insert(d, 1, NULL) == RINGDEQUE_INDEX_ERROR);
+	
+	/* random inserts and deletes, checked against a plain array */
+	for (round = 0; round < 2000; round++) {
+		seed = seed * 1103515245 + 12345;
+		pos = (seed >> 8) % (n + 1);
+		if (n < 64 && (n == 0 || (seed >> 20) % 3 != 0)) {
+			fail_unless(ringdeque_insert(d, pos, (void*) ++next) == RINGDEQUE_SUCCESS);
+			memmove(model + pos + 1, model + pos, (n - pos) * sizeof(intptr_t));
+			model[pos] = next;
+			n++;
+		} else {
+			pos = pos % n;
+			fail_unless(ringdeque_del(d, (int32_t) pos - (int32_t) n) == (void*) model[pos]);
+			memmove(model + pos, model + pos + 1, (n - pos - 1) * sizeof(intptr_t));
+			n--;
+		}
+		fail_unless(ringdeque_count(d) == n);
+		for (i = 0; i < n; i++) {
+			fail_unless(ringdeque_getitem(d, i) == (void*) model[i]);
+		}
+	}
+	
+	fail_unless(n > 0);
+	fail_unless(ringdeque_setitem(d, -1, (void*) 7) == RINGDEQUE_SUCCESS);
+	fail_unless(ringdeque_peek(d) == (void*) 7);
+	ringdeque_free(d);
+}
+END_TEST
+
+Suite*
+ringdeque_suite(void) {
+	Suite *s = suite_create("RingDeque");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("RingDeque");
+	tcase_add_test(tc_core, test_ringdeque_create);
+	tcase_add_test(tc_core, test_ringdeque_append_pop);
+	tcase_add_test(tc_core, test_ringdeque_static);
+	tcase_add_test(tc_core, test_ringdeque_spans);
+	tcase_add_test(tc_core, test_ringdeque_indexing);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
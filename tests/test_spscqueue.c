@@ -0,0 +1,164 @@
+/* 
+ * test_spscqueue.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <sched.h>
+#include "tests.h"
+#include "../src/spscqueue.h"
+
+#define SPSC_TRANSFER_ITEMS (1000000)
+
+START_TEST (test_spscqueue_create) {
+	SPSCQueue q = spscqueue_create(5);
+	fail_if(q == NULL);
+	fail_unless(spscqueue_capacity(q) == 8);
+	fail_unless(spscqueue_count(q) == 0);
+	fail_unless(spscqueue_dequeue(q) == NULL);
+	spscqueue_free(q);
+	
+	/* rounding up past 2^31 would overflow */
+	fail_unless(spscqueue_create(UINT32_MAX / 2 + 2) == NULL);
+	fail_unless(spscqueue_create(UINT32_MAX) == NULL);
+}
+END_TEST
+
+START_TEST (test_spscqueue_enqueue_dequeue) {
+	SPSCQueue q = spscqueue_create(4);
+	char* ts[] = {"t1", "t2", "t3", "t4", "t5"};
+	fail_unless(spscqueue_enqueue(q, ts[0]) == SPSCQUEUE_SUCCESS);
+	fail_unless(spscqueue_enqueue(q, ts[1]) == SPSCQUEUE_SUCCESS);
+	fail_unless(spscqueue_enqueue(q, ts[2]) == SPSCQUEUE_SUCCESS);
+	fail_unless(spscqueue_enqueue(q, ts[3]) == SPSCQUEUE_SUCCESS);
+	fail_unless(spscqueue_enqueue(q, ts[4]) == SPSCQUEUE_FULL);
+	fail_unless(spscqueue_count(q) == 4);
+
+	fail_unless(spscqueue_dequeue(q) == ts[0]);
+	fail_unless(spscqueue_enqueue(q, ts[4]) == SPSCQUEUE_SUCCESS);
+	fail_unless(spscqueue_dequeue(q) == ts[1]);
+	fail_unless(spscqueue_dequeue(q) == ts[2]);
+	fail_unless(spscqueue_dequeue(q) == ts[3]);
+	fail_unless(spscqueue_dequeue(q) == ts[4]);
+	fail_unless(spscqueue_dequeue(q) == NULL);
+	spscqueue_free(q);
+}
+END_TEST
+
+START_TEST (test_spscqueue_batch) {
+	SPSCQueue q = spscqueue_create(8);
+	char* ts[] = {"t1", "t2", "t3", "t4", "t5", "t6"};
+	void* out[8];
+	uint32_t i;
+
+	fail_unless(spscqueue_enqueue_batch(q, (void**) ts, 6) == 6);
+	fail_unless(spscqueue_dequeue_batch(q, out, 4) == 4);
+	for (i = 0; i < 4; i++) {
+		fail_unless(out[i] == ts[i]);
+	}
+
+	/* this batch wraps around the end of the ring and is cut short */
+	fail_unless(spscqueue_enqueue_batch(q, (void**) ts, 6) == 6);
+	fail_unless(spscqueue_enqueue_batch(q, (void**) ts, 6) == 0);
+	fail_unless(spscqueue_dequeue_batch(q, out, 8) == 8);
+	fail_unless(out[0] == ts[4]);
+	fail_unless(out[1] == ts[5]);
+	for (i = 0; i < 6; i++) {
+		fail_unless(out[i + 2] == ts[i]);
+	}
+	fail_unless(spscqueue_dequeue_batch(q, out, 8) == 0);
+	spscqueue_free(q);
+}
+END_TEST
+
+static void *
+spsc_producer(void *arg) {
+	SPSCQueue q = arg;
+	uintptr_t i;
+	for (i = 1; i <= SPSC_TRANSFER_ITEMS; i++) {
+		while (spscqueue_enqueue(q, (void*) i) != SPSCQUEUE_SUCCESS) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static atomic_bool spsc_done;
+
+/* a third thread may read the count at any time, and it never exceeds
+ * the capacity
+ */
+static void *
+spsc_counter(void *arg) {
+	SPSCQueue q = arg;
+	uintptr_t bad = 0;
+	while (!atomic_load(&spsc_done)) {
+		if (spscqueue_count(q) > spscqueue_capacity(q)) {
+			bad++;
+		}
+	}
+	return (void*) bad;
+}
+
+START_TEST (test_spscqueue_threads) {
+	SPSCQueue q = spscqueue_create(64);
+	pthread_t producer, counter;
+	uintptr_t expected = 1;
+	void* items[16];
+	void* bad;
+	uint32_t i, n;
+
+	atomic_store(&spsc_done, false);
+	pthread_create(&counter, NULL, spsc_counter, q);
+	pthread_create(&producer, NULL, spsc_producer, q);
+	while (expected <= SPSC_TRANSFER_ITEMS) {
+		if ((n = spscqueue_dequeue_batch(q, items, 16)) == 0) {
+			sched_yield();
+		}
+		for (i = 0; i < n; i++) {
+			fail_unless(items[i] == (void*) expected++);
+		}
+	}
+	pthread_join(producer, NULL);
+	atomic_store(&spsc_done, true);
+	pthread_join(counter, &bad);
+	fail_unless(bad == NULL);
+	fail_unless(spscqueue_count(q) == 0);
+	spscqueue_free(q);
+}
+END_TEST
+
+Suite*
+spscqueue_suite(void) {
+	Suite *s = suite_create("SPSCQueue");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("SPSCQueue");
+	tcase_add_test(tc_core, test_spscqueue_create);
+	tcase_add_test(tc_core, test_spscqueue_enqueue_dequeue);
+	tcase_add_test(tc_core, test_spscqueue_batch);
+	tcase_add_test(tc_core, test_spscqueue_threads);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
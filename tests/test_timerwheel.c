@@ -0,0 +1,155 @@
+/* 
+ * test_timerwheel.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/timerwheel.h"
+
+START_TEST (test_timerwheel_expiry) {
+	TimerWheel w = timerwheel_create(1000);
+	struct timerwheel_timer_t timers[200];
+	struct ideque_t expired;
+	IDequeLink link;
+	TimerWheelTimer t;
+	uint64_t deltas[] = {1, 2, 255, 256, 257, 65535, 65536, 65537, 16777216 + 3};
+	uint64_t prev = 1000, now = 1000, last = 0;
+	unsigned int seed = 11;
+	uint32_t i, fired = 0;
+
+	ideque_init(&expired);
+	for (i = 0; i < 200; i++) {
+		timerwheel_timer_init(&timers[i]);
+		seed = seed * 1103515245 + 12345;
+		timerwheel_schedule(w, &timers[i], 1000 + (i < 9 ? deltas[i] : (seed >> 8) % 300000));
+	}
+	fail_unless(timerwheel_count(w) == 200);
+	
+	/* every timer fires in the advance that covers its expiry tick */
+	while (timerwheel_count(w) > 0) {
+		seed = seed * 1103515245 + 12345;
+		now += 1 + (seed >> 16) % 1000;
+		fail_unless(timerwheel_advance(w, now, &expired) == ideque_count(&expired));
+		while ((link = ideque_popleft(&expired)) != NULL) {
+			t = TIMERWHEEL_TIMER(link);
+			fail_unless(t->expires > prev && t->expires <= now);
+			fail_unless(t->expires >= last);
+			fail_if(timerwheel_pending(w, t));
+			last = t->expires;
+			fired++;
+		}
+		prev = now;
+	}
+	fail_unless(fired == 200);
+	fail_unless(now > 1000 + 16777216);
+	fail_unless(timerwheel_now(w) == now);
+	timerwheel_free(w);
+}
+END_TEST
+
+START_TEST (test_timerwheel_cancel) {
+	struct timerwheel_t w;
+	struct timerwheel_timer_t a, b, c;
+	struct ideque_t expired;
+	
+	timerwheel_init(&w, 0);
+	ideque_init(&expired);
+	timerwheel_timer_init(&a);
+	timerwheel_timer_init(&b);
+	timerwheel_timer_init(&c);
+	fail_if(timerwheel_cancel(&w, &a));
+	
+	timerwheel_schedule(&w, &a, 10);
+	timerwheel_schedule(&w, &b, 1000);
+	timerwheel_schedule(&w, &c, 20);
+	fail_unless(timerwheel_pending(&w, &b));
+	fail_unless(timerwheel_cancel(&w, &b));
+	fail_if(timerwheel_pending(&w, &b));
+	fail_unless(timerwheel_count(&w) == 2);
+	
+	/* rescheduling moves the timer, including into the past */
+	timerwheel_schedule(&w, &c, 5);
+	fail_unless(timerwheel_count(&w) == 2);
+	fail_unless(timerwheel_advance(&w, 5, &expired) == 1);
+	fail_unless(ideque_peekleft(&expired) == &c.link);
+	
+	/* cancelling a timer still in the expired deque unlinks it */
+	fail_if(timerwheel_cancel(&w, &c));
+	fail_unless(ideque_count(&expired) == 0);
+	timerwheel_schedule(&w, &c, 1);
+	fail_unless(timerwheel_advance(&w, 6, &expired) == 1);
+	fail_unless(ideque_popleft(&expired) == &c.link);
+	
+	fail_unless(timerwheel_advance(&w, 100000, &expired) == 1);
+	fail_unless(ideque_popleft(&expired) == &a.link);
+	fail_unless(timerwheel_count(&w) == 0);
+	fail_unless(timerwheel_advance(&w, 200000, &expired) == 0);
+}
+END_TEST
+
+START_TEST (test_timerwheel_reschedule_expired) {
+	struct timerwheel_t w;
+	struct timerwheel_timer_t a, b;
+	struct ideque_t expired;
+	IDequeLink link, next;
+	
+	timerwheel_init(&w, 0);
+	ideque_init(&expired);
+	timerwheel_timer_init(&a);
+	timerwheel_timer_init(&b);
+	timerwheel_schedule(&w, &a, 1);
+	timerwheel_schedule(&w, &b, 1);
+	fail_unless(timerwheel_advance(&w, 1, &expired) == 2);
+	fail_unless(timerwheel_count(&w) == 0);
+	
+	/* periodic timers: reschedule each one while walking the expired deque */
+	for (link = ideque_peekleft(&expired); link != NULL; link = next) {
+		next = ideque_next(&expired, link);
+		timerwheel_schedule(&w, TIMERWHEEL_TIMER(link), 5);
+	}
+	fail_unless(ideque_count(&expired) == 0);
+	fail_unless(timerwheel_count(&w) == 2);
+	fail_unless(timerwheel_pending(&w, &a) && timerwheel_pending(&w, &b));
+	
+	/* rescheduling a pending timer does not count it twice */
+	timerwheel_schedule(&w, &a, 6);
+	fail_unless(timerwheel_count(&w) == 2);
+	fail_unless(timerwheel_advance(&w, 10, &expired) == 2);
+	fail_unless(ideque_popleft(&expired) == &b.link);
+	fail_unless(ideque_popleft(&expired) == &a.link);
+	fail_unless(ideque_count(&expired) == 0);
+}
+END_TEST
+
+Suite*
+timerwheel_suite(void) {
+	Suite *s = suite_create("TimerWheel");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("TimerWheel");
+	tcase_add_test(tc_core, test_timerwheel_expiry);
+	tcase_add_test(tc_core, test_timerwheel_cancel);
+	tcase_add_test(tc_core, test_timerwheel_reschedule_expired);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
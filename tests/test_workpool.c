@@ -0,0 +1,95 @@
+/* 
+ * test_workpool.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include "tests.h"
+#include "../src/workpool.h"
+
+struct fib_args {
+	uint32_t n;
+	uint64_t result;
+};
+
+static void
+fib_task(void *arg) {
+	struct fib_args *f = arg;
+	struct fib_args left, right;
+	struct workpool_group_t group;
+	struct workpool_task_t task;
+
+	if (f->n < 2) {
+		f->result = f->n;
+		return;
+	}
+	left.n = f->n - 1;
+	right.n = f->n - 2;
+	workpool_group_init(&group);
+	workpool_spawn(&group, &task, fib_task, &left);
+	fib_task(&right);
+	workpool_sync(&group);
+	f->result = left.result + right.result;
+}
+
+START_TEST (test_workpool_create) {
+	WorkPool p = workpool_create(4);
+	fail_if(p == NULL);
+	fail_unless(p->number_workers == 4);
+	workpool_free(p);
+}
+END_TEST
+
+START_TEST (test_workpool_run) {
+	WorkPool p = workpool_create(4);
+	struct fib_args f = {20, 0};
+	workpool_run(p, fib_task, &f);
+	fail_unless(f.result == 6765);
+
+	/* the pool can be reused */
+	f.n = 25;
+	workpool_run(p, fib_task, &f);
+	fail_unless(f.result == 75025);
+	workpool_free(p);
+}
+END_TEST
+
+START_TEST (test_workpool_inline) {
+	/* outside of a pool spawned tasks are run inline */
+	struct fib_args f = {15, 0};
+	fib_task(&f);
+	fail_unless(f.result == 610);
+}
+END_TEST
+
+Suite*
+workpool_suite(void) {
+	Suite *s = suite_create("WorkPool");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("WorkPool");
+	tcase_add_test(tc_core, test_workpool_create);
+	tcase_add_test(tc_core, test_workpool_run);
+	tcase_add_test(tc_core, test_workpool_inline);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
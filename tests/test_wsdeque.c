@@ -0,0 +1,163 @@
+/* 
+ * test_wsdeque.c
+ * 
+ * Copyright (c) 2010 Paul Osborne <osbpau@gmail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <check.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "tests.h"
+#include "../src/wsdeque.h"
+
+#define WS_STEAL_ITEMS (100000)
+#define WS_THIEVES (3)
+
+START_TEST (test_wsdeque_create) {
+	WSDeque d = wsdeque_create(0);
+	fail_if(d == NULL);
+	fail_unless(wsdeque_count(d) == 0);
+	fail_unless(wsdeque_pop(d) == NULL);
+	fail_unless(wsdeque_steal(d) == NULL);
+	wsdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_wsdeque_push_pop) {
+	WSDeque d = wsdeque_create(4);
+	char* ts[] = {"t1", "t2", "t3"};
+	wsdeque_push(d, ts[0]);
+	wsdeque_push(d, ts[1]);
+	wsdeque_push(d, ts[2]);
+
+	/* the owner end is LIFO */
+	fail_unless(wsdeque_count(d) == 3);
+	fail_unless(wsdeque_pop(d) == ts[2]);
+	fail_unless(wsdeque_pop(d) == ts[1]);
+	fail_unless(wsdeque_pop(d) == ts[0]);
+	fail_unless(wsdeque_pop(d) == NULL);
+	fail_unless(wsdeque_count(d) == 0);
+	wsdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_wsdeque_steal) {
+	WSDeque d = wsdeque_create(4);
+	char* ts[] = {"t1", "t2", "t3"};
+	wsdeque_push(d, ts[0]);
+	wsdeque_push(d, ts[1]);
+	wsdeque_push(d, ts[2]);
+
+	/* the thief end is FIFO */
+	fail_unless(wsdeque_steal(d) == ts[0]);
+	fail_unless(wsdeque_pop(d) == ts[2]);
+	fail_unless(wsdeque_steal(d) == ts[1]);
+	fail_unless(wsdeque_steal(d) == NULL);
+	fail_unless(wsdeque_pop(d) == NULL);
+	wsdeque_free(d);
+}
+END_TEST
+
+START_TEST (test_wsdeque_grow) {
+	WSDeque d = wsdeque_create(2);
+	intptr_t i;
+	for (i = 1; i <= 1000; i++) {
+		fail_unless(wsdeque_push(d, (void*) i) == WSDEQUE_SUCCESS);
+		if (i % 3 == 0) {
+			/* move top so that the live range wraps when growing */
+			fail_unless(wsdeque_steal(d) == (void*) (i / 3));
+		}
+	}
+	fail_unless(wsdeque_count(d) == 1000 - 333);
+	for (i = 1000; i > 333; i--) {
+		fail_unless(wsdeque_pop(d) == (void*) i);
+	}
+	fail_unless(wsdeque_pop(d) == NULL);
+	wsdeque_free(d);
+}
+END_TEST
+
+struct ws_thief_args {
+	WSDeque d;
+	atomic_int *done;
+	atomic_uint *seen;
+};
+
+static void *
+ws_thief(void *arg) {
+	struct ws_thief_args *a = arg;
+	intptr_t item;
+	while (!atomic_load(a->done) || wsdeque_count(a->d) > 0) {
+		if ((item = (intptr_t) wsdeque_steal(a->d)) != 0) {
+			atomic_fetch_add(&a->seen[item - 1], 1);
+		}
+	}
+	return NULL;
+}
+
+START_TEST (test_wsdeque_concurrent_steal) {
+	WSDeque d = wsdeque_create(8);
+	atomic_uint *seen = calloc(WS_STEAL_ITEMS, sizeof(atomic_uint));
+	atomic_int done = 0;
+	pthread_t thieves[WS_THIEVES];
+	struct ws_thief_args args = {d, &done, seen};
+	intptr_t i, item;
+
+	for (i = 0; i < WS_THIEVES; i++) {
+		pthread_create(&thieves[i], NULL, ws_thief, &args);
+	}
+	for (i = 1; i <= WS_STEAL_ITEMS; i++) {
+		wsdeque_push(d, (void*) i);
+		if (i % 4 == 0 && (item = (intptr_t) wsdeque_pop(d)) != 0) {
+			atomic_fetch_add(&seen[item - 1], 1);
+		}
+	}
+	while ((item = (intptr_t) wsdeque_pop(d)) != 0) {
+		atomic_fetch_add(&seen[item - 1], 1);
+	}
+	atomic_store(&done, 1);
+	for (i = 0; i < WS_THIEVES; i++) {
+		pthread_join(thieves[i], NULL);
+	}
+
+	/* every item is taken exactly once */
+	for (i = 0; i < WS_STEAL_ITEMS; i++) {
+		fail_unless(seen[i] == 1);
+	}
+	free(seen);
+	wsdeque_free(d);
+}
+END_TEST
+
+Suite*
+wsdeque_suite(void) {
+	Suite *s = suite_create("WSDeque");
+
+	/* Core test case */
+	TCase *tc_core = tcase_create("WSDeque");
+	tcase_add_test(tc_core, test_wsdeque_create);
+	tcase_add_test(tc_core, test_wsdeque_push_pop);
+	tcase_add_test(tc_core, test_wsdeque_steal);
+	tcase_add_test(tc_core, test_wsdeque_grow);
+	tcase_add_test(tc_core, test_wsdeque_concurrent_steal);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
@@ -13,5 +13,25 @@
 
 Suite* arraylist_suite(void);
 Suite* deque_suite(void);
+Suite* wsdeque_suite(void);
+Suite* workpool_suite(void);
+Suite* spscqueue_suite(void);
+Suite* mpmcqueue_suite(void);
+Suite* msqueue_suite(void);
+Suite* blockingdeque_suite(void);
+Suite* ringdeque_suite(void);
+Suite* bytering_suite(void);
+Suite* lrucache_suite(void);
+Suite* ideque_suite(void);
+Suite* monodeque_suite(void);
+Suite* timerwheel_suite(void);
+Suite* pqueue_suite(void);
+Suite* indexheap_suite(void);
+Suite* minmaxheap_suite(void);
+Suite* hashmap_suite(void);
+Suite* counter_suite(void);
+Suite* ordereddict_suite(void);
+Suite* bloomfilter_suite(void);
+Suite* listappender_suite(void);
 
 #endif /* TESTS_H_ */